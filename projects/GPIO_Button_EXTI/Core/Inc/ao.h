@@ -0,0 +1,97 @@
+/*
+ * Active object public interface
+ *
+ * Cooperative active-object layer: every active object (AO) owns
+ * an event queue, a handler and a unique priority; the main loop
+ * dispatches one event at a time to the highest-priority AO with
+ * a non-empty queue.
+ *
+ * Scheduling:
+ *  - priorities 1 .. AO_MAX_PRIO, higher runs first, one AO each
+ *  - a ready bitmask (bit = priority - 1) is set by every post,
+ *    the highest bit is found with one CLZ
+ *  - a handler runs to completion; after it the ready set is
+ *    looked at again, so a high-priority event waits at most for
+ *    the handler that is running, never for a lower queue
+ *  - an AO with an empty queue costs nothing: no polling
+ *
+ * Posting:
+ *  - Ao_Post: main loop (masks IRQs around the queue write)
+ *  - Ao_PostFromIsr: interrupt handlers; all posting ISRs must
+ *    share one NVIC preemption priority (evq.h rules)
+ *  - Ao_Notify / Ao_NotifyFromIsr: level-type signals ("poll",
+ *    "bytes arrived"), at most one of a kind is queued; it is
+ *    re-armed just before the handler sees it
+ *  - Ao_Publish: main loop, to every subscriber of the signal,
+ *    highest priority first
+ *  - a full queue drops the event and counts an overflow
+ *
+ * Events are evq.h Event_t: type = signal, arg = payload,
+ * ts_ms = post time (queue wait statistics).
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_AO_H_
+#define INC_AO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "evq.h"
+
+/* number of priority levels = max. active objects, <= 32 */
+#ifndef AO_MAX_PRIO
+#define AO_MAX_PRIO         8U
+#endif
+
+/* signals 0 .. AO_MAX_SIGNALS-1 can be published / notified, <= 32 */
+#ifndef AO_MAX_SIGNALS
+#define AO_MAX_SIGNALS      16U
+#endif
+
+typedef struct Ao Ao_t;
+
+/* ===== Event handler, main-loop context, runs to completion ===== */
+typedef void (*AoHandlerFn)(Ao_t *me, const Event_t *evt);
+
+/* ===== Active object ===== */
+struct Ao {
+    EvQueue_t   queue;
+    AoHandlerFn handler;
+    const char *name;
+    uint8_t     prio;
+    volatile uint32_t latched;      /* Ao_Notify signals still queued */
+    uint32_t    events;             /* dispatched */
+    uint32_t    max_wait_ms;        /* longest post -> dispatch */
+};
+
+/* static initializer: posts are safe before Ao_Start (early ISRs),
+   they are dropped by it like EvQ_Init does */
+#define AO_INITIALIZER(storage, capacity) \
+    { EVQ_INITIALIZER(storage, capacity), NULL, NULL, 0U, 0U, 0U, 0U }
+
+/* Public API */
+void     Ao_Init(void);             /* forget all AOs and subscriptions */
+
+/* 1 = registered; storage / capacity as EvQ_Init */
+uint8_t  Ao_Start(Ao_t *ao, const char *name, uint8_t prio, AoHandlerFn handler,
+                  Event_t *storage, uint32_t capacity);
+
+uint8_t  Ao_Post(Ao_t *ao, uint16_t sig, uint16_t arg);
+uint8_t  Ao_PostFromIsr(Ao_t *ao, uint16_t sig, uint16_t arg);
+uint8_t  Ao_Notify(Ao_t *ao, uint16_t sig);
+uint8_t  Ao_NotifyFromIsr(Ao_t *ao, uint16_t sig);
+
+void     Ao_Subscribe(Ao_t *ao, uint16_t sig);
+void     Ao_Unsubscribe(Ao_t *ao, uint16_t sig);
+uint32_t Ao_Publish(uint16_t sig, uint16_t arg);    /* subscribers reached */
+
+/* dispatcher, main loop */
+uint8_t  Ao_RunOne(void);           /* 1 = one event handled */
+void     Ao_Run(void);              /* until every queue is empty */
+uint8_t  Ao_Ready(void);            /* 1 = an event is waiting (idle deadline) */
+
+/* registered AO at a priority, NULL = none (statistics) */
+const Ao_t *Ao_Get(uint8_t prio);
+
+#endif /* INC_AO_H_ */
@@ -0,0 +1,38 @@
+/*
+ * Application layer public interface
+ *
+ * Owns the button / LED instances and the event routing
+ * that used to live inline in main().
+ *
+ * main() only performs CubeMX initialization and then:
+ *  - calls App_Init() once, then App_InitLate() (the settings
+ *    flash scan, LED PWM output and shell) before the superloop
+ *    or, with the boot fast start, after its first pass
+ *  - calls App_Process() on every superloop iteration: software
+ *    timers, the active objects with pending events (ao.h), then
+ *    the coroutine tasks (pt.h)
+ *  - sleeps via Idle_Run(App_NextDeadlineMs) when nothing is due
+ *
+ * Keeping the superloop body here lets the same code run
+ * on the target and inside the host simulation (Sim/).
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_APP_H_
+#define INC_APP_H_
+
+#include <stdint.h>
+#include "evq.h"
+
+void App_Init(void);        /* everything the button path needs */
+void App_InitLate(void);    /* Kv_Init, stored settings, LED PWM, shell */
+void App_Process(void);
+
+/* ms until App_Process has work again, UINT32_MAX = only on EXTI */
+uint32_t App_NextDeadlineMs(void);
+
+/* ISR -> buttons active object queue, for overflow / high-water inspection */
+const EvQueue_t *App_EventQueue(void);
+
+#endif /* INC_APP_H_ */
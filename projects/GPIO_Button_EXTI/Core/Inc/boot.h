@@ -0,0 +1,92 @@
+/*
+ * Boot profiler / fast start public interface
+ *
+ * Time from reset to the first handled event, phase by phase, and
+ * the fast-start path that shortens it.
+ *
+ * Profile (BOOT_PROF_ENABLE=1):
+ *  - Reset_Handler starts the DWT cycle counter as its first
+ *    instruction and stamps the end of its own phases; main()
+ *    stamps the rest with Boot_Mark()
+ *  - a phase is converted to us at the core clock in effect when
+ *    it started (HSI 8 MHz until the switch to the PLL)
+ *  - Boot_Poll() after the first superloop pass stamps "ready"
+ *    and prints one line per phase on USART2
+ *  - time before Reset_Handler (power-on reset delay, HSI start)
+ *    is not visible to the core and not included
+ *
+ * Fast start (BOOT_FAST_START=1):
+ *  - Boot_ClockStart() right after SystemInit turns HSE (bypass)
+ *    and the PLL on without waiting; the PLL locks while .data /
+ *    .bss / the stack paint run on HSI
+ *  - Boot_ClockSwitch() after the RAM init waits for the lock and
+ *    switches SYSCLK to the PLL: SystemClock_Config() finds the
+ *    configuration in place and returns without another lock wait
+ *  - the startup copies / fills RAM four words per transfer
+ *  - init that the first event does not need runs after the first
+ *    superloop pass (Boot_Defer): ISR profiler calibration,
+ *    App_InitLate (settings flash, LED PWM, shell)
+ *
+ * Boot_ClockStart / Boot_ClockSwitch mirror SystemClock_Config
+ * (HSE bypass / 2 x 16, AHB / 1, APB1 / 2, APB2 / 1, 2 wait
+ * states). With SYSCLK already on the PLL, HAL_RCC_OscConfig only
+ * compares PLLSRC and PLLMULL: a different HSE mode or PREDIV in
+ * the .ioc would be kept silently at the fast-start value. The
+ * oscillator half is therefore the BOOT_HSE_STATE / BOOT_PLL_*
+ * set below, the one SystemClock_Config must match; `make run` in
+ * Sim/ compares it with the generated code. Dividers and wait
+ * states are rewritten by HAL_RCC_ClockConfig from the .ioc.
+ *
+ * Platform: STM32 (Cortex-M3) + HAL
+ */
+
+#ifndef INC_BOOT_H_
+#define INC_BOOT_H_
+
+#include <stdint.h>
+
+#ifndef BOOT_PROF_ENABLE
+#define BOOT_PROF_ENABLE    1
+#endif
+
+#ifndef BOOT_FAST_START
+#define BOOT_FAST_START     1
+#endif
+
+#define BOOT_DEFER_MAX      4U
+
+/* SystemClock_Config oscillators, HAL names (expanded where main.h
+   is included); the clock manager locks the PLL with them too */
+#define BOOT_HSE_STATE      RCC_HSE_BYPASS
+#define BOOT_PLL_SOURCE     RCC_PLLSOURCE_HSE
+#define BOOT_PLL_PREDIV     RCC_HSE_PREDIV_DIV2
+#define BOOT_PLL_MUL        RCC_PLL_MUL16
+
+/* phase ends, in boot order */
+typedef enum {
+    BOOT_SYSINIT = 0,       /* reset -> SystemInit, PLL started (startup) */
+    BOOT_DATA,              /* .data + .ramfunc copy (startup) */
+    BOOT_BSS,               /* .bss zero + stack paint (startup) */
+    BOOT_PLL,               /* PLL lock wait + switch (startup, fast start) */
+    BOOT_LIBC,              /* static constructors -> main() */
+    BOOT_HAL,               /* HAL_Init */
+    BOOT_CLOCK,             /* SystemClock_Config */
+    BOOT_MX,                /* MX_*_Init */
+    BOOT_APP,               /* USER CODE 2: log, App_Init, TIM2 start */
+    BOOT_READY,             /* first superloop pass done */
+    BOOT_PHASES
+} BootPhase_t;
+
+typedef void (*BootDeferFn)(void);
+
+/* Public API */
+void     Boot_Mark(BootPhase_t phase);
+void     Boot_Defer(BootDeferFn fn);        /* run after the first pass */
+void     Boot_Poll(void);                   /* superloop */
+
+/* called from Reset_Handler (startup_stm32f103rbtx.s) */
+void     Boot_ClockStart(void);             /* before .data / .bss init */
+void     Boot_ClockSwitch(void);
+void     Boot_ResetStamps(uint32_t sysinit, uint32_t data, uint32_t bss, uint32_t pll);
+
+#endif /* INC_BOOT_H_ */
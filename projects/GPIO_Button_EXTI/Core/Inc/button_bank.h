@@ -0,0 +1,73 @@
+/*
+ * Button bank public interface
+ *
+ * Table-driven debounce and short / long press detection for up
+ * to 32 buttons, scanned as bit vectors instead of one FSM and one
+ * HAL_GPIO_ReadPin() per button.
+ *
+ * Layout:
+ *  - lane 0 / lane 1: one GPIO port each, 16 pins per lane
+ *  - button index = lane * 16 + pin number (bit in every mask)
+ *  - debounce state is bit-sliced (2-bit vertical counter):
+ *    all buttons are filtered by a handful of AND/XOR operations
+ *  - per-button timing lives in structure-of-arrays form
+ *
+ * Usage model:
+ *  - ButtonBank_OnTick() from the tick ISR: one IDR read per lane
+ *  - ButtonBank_Process() from the main loop: press timing
+ *    (Timebase_NowMs), events
+ *  - ButtonBank_TakeEvents() returns and clears an event bit mask
+ *
+ * A press is accepted after 4 identical samples, samples are taken
+ * every ceil(debounce_ms / (4 * TICK_PERIOD_MS)) ticks.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_BUTTON_BANK_H_
+#define INC_BUTTON_BANK_H_
+
+#include <stdint.h>
+#include "button_fsm.h"
+
+#define BANK_LANES          2U
+#define BANK_LANE_PINS      16U
+#define BANK_MAX_BUTTONS    (BANK_LANES * BANK_LANE_PINS)
+
+/* ===== Button bank context ===== */
+typedef struct {
+    /* configuration */
+    volatile const uint32_t *idr[BANK_LANES];   /* &GPIOx->IDR per lane */
+    uint32_t used_mask;
+    uint32_t active_low_mask;
+    uint32_t long_press_ms;
+    uint8_t  sample_ticks;
+
+    /* ISR side: sampling and vertical-counter debounce */
+    uint8_t  sample_cnt;
+    uint32_t cnt0;
+    uint32_t cnt1;
+    volatile uint32_t state;            /* debounced level, 1 = pressed */
+    volatile uint32_t press_edges;
+    volatile uint32_t release_edges;
+
+    /* main-loop side: timing and pending events */
+    uint32_t long_fired;
+    uint32_t short_events;
+    uint32_t long_events;
+    uint32_t press_start_ms[BANK_MAX_BUTTONS];
+} ButtonBank_t;
+
+/* Public API */
+void     ButtonBank_Init(ButtonBank_t *bank, uint32_t debounce_ms, uint32_t long_press_ms);
+uint8_t  ButtonBank_AddLane(ButtonBank_t *bank, uint8_t lane,
+                            volatile const uint32_t *idr,
+                            uint16_t pins, uint16_t active_low_pins);
+void     ButtonBank_OnTick(ButtonBank_t *bank);
+void     ButtonBank_Process(ButtonBank_t *bank);
+
+uint32_t ButtonBank_TakeEvents(ButtonBank_t *bank, ButtonEvent_t evt);
+uint32_t ButtonBank_Pressed(const ButtonBank_t *bank);
+uint32_t ButtonBank_NextDeadline(const ButtonBank_t *bank);
+
+#endif /* INC_BUTTON_BANK_H_ */
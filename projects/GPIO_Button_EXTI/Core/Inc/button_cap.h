@@ -0,0 +1,74 @@
+/*
+ * Button capture backend public interface
+ *
+ * Alternative input path for one button (CAP_BUTTON, PB6): the
+ * pin feeds TIM4 input capture, every filtered edge is stamped by
+ * the timer and moved to RAM by DMA, and the usual button FSM runs
+ * over that timestamped edge stream instead of polling the pin.
+ *
+ * Capture chain:
+ *  - TIM4 counts at 1 MHz (1 us per count, wraps every 65.5 ms)
+ *  - TI1 drives IC1 on rising edges and IC2 on falling edges
+ *    (the F1 capture unit has no both-edges mode)
+ *  - DMA1 Channel 1 / 4 copy CCR1 / CCR2 into circular buffers,
+ *    no interrupt per edge
+ *  - the tick ISR schedules deferred work (PendSV, defer.h) that
+ *    turns new captures into microsecond times on the Timebase
+ *    clock, well before the counter can wrap
+ *  - EXTI6 on the same pin wakes the core from a gated tick or
+ *    STOP; it is masked while edges are being followed
+ *
+ * The FSM sees debounce, click gaps and hold times measured from
+ * the edges themselves: a main loop that was busy for tens of ms
+ * still gets the same gestures, only later.
+ *
+ * Usage model:
+ *  - BtnCap_Init(btn) once, after MX_TIM4_Init / MX_CapButton_Init;
+ *    btn is an ordinary ButtonCtx_t, profile and events as usual
+ *  - BtnCap_OnTick() from the tick ISR, BtnCap_OnExti() from the
+ *    CAP_BUTTON EXTI callback; both only schedule the conversion,
+ *    PendSV_Handler must run Defer_Run()
+ *  - BtnCap_Process() from the main loop, then Button_GetEvent()
+ *  - BtnCap_NextDeadlineMs() in the idle deadline
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_BUTTON_CAP_H_
+#define INC_BUTTON_CAP_H_
+
+#include <stdint.h>
+#include "button_fsm.h"
+
+/* captures per edge direction, DMA circular buffers */
+#ifndef BTN_CAP_DMA_LEN
+#define BTN_CAP_DMA_LEN   32U
+#endif
+
+/* timestamped edges waiting for the main loop, power of two */
+#ifndef BTN_CAP_EDGES
+#define BTN_CAP_EDGES     32U
+#endif
+
+/* TIM4 counter clock, MX_TIM4_Init: 64 MHz / 64 */
+#define BTN_CAP_TIMER_HZ  1000000U
+
+#define BTN_CAP_NO_DEADLINE UINT32_MAX
+
+typedef struct {
+    uint32_t edges;             /* edges handed to the FSM */
+    uint32_t wakes;             /* EXTI wake-ups from the armed state */
+    uint32_t overflows;         /* edges lost, main loop too far behind */
+    uint32_t resyncs;           /* pin level without a capture (STOP) */
+    uint32_t last_press_us;     /* last debounced press, press to release edge */
+} BtnCapStats_t;
+
+/* Public API */
+void     BtnCap_Init(ButtonCtx_t *btn);         /* Button_Init + capture start */
+void     BtnCap_Process(void);
+void     BtnCap_OnTick(void);
+void     BtnCap_OnExti(void);
+uint32_t BtnCap_NextDeadlineMs(void);
+void     BtnCap_GetStats(BtnCapStats_t *out);
+
+#endif /* INC_BUTTON_CAP_H_ */
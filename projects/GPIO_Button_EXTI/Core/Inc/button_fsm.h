@@ -8,6 +8,22 @@
  *  - process EXTI-based button events
  *  - handle debounce without blocking delays
  *  - detect short and long button presses
+ *  - recognize gestures: double / triple click, hold with
+ *    auto-repeat and its release
+ *
+ * Timing comes from a ButtonProfile_t per button (shared by
+ * pointer, may live in flash). multi_ms = 0 and repeat_ms = 0
+ * turn the gesture layer off: SHORT is then posted right on
+ * release, as a plain press detector does.
+ *
+ * Gesture events:
+ *  - SHORT / DOUBLE / TRIPLE: 1, 2, 3 clicks, each release less
+ *    than multi_ms before the next press; SHORT and DOUBLE wait
+ *    for the window to close, TRIPLE is posted at once
+ *  - LONG (= HOLD_START) after long_ms held, clicks pending before
+ *    the hold are posted first
+ *  - HOLD_REPEAT every repeat_ms while still held
+ *  - RELEASE when a hold ends
  *
  * The FSM is driven from the main loop and is ISR-safe:
  *  - interrupts only signal events
@@ -18,47 +34,106 @@
 
 #ifndef BUTTON_FSM_H_
 #define BUTTON_FSM_H_
-#define BUTTON_DEBOUNCE_MS 50
 
 #include <stdint.h>
+#include "evq.h"
+
+/* pending events per button, power of two */
+#define BTN_EVQ_SIZE       4U
+
+/* default timing thresholds (ms), btn_profile_default */
+#ifndef BTN_DEBOUNCE_MS
+#define BTN_DEBOUNCE_MS    30U
+#endif
+
+#ifndef BTN_LONG_PRESS_MS
+#define BTN_LONG_PRESS_MS  2000U
+#endif
+
+#ifndef BTN_MULTI_CLICK_MS
+#define BTN_MULTI_CLICK_MS 300U
+#endif
+
+#ifndef BTN_REPEAT_MS
+#define BTN_REPEAT_MS      250U
+#endif
 
 /* ===== Button states ===== */
 typedef enum {
     BTN_STATE_IDLE = 0,
     BTN_STATE_DEBOUNCE,
     BTN_STATE_PRESSED,
-    BTN_STATE_LONG
+    BTN_STATE_LONG,
+    BTN_STATE_CLICK_WAIT            /* released, next click may follow */
 } ButtonState_t;
 
 /* ===== Button events ===== */
 typedef enum {
-	BTN_EVENT_NONE = 0,
+    BTN_EVENT_NONE = 0,
     BTN_EVENT_SHORT,
-    BTN_EVENT_LONG
+    BTN_EVENT_LONG,
+    BTN_EVENT_DOUBLE,
+    BTN_EVENT_TRIPLE,
+    BTN_EVENT_HOLD_REPEAT,
+    BTN_EVENT_RELEASE
 } ButtonEvent_t;
 
+#define BTN_EVENT_HOLD_START BTN_EVENT_LONG
+
+/* ===== Timing profile ===== */
+typedef struct {
+    uint32_t debounce_ms;
+    uint32_t long_ms;               /* hold start */
+    uint32_t multi_ms;              /* click gap for DOUBLE / TRIPLE, 0 = off */
+    uint32_t repeat_ms;             /* HOLD_REPEAT period, 0 = off */
+} ButtonProfile_t;
+
+#define BTN_PROFILE_INIT(debounce, hold, multi, repeat) \
+    { (debounce), (hold), (multi), (repeat) }
+
+/* BTN_DEBOUNCE_MS / BTN_LONG_PRESS_MS, gestures off */
+extern const ButtonProfile_t btn_profile_default;
+
 /* ===== Button read callback ===== */
 typedef uint8_t (*ButtonReadFn)(void);
 
 /* ===== Button context ===== */
 typedef struct {
     ButtonState_t state;
+    const ButtonProfile_t *profile;
     uint32_t debounce_start_ms;
     uint32_t press_start_ms;
-    ButtonEvent_t event;
+    uint32_t release_ms;                /* CLICK_WAIT: end of the last click */
+    uint32_t repeat_ms;                 /* LONG: time of the last hold event */
+    uint8_t  clicks;                    /* clicks in the current gesture */
+    EvQueue_t events;                   /* ButtonEvent_t, oldest first */
+    Event_t event_buf[BTN_EVQ_SIZE];
     ButtonReadFn read;
 } ButtonCtx_t;
 
 /* Public API */
-void Button_Init(ButtonCtx_t *btn, ButtonReadFn read);
+void Button_Init(ButtonCtx_t *btn, ButtonReadFn read);     /* btn_profile_default */
+void Button_SetProfile(ButtonCtx_t *btn, const ButtonProfile_t *profile);
 void Button_OnExti(ButtonCtx_t *btn);
-void Button_OnTick(ButtonCtx_t *btn);
 void Button_Process(ButtonCtx_t *btn);
 
+/*
+ * Same FSM with time and input level supplied by the caller, for
+ * backends that replay a timestamped edge stream (button_cap.c).
+ * Button_OnExti / Button_Process are these with Timebase_NowMs()
+ * and btn->read().
+ */
+void    Button_OnEdgeAt(ButtonCtx_t *btn, uint32_t t_ms);
+void    Button_ProcessAt(ButtonCtx_t *btn, uint32_t now_ms, uint8_t level);
+uint8_t Button_DueAt(const ButtonCtx_t *btn, uint8_t level, uint32_t *t_ms);
+
+/* oldest pending event, BTN_EVENT_NONE when the queue is empty */
 ButtonEvent_t Button_GetEvent(ButtonCtx_t *btn);
 
-/* timing thresholds (ms) */
-#define BTN_LONG_PRESS_MS  2000
-#define BTN_DEBOUNCE_MS    30
+/* time (ms) until Button_Process needs to run again, 0 = now */
+uint32_t Button_NextDeadline(const ButtonCtx_t *btn);
+
+/* no timer deadline: only an EXTI edge can change the state */
+#define BTN_NO_DEADLINE    UINT32_MAX
 
 #endif /* BUTTON_FSM_H_ */
@@ -0,0 +1,119 @@
+/*
+ * Clock manager public interface
+ *
+ * Runtime SYSCLK scaling: PLL 64 MHz while there is work, HSI
+ * 8 MHz while the device mostly sleeps, with every clock-derived
+ * setting kept right across a switch.
+ *
+ * Levels:
+ *  - CLK_LEVEL_HIGH : HSE bypass / 2 x 16 = 64 MHz, APB1 32 MHz,
+ *                     2 wait states (SystemClock_Config)
+ *  - CLK_LEVEL_LOW  : HSI 8 MHz, APB1 8 MHz, 0 wait states, PLL off
+ *  - timer kernel clock == HCLK at both levels
+ *
+ * Load policy (ClkMgr_Poll, superloop):
+ *  - load = awake share of the idle scheduler's wall clock (idle.h)
+ *    over windows of CLK_MGR_WINDOW_MS
+ *  - LOW -> HIGH after one window above CLK_MGR_UP_PERMILLE
+ *  - HIGH -> LOW after CLK_MGR_DOWN_WINDOWS windows in a row below
+ *    CLK_MGR_DOWN_PERMILLE (the same work takes 8x the share at
+ *    8 MHz: keep DOWN * 8 well below UP)
+ *  - a switch waits until the USART2 transmitter is idle (log ring
+ *    empty, last frame out): a BRR change mid-frame garbles it
+ *  - LOW is refused while USART2 runs faster than its PCLK1 / 16
+ *    (500 kbaud at 8 MHz, e.g. 921600): BRR would be below 16, no
+ *    valid divider. Counted in baud_refused on every attempt, the
+ *    level stays HIGH
+ *
+ * Switch sequence: the PLL is locked (HAL_RCC_OscConfig) with the
+ * interrupts on; SW / SWS, wait states and bus dividers are then
+ * set by register with the interrupts masked, SWS polled a bounded
+ * number of times (a switch that does not complete is undone and
+ * counted in fails, the level stays). Retimed in the same masked
+ * section:
+ *  - SysTick reload and SystemCoreClock, the Timebase microsecond
+ *    scale (timebase.h)
+ *  - TIM2 / TIM3 / TIM4 prescalers, scaled from their HIGH-level
+ *    values, loaded at once with a silent update event
+ *  - USART2 BRR from HAL_RCC_GetPCLK1Freq()
+ *
+ * Listeners (ClkMgr_Register) are called in thread context,
+ * interrupts enabled: CLK_MGR_PRE before the switch, CLK_MGR_POST
+ * after it with the level now in effect (the old one if the switch
+ * failed). Cycle-based statistics (idle, ISR profiler) reset there.
+ *
+ * Costs of a switch: SysTick restarts its 1 ms period (< 1 ms of
+ * wall time lost), the counters of the three timers restart, a
+ * USART2 byte received during it may be lost, and a capture-button
+ * press in flight is timed at the wrong rate once. HSI is +/-1 %:
+ * the baud rate error stays inside the UART tolerance.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_CLK_MGR_H_
+#define INC_CLK_MGR_H_
+
+#include <stdint.h>
+
+#ifndef CLK_MGR_ENABLE
+#define CLK_MGR_ENABLE          1       /* 0 = stay at 64 MHz, as generated */
+#endif
+
+#ifndef CLK_MGR_WINDOW_MS
+#define CLK_MGR_WINDOW_MS       50U
+#endif
+
+#ifndef CLK_MGR_UP_PERMILLE
+#define CLK_MGR_UP_PERMILLE     500U    /* load at 8 MHz */
+#endif
+
+#ifndef CLK_MGR_DOWN_PERMILLE
+#define CLK_MGR_DOWN_PERMILLE   30U     /* load at 64 MHz */
+#endif
+
+#ifndef CLK_MGR_DOWN_WINDOWS
+#define CLK_MGR_DOWN_WINDOWS    10U
+#endif
+
+#ifndef CLK_MGR_REPORT_PERIOD_MS
+#define CLK_MGR_REPORT_PERIOD_MS 0U     /* 0 = no periodic USART2 report */
+#endif
+
+#define CLK_MGR_MAX_LISTENERS   4U
+
+typedef enum {
+    CLK_LEVEL_LOW = 0,          /* HSI 8 MHz */
+    CLK_LEVEL_HIGH              /* PLL 64 MHz */
+} ClkLevel_t;
+
+typedef enum {
+    CLK_MGR_PRE = 0,            /* level = the one about to be set */
+    CLK_MGR_POST                /* level = the one in effect */
+} ClkMgrPhase_t;
+
+typedef void (*ClkMgrNotifyFn)(ClkMgrPhase_t phase, ClkLevel_t level);
+
+/* ===== Statistics ===== */
+typedef struct {
+    uint32_t hclk_hz;
+    ClkLevel_t level;
+    uint32_t ups;               /* LOW -> HIGH switches */
+    uint32_t downs;             /* HIGH -> LOW switches */
+    uint32_t deferred;          /* switches postponed, USART2 busy */
+    uint32_t fails;             /* PLL lock / SWS timeouts, level kept */
+    uint32_t baud_refused;      /* LOW refused, USART2 baud above PCLK1 / 16 */
+    uint64_t low_ms;            /* time spent at each level */
+    uint64_t high_ms;
+} ClkMgrStats_t;
+
+/* Public API */
+void       ClkMgr_Init(void);                   /* after the MX inits, at HIGH */
+uint8_t    ClkMgr_Register(ClkMgrNotifyFn fn);  /* 1 = registered, 0 = table full */
+void       ClkMgr_Poll(void);
+uint8_t    ClkMgr_Request(ClkLevel_t level);    /* 1 = in effect, 0 = postponed / refused / failed */
+void       ClkMgr_Restore(void);                /* after STOP, tick and interrupts on */
+ClkLevel_t ClkMgr_Level(void);
+void       ClkMgr_GetStats(ClkMgrStats_t *out);
+
+#endif /* INC_CLK_MGR_H_ */
@@ -0,0 +1,75 @@
+/*
+ * Deferred interrupt work public interface
+ *
+ * Bottom halves for interrupt handlers: an ISR keeps only what has
+ * to happen at interrupt time (clear the flag, sample, stamp) and
+ * schedules a work item for the rest. Scheduled items run from
+ * PendSV, which has the lowest exception priority:
+ *
+ *  - every ISR (priority 0) preempts deferred work, the work never
+ *    delays an interrupt
+ *  - deferred work preempts the main loop: it runs right after the
+ *    last ISR returns (tail-chained), not when the superloop gets
+ *    round to it, and a busy / blocked main loop does not delay it
+ *    (only a PRIMASK section does)
+ *
+ * Work items:
+ *  - a static DeferWork_t per kind of work, DEFER_WORK_INIT
+ *  - scheduling a pending item again is coalesced: the function
+ *    runs once for any number of schedules before it starts
+ *  - the pending mark is dropped just before the function runs,
+ *    so a schedule from an ISR during the run queues it again
+ *  - items run in scheduling order, one at a time, to completion
+ *
+ * Context rules for the work function:
+ *  - interrupts may preempt it: data shared with an ISR needs the
+ *    same care as in the main loop (PRIMASK, SPSC rings)
+ *  - the main loop is not running: data shared only with the main
+ *    loop is safe where the main loop masks IRQs around it
+ *  - post to active objects with Ao_Post / Ao_Notify, not the
+ *    FromIsr variants (those assume the ISR priority level)
+ *
+ * Latency: with ISR_PROF_ENABLE=1 the time from the first schedule
+ * to the start of the function is recorded as the ISR_PROF_PENDSV
+ * latency (isr_prof.h), next to the PendSV_Handler duration.
+ *
+ * Platform: STM32 (Cortex-M3) + HAL
+ */
+
+#ifndef INC_DEFER_H_
+#define INC_DEFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void (*DeferFn)(void *arg);
+
+/* ===== Work item ===== */
+typedef struct DeferWork {
+    struct DeferWork *next;
+    DeferFn     fn;
+    void       *arg;
+    volatile uint8_t pending;       /* scheduled, not started yet */
+    uint32_t    posted;             /* ISR_PROF stamp of the first schedule */
+} DeferWork_t;
+
+#define DEFER_WORK_INIT(fn, arg)    { NULL, (fn), (arg), 0U, 0U }
+
+typedef struct {
+    uint32_t scheduled;             /* items queued */
+    uint32_t coalesced;             /* schedules of an already pending item */
+    uint32_t runs;                  /* work functions called */
+    uint32_t max_batch;             /* most items run by one PendSV */
+} DeferStats_t;
+
+/* Public API */
+void    Defer_Init(void);                   /* drop every pending item */
+
+/* any context; 1 = queued, 0 = already pending (coalesced) */
+uint8_t Defer_Schedule(DeferWork_t *w);
+
+void    Defer_Run(void);                    /* PendSV_Handler only */
+uint8_t Defer_Pending(void);                /* 1 = items waiting */
+void    Defer_GetStats(DeferStats_t *out);
+
+#endif /* INC_DEFER_H_ */
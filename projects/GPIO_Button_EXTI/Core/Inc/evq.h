@@ -0,0 +1,60 @@
+/*
+ * Event queue public interface
+ *
+ * Lock-free single-producer / single-consumer ring buffer of
+ * timestamped events, used to hand work from ISRs to the main
+ * loop without masking interrupts.
+ *
+ * Rules:
+ *  - capacity must be a power of two (index wrap is a mask)
+ *  - head is written only by the producer, tail only by the
+ *    consumer; both are free-running, count = head - tail
+ *  - "single producer" means one priority level: several ISRs
+ *    may post to one queue only if they share the same NVIC
+ *    preemption priority (cannot preempt each other)
+ *  - a full queue drops the new event and counts an overflow
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_EVQ_H_
+#define INC_EVQ_H_
+
+#include <stdint.h>
+
+/* ===== Event ===== */
+typedef struct {
+    uint32_t ts_ms;     /* HAL_GetTick() at post time */
+    uint16_t type;      /* owner-defined event code */
+    uint16_t arg;       /* owner-defined payload, e.g. GPIO pin */
+} Event_t;
+
+/* ===== Queue ===== */
+typedef struct {
+    Event_t *buf;
+    uint32_t mask;              /* capacity - 1 */
+    volatile uint32_t head;     /* producer index */
+    volatile uint32_t tail;     /* consumer index */
+    volatile uint32_t overflows;
+    volatile uint32_t high_water;
+} EvQueue_t;
+
+/* static initializer: queue usable before EvQ_Init (e.g. early ISRs) */
+#define EVQ_INITIALIZER(storage, capacity) \
+    { (storage), (capacity) - 1U, 0U, 0U, 0U, 0U }
+
+/* Public API */
+uint8_t  EvQ_Init(EvQueue_t *q, Event_t *storage, uint32_t capacity);
+
+/* producer side (ISR or main loop) */
+uint8_t  EvQ_Post(EvQueue_t *q, uint16_t type, uint16_t arg);
+
+/* consumer side */
+uint8_t  EvQ_Get(EvQueue_t *q, Event_t *out);
+uint32_t EvQ_Count(const EvQueue_t *q);
+
+/* statistics, readable from either side */
+uint32_t EvQ_Overflows(const EvQueue_t *q);
+uint32_t EvQ_HighWater(const EvQueue_t *q);
+
+#endif /* INC_EVQ_H_ */
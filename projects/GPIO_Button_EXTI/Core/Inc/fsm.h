@@ -0,0 +1,88 @@
+/*
+ * Table-driven state machine public interface
+ *
+ * A state machine is described by const tables (flash on the
+ * target); the engine only looks rows up and runs the actions.
+ *
+ * Model:
+ *  - states are numbered 0 .. nstates-1, signals are small
+ *    owner-defined codes
+ *  - each state has optional entry / exit actions and a list of
+ *    rows {signal, guard, action, next}
+ *  - Fsm_Dispatch scans the rows of the current state only; the
+ *    first row with the signal and a passing guard (NULL = always)
+ *    fires, at most one row per call
+ *  - next = FSM_SAME is an internal transition: action only, no
+ *    exit / entry; a row back to its own state is an external
+ *    self-transition and runs exit, action and entry again
+ *  - order on a transition: exit(old), action, entry(new)
+ *  - a signal without a matching row is ignored
+ *
+ * Guards and actions get the `ctx` pointer given to Fsm_Dispatch,
+ * typically the object plus the inputs of this dispatch (time,
+ * level, payload). The state itself is owned by the caller:
+ * Fsm_Dispatch takes the current state and returns the new one,
+ * so the object keeps its own typed state field.
+ *
+ * Transition tracing: FSM_TRACE_ENABLE=1 emits one TRACE record
+ * "fsm <id>: <from> -> <to> on <sig>" per fired row (needs
+ * TRACE_ENABLE as well). Off by default, a machine polled from
+ * the main loop fires often.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_FSM_H_
+#define INC_FSM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef FSM_TRACE_ENABLE
+#define FSM_TRACE_ENABLE    0
+#endif
+
+/* row target: stay in the state, no exit / entry */
+#define FSM_SAME            0xFFU
+
+typedef uint8_t (*FsmGuardFn)(void *ctx);
+typedef void    (*FsmActionFn)(void *ctx);
+
+/* ===== Transition row ===== */
+typedef struct {
+    uint8_t     sig;
+    uint8_t     next;               /* state index or FSM_SAME */
+    FsmGuardFn  guard;              /* NULL = always */
+    FsmActionFn action;             /* NULL = none */
+} FsmRow_t;
+
+/* ===== State ===== */
+typedef struct {
+    const FsmRow_t *rows;
+    uint8_t     nrows;
+    FsmActionFn entry;              /* NULL = none */
+    FsmActionFn exit;               /* NULL = none */
+} FsmState_t;
+
+#define FSM_STATE(rows, entry, exit) \
+    { (rows), (uint8_t)(sizeof(rows) / sizeof((rows)[0])), (entry), (exit) }
+
+/* ===== Machine ===== */
+typedef struct {
+    const FsmState_t *states;
+    uint8_t     nstates;
+    uint8_t     id;                 /* trace tag, owner-chosen */
+} FsmDef_t;
+
+#define FSM_DEF(states, id) \
+    { (states), (uint8_t)(sizeof(states) / sizeof((states)[0])), (id) }
+
+/* Public API */
+
+/* runs entry(initial), returns initial */
+uint8_t Fsm_Start(const FsmDef_t *def, uint8_t initial, void *ctx);
+
+/* one signal, returns the new state (= state if nothing fired) */
+uint8_t Fsm_Dispatch(const FsmDef_t *def, uint8_t state, uint8_t sig, void *ctx);
+
+#endif /* INC_FSM_H_ */
@@ -39,6 +39,8 @@ extern "C" {
 void MX_GPIO_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+void MX_PanelKeys_Init(void);
+void MX_CapButton_Init(void);
 
 /* USER CODE END Prototypes */
 
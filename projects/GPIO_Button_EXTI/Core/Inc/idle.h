@@ -0,0 +1,96 @@
+/*
+ * Idle scheduler public interface
+ *
+ * Idle scheduler for the superloop: after each App_Process()
+ * pass the main loop asks the FSMs for their next deadline and
+ * puts the core to sleep instead of spinning.
+ *
+ * Tickless: neither the 1 ms SysTick nor the 2 ms TIM2 update
+ * wakes the core while nothing is due. TIM2 counts on free-running
+ * (ARR 0xFFFF, 1 ms per count) across the sleep and tells how many
+ * of its updates were skipped; the Timebase is advanced by the
+ * SysTick interrupts that did not happen (Timebase_SkipTicks).
+ *
+ * Idle levels, chosen inside one PRIMASK critical section so no
+ * event can slip in between the check and WFI:
+ *  - deadline 0            : work pending, return immediately
+ *  - deadline below
+ *    IDLE_TICKLESS_MIN_MS,
+ *    or a tick pending     : SLEEP (WFI), both ticks keep running
+ *  - finite deadline       : SLEEP with the SysTick reload
+ *                            stretched to the deadline (at most
+ *                            IDLE_MAX_SLEEP_MS and the 24-bit
+ *                            reload); the skipped TIM2 updates are
+ *                            dispatched after WFI
+ *  - IDLE_NO_DEADLINE      : SLEEP with SysTick stopped, TIM2 update
+ *                            IRQ only on the 65.5 s overflow; the
+ *                            skipped TIM2 updates are dropped, the
+ *                            Timebase advances by the TIM2 count
+ *                            (1 ms resolution, the sub-ms phase of
+ *                            SysTick is lost); or, with
+ *                            IDLE_USE_STOP=1, STOP mode until the
+ *                            next EXTI edge (not while the PWM LED
+ *                            is lit, see led_pwm.h)
+ *
+ * Statistics (SysTick-derived wall clock, compensated after every
+ * tickless sleep):
+ *  - duty cycle: awake share of elapsed cycles
+ *  - wakeups per second, all sources and SysTick alone
+ *  - wakeup latency: SysTick reload to first instruction after WFI
+ * STOP residency is not visible to SysTick and is only counted.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_IDLE_H_
+#define INC_IDLE_H_
+
+#include <stdint.h>
+
+#ifndef IDLE_USE_STOP
+#define IDLE_USE_STOP           0
+#endif
+
+#ifndef IDLE_REPORT_PERIOD_MS
+#define IDLE_REPORT_PERIOD_MS   0U      /* 0 = no periodic USART2 report */
+#endif
+
+/* shorter deadlines sleep with both ticks running (two TIM2 ticks) */
+#ifndef IDLE_TICKLESS_MIN_MS
+#define IDLE_TICKLESS_MIN_MS    4U
+#endif
+
+/* longest stretched SLEEP: bounds the TIM2 updates dispatched at
+   once after WFI (one per 2 ms), interrupts masked */
+#ifndef IDLE_MAX_SLEEP_MS
+#define IDLE_MAX_SLEEP_MS       250U
+#endif
+
+#define IDLE_NO_DEADLINE        UINT32_MAX
+
+/* ===== Deadline query, evaluated with interrupts masked ===== */
+typedef uint32_t (*IdleDeadlineFn)(void);
+
+/* ===== Statistics ===== */
+typedef struct {
+    uint64_t total_cycles;      /* wall cycles since Idle_ResetStats() */
+    uint64_t sleep_cycles;      /* wall cycles spent in WFI */
+    uint32_t sleeps;            /* SLEEP entries */
+    uint32_t stops;             /* STOP entries (time not measured) */
+    uint32_t tick_stretched;    /* SLEEP entries with the SysTick reload stretched */
+    uint32_t tick_stopped;      /* SLEEP entries with SysTick stopped */
+    uint32_t wake_count;        /* SysTick wakeups (latency measured) */
+    uint32_t wake_lat_min;      /* cycles */
+    uint32_t wake_lat_max;
+    uint64_t wake_lat_sum;
+} IdleStats_t;
+
+/* Public API */
+void     Idle_Init(void);
+void     Idle_Run(IdleDeadlineFn next_deadline_ms);
+void     Idle_GetStats(IdleStats_t *out);
+void     Idle_ResetStats(void);
+uint32_t Idle_DutyPermille(const IdleStats_t *st);
+void     Idle_Poll(void);
+
+#endif /* INC_IDLE_H_ */
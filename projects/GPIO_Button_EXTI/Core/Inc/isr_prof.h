@@ -0,0 +1,120 @@
+/*
+ * ISR profiler public interface
+ *
+ * Opt-in, cycle-accurate instrumentation of interrupt handlers
+ * based on the Cortex-M3 DWT cycle counter (DWT->CYCCNT).
+ *
+ * Per instrumented handler it records:
+ *  - entry-to-exit duration: min / max / mean, log2 histogram
+ *  - entry-to-entry period: min / max / mean
+ *  - jitter: |period - expected period|, log2 histogram
+ *  - latency from a stamp taken elsewhere (e.g. the ISR that
+ *    scheduled deferred work) to the start of the work:
+ *    min / max / mean, log2 histogram
+ *
+ * Usage:
+ *  - build with ISR_PROF_ENABLE=1 (-DISR_PROF_ENABLE=1)
+ *  - IsrProf_Init() once; with BOOT_FAST_START it runs after the
+ *    first superloop pass, interrupts live (boot.h)
+ *  - ISR_PROF_ENTER(id) / ISR_PROF_EXIT(id) at the very
+ *    beginning / end of the handler (same scope)
+ *  - ISR_PROF_STAMP() where an event starts, ISR_PROF_LATENCY(id,
+ *    stamp) where it is finally handled (defer.c: schedule -> run)
+ *  - IsrProf_Poll() from the main loop streams a binary dump
+ *    over USART2 every ISR_PROF_DUMP_PERIOD_MS; decode it on the host
+ *    with Sim/Tools/isr_prof_decode
+ *
+ * With ISR_PROF_ENABLE=0 the macros expand to nothing and the
+ * API functions are empty, so instrumented handlers cost 0 cycles.
+ *
+ * Platform: STM32 (Cortex-M3) + HAL
+ */
+
+#ifndef INC_ISR_PROF_H_
+#define INC_ISR_PROF_H_
+
+#include <stdint.h>
+
+#ifndef ISR_PROF_ENABLE
+#define ISR_PROF_ENABLE         0
+#endif
+
+#ifndef ISR_PROF_DUMP_PERIOD_MS
+#define ISR_PROF_DUMP_PERIOD_MS 10000U
+#endif
+
+/* log2 buckets: bin k counts values in [2^k, 2^(k+1)), last bin is open */
+#define ISR_PROF_HIST_BINS      16U
+
+#define ISR_PROF_MAGIC          0x50525349UL  /* "ISRP" little-endian */
+#define ISR_PROF_VERSION        2U
+
+/* ===== Instrumented sources ===== */
+typedef enum {
+    ISR_PROF_TIM2 = 0,
+    ISR_PROF_EXTI15_10,
+    ISR_PROF_PENDSV,            /* deferred work, latency = schedule -> run */
+    ISR_PROF_COUNT
+} IsrProfId_t;
+
+/* ===== Per-source statistics (all values in CPU cycles) ===== */
+typedef struct {
+    uint64_t dur_sum;
+    uint64_t period_sum;
+    uint64_t lat_sum;
+    uint32_t count;
+    uint32_t dur_min;
+    uint32_t dur_max;
+    uint32_t period_count;
+    uint32_t period_min;
+    uint32_t period_max;
+    uint32_t period_expected;   /* 0 = aperiodic source, no jitter stats */
+    uint32_t jitter_max;
+    uint32_t last_entry;
+    uint32_t lat_count;
+    uint32_t lat_min;
+    uint32_t lat_max;
+    uint32_t dur_hist[ISR_PROF_HIST_BINS];
+    uint32_t jitter_hist[ISR_PROF_HIST_BINS];
+    uint32_t lat_hist[ISR_PROF_HIST_BINS];
+} IsrProfStats_t;
+
+/* ===== Binary dump layout (little-endian, as sent over UART) ===== */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t source_count;
+    uint32_t core_clock_hz;
+    uint32_t overhead_cycles;   /* ENTER/EXIT pair cost, already subtracted */
+    IsrProfStats_t stats[ISR_PROF_COUNT];
+} IsrProfDump_t;
+
+/* Public API */
+void IsrProf_Init(void);
+void IsrProf_SetPeriod(IsrProfId_t id, uint32_t expected_cycles);
+void IsrProf_Reset(void);
+void IsrProf_Snapshot(IsrProfDump_t *out);
+void IsrProf_Poll(void);
+
+#if ISR_PROF_ENABLE
+
+uint32_t IsrProf_Enter(IsrProfId_t id);
+void     IsrProf_Exit(IsrProfId_t id, uint32_t t_entry);
+uint32_t IsrProf_Stamp(void);
+void     IsrProf_Latency(IsrProfId_t id, uint32_t t_stamp);
+
+#define ISR_PROF_ENTER(id)  uint32_t isr_prof_t0_ = IsrProf_Enter(id)
+#define ISR_PROF_EXIT(id)   IsrProf_Exit((id), isr_prof_t0_)
+#define ISR_PROF_STAMP()    IsrProf_Stamp()
+#define ISR_PROF_LATENCY(id, t_stamp)   IsrProf_Latency((id), (t_stamp))
+
+#else
+
+#define ISR_PROF_ENTER(id)  ((void)0)
+#define ISR_PROF_EXIT(id)   ((void)0)
+#define ISR_PROF_STAMP()    0U
+#define ISR_PROF_LATENCY(id, t_stamp)   ((void)(t_stamp))
+
+#endif /* ISR_PROF_ENABLE */
+
+#endif /* INC_ISR_PROF_H_ */
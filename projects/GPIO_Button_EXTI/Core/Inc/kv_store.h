@@ -0,0 +1,86 @@
+/*
+ * Settings store public interface
+ *
+ * Log-structured key / value store in the last KV_PAGES flash
+ * pages (KVSTORE region of STM32F103RBTX_FLASH.ld).
+ *
+ * Layout:
+ *  - every page starts with an 8-byte header: magic, 32-bit
+ *    sequence number, check word (0x0000 = page being erased)
+ *  - records are appended behind it, halfword by halfword:
+ *    (key << 8 | length), value (padded), CRC-16 written last
+ *  - a newer record for the same key supersedes the old one,
+ *    nothing is rewritten in place
+ *
+ * Wear leveling:
+ *  - pages are used round-robin; when the newest page is full
+ *    an erased page is opened, and only when no erased page is
+ *    left the oldest one is compacted (live records copied) and
+ *    erased -> every page is erased once per KV_PAGES - 1 page
+ *    fills, not once per setting change
+ *  - Kv_Set() of an unchanged value writes nothing
+ *
+ * Power loss:
+ *  - a torn record fails its CRC and is skipped, a torn record
+ *    header is skipped as a 2-byte hole
+ *  - a torn page header or an interrupted erase is detected and
+ *    the page is erased again on the next boot
+ *  - an interrupted compaction is resumed by Kv_Init()
+ *
+ * Lookup: Kv_Init() scans the region once and keeps the flash
+ * offset of the newest record per key in RAM, Kv_Get() is O(1).
+ *
+ * Flash programming stalls the CPU (~50 us per halfword, ~20 ms
+ * per page erase): call from the main loop only.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_KV_STORE_H_
+#define INC_KV_STORE_H_
+
+#include <stdint.h>
+
+#ifndef KV_FLASH_BASE
+extern const uint8_t _skvstore[];   /* linker script */
+#define KV_FLASH_BASE   ((uint32_t)(uintptr_t)_skvstore)
+#endif
+
+#define KV_PAGE_SIZE    1024U       /* STM32F103xB flash page */
+
+#ifndef KV_PAGES
+#define KV_PAGES        4U          /* must match LENGTH(KVSTORE) */
+#endif
+
+#define KV_MAX_KEYS     32U         /* keys 0 .. KV_MAX_KEYS - 1 */
+#define KV_VALUE_MAX    16U         /* bytes per value */
+
+/* ===== Keys ===== */
+enum {
+    KV_KEY_LED_MODE = 1,
+    KV_KEY_DEBOUNCE_MS,
+    KV_KEY_LONG_PRESS_MS,
+    KV_KEY_LED_LEVEL,
+};
+
+/* ===== Statistics ===== */
+typedef struct {
+    uint32_t records;           /* records written since Kv_Init */
+    uint32_t page_erases;
+    uint32_t gc_copies;         /* live records moved by compaction */
+    uint32_t crc_errors;        /* torn records skipped at boot */
+    uint32_t flash_errors;      /* HAL_FLASH_Program / Erase failures */
+    uint32_t free_bytes;        /* before the next compaction */
+} KvStats_t;
+
+/* Public API */
+void     Kv_Init(void);
+uint8_t  Kv_Get(uint16_t key, void *out, uint32_t *len);    /* *len: in = size, out = length */
+uint8_t  Kv_Set(uint16_t key, const void *data, uint32_t len);
+
+uint32_t Kv_GetU32(uint16_t key, uint32_t def);
+uint8_t  Kv_SetU32(uint16_t key, uint32_t value);
+
+void     Kv_GetStats(KvStats_t *out);
+
+#endif /* INC_KV_STORE_H_ */
@@ -5,13 +5,21 @@
  * event-driven finite state machine used for LED control.
  *
  * This module is designed to:
- *  - control LED operating modes (OFF / ON / BLINK)
+ *  - control LED operating modes (OFF / ON / BLINK / PATTERN and
+ *    the PWM modes DIM / BREATHE / FADE_IN / FADE_OUT)
  *  - decouple LED behavior from application logic
  *  - provide a clear and minimal control interface
  *
+ * Outputs:
+ *  - LD2 (PA5, plain GPIO) shows OFF / ON / BLINK / PATTERN, it
+ *    is off in the PWM modes
+ *  - the dimmable LED on PB0 (led_pwm.h) shows ON and the PWM
+ *    modes, it is off in BLINK / PATTERN
+ *
  * The LED FSM is driven by:
  *  - explicit mode changes from application code
- *  - periodic tick events for time-based behavior (blinking)
+ *  - the LED sequencer for blink / fault patterns (led_seq.h)
+ *  - DMA for the brightness waveforms (no CPU per step)
  *
  * Design principles:
  *  - no direct GPIO access from application code
@@ -25,16 +33,28 @@
 #define INC_LED_FSM_H_
 
 #include <stdint.h>
+#include "led_seq.h"
+
+#define LED_DIM_DEFAULT_PCT 25U
+
+/* LD2 is channel 0 of the board sequencer table (app.c) */
+#define LED_CH_LD2          0U
 
 typedef enum {
     LED_MODE_OFF = 0,
     LED_MODE_ON,
-    LED_MODE_BLINK
+    LED_MODE_BLINK,
+    LED_MODE_DIM,           /* static brightness, Led_SetLevel() */
+    LED_MODE_BREATHE,       /* 2 s gamma-corrected breathing, looped */
+    LED_MODE_FADE_IN,       /* 0.5 s ramp up, then stays on */
+    LED_MODE_FADE_OUT,      /* 0.5 s ramp down, then stays off */
+    LED_MODE_PATTERN        /* sequencer pattern on LD2, Led_SetPattern() */
 } LedMode_t;
 
 void Led_Init(void);
 void Led_SetMode(LedMode_t mode);
-void Led_OnTick(void);
+void Led_SetPattern(const LedSeqPattern_t *pat);
+void Led_SetLevel(uint8_t percent);     /* DIM brightness, 0 .. 100 */
 void Led_Process(void);
 
 #endif /* INC_LED_FSM_H_ */
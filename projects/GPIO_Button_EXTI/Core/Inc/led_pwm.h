@@ -0,0 +1,33 @@
+/*
+ * PWM LED backend public interface
+ *
+ * Dimmable LED on PB0 (TIM3_CH3, 500 Hz, 8-bit duty). Brightness
+ * waveforms (led_wave.h) are streamed into CCR3 by DMA1 Channel 2
+ * on every compare event: no interrupt and no CPU work per step,
+ * only when a waveform is started or stopped.
+ *
+ * Behavior:
+ *  - LedPwm_SetLevel(): static duty, stops a running waveform
+ *  - LedPwm_Play(loop = 1): circular DMA, repeats forever
+ *  - LedPwm_Play(loop = 0): one pass, CCR3 keeps the last sample
+ *  - CCR3 is preloaded: every sample lasts one full PWM period
+ *
+ * TIM3 stops in STOP mode: the idle scheduler asks
+ * LedPwm_Active() before leaving SLEEP for STOP.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_LED_PWM_H_
+#define INC_LED_PWM_H_
+
+#include <stdint.h>
+
+/* Public API */
+void    LedPwm_Init(void);                  /* after MX_TIM3_Init() */
+void    LedPwm_SetLevel(uint8_t duty);      /* 0 .. LED_PWM_MAX */
+uint8_t LedPwm_Play(const uint8_t *wave, uint32_t len, uint8_t loop);
+uint8_t LedPwm_Level(void);                 /* current CCR3 */
+uint8_t LedPwm_Active(void);                /* 1 = LED lit or waveform running */
+
+#endif /* INC_LED_PWM_H_ */
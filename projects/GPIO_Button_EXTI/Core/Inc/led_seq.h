@@ -0,0 +1,81 @@
+/*
+ * LED sequencer public interface
+ *
+ * Plays on / off patterns (blink, heartbeat, SOS, n-blink fault
+ * codes) on any number of GPIO LEDs from const tables in flash.
+ *
+ * Pattern format:
+ *  - a step is one halfword: bit 15 = LED on, bits 0..14 = length
+ *    in TIM2 ticks; LED_ON(ms) / LED_OFF(ms) convert milliseconds
+ *    at compile time and reject lengths the tick cannot express
+ *  - a pattern plays its step table `count` times, then stays
+ *    off for `gap` ticks, and starts over
+ *    (fault code n = { LED_ON(200), LED_OFF(300) } x n, gap)
+ *
+ * Usage model:
+ *  - channels are a contiguous array owned by the caller,
+ *    LED_SEQ_CHANNEL(port, pin mask) per LED
+ *  - LedSeq_OnTick() from the tick ISR: one down-counter per
+ *    channel, a pin write only when a step ends
+ *  - LedSeq_Play() / LedSeq_Stop() from the main loop
+ *  - LedSeq_NextDeadlineMs() keeps the tick running while a
+ *    pattern plays (idle.h)
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_LED_SEQ_H_
+#define INC_LED_SEQ_H_
+
+#include <stdint.h>
+#include "tick.h"
+
+#define LED_SEQ_NO_DEADLINE UINT32_MAX
+#define LED_SEQ_CODES       12U         /* led_pat_code[0] = fault code 1 */
+
+/* ms -> ticks, rounded up; compile error if not 1 .. 0x7FFF ticks */
+#define LED_SEQ_TICKS(ms) \
+    ((uint16_t)(((ms) + TICK_PERIOD_MS - 1U) / TICK_PERIOD_MS + \
+                0U * sizeof(char[((ms) >= 1U && ((ms) + TICK_PERIOD_MS - 1U) / TICK_PERIOD_MS <= 0x7FFFU) ? 1 : -1])))
+
+#define LED_ON(ms)          ((uint16_t)(0x8000U | LED_SEQ_TICKS(ms)))
+#define LED_OFF(ms)         LED_SEQ_TICKS(ms)
+
+#define LED_SEQ_PATTERN(steps, count, gap_ms) \
+    { (steps), (uint8_t)(sizeof(steps) / sizeof((steps)[0])), (count), \
+      (uint16_t)((gap_ms) ? LED_SEQ_TICKS((gap_ms) ? (gap_ms) : 1U) : 0U) }
+
+#define LED_SEQ_CHANNEL(gpio, mask) { .port = (gpio), .pin = (mask) }
+
+/* ===== Pattern (const, in flash) ===== */
+typedef struct {
+    const uint16_t *steps;
+    uint8_t  len;
+    uint8_t  count;             /* plays of steps[] per cycle, >= 1 */
+    uint16_t gap;               /* off ticks after the plays, 0 = none */
+} LedSeqPattern_t;
+
+/* ===== Channel (RAM, contiguous array) ===== */
+typedef struct {
+    void    *port;              /* GPIO_TypeDef *, opaque: no main.h here */
+    uint16_t pin;
+    const LedSeqPattern_t *pat; /* NULL = not playing */
+    uint16_t left;              /* ticks to the next step, 0 = idle */
+    uint8_t  step;              /* index in steps[], len = gap */
+    uint8_t  pass;
+} LedSeqChan_t;
+
+/* ===== Built-in patterns ===== */
+extern const LedSeqPattern_t led_pat_blink;         /* 500 ms on / off */
+extern const LedSeqPattern_t led_pat_heartbeat;
+extern const LedSeqPattern_t led_pat_sos;
+extern const LedSeqPattern_t led_pat_code[LED_SEQ_CODES];
+
+/* Public API */
+void     LedSeq_Init(LedSeqChan_t *chans, uint32_t count);
+void     LedSeq_Play(uint32_t ch, const LedSeqPattern_t *pat);
+void     LedSeq_Stop(uint32_t ch, uint8_t on);      /* LED stays on / off */
+void     LedSeq_OnTick(void);
+uint32_t LedSeq_NextDeadlineMs(void);
+
+#endif /* INC_LED_SEQ_H_ */
@@ -0,0 +1,36 @@
+/*
+ * LED brightness waveforms
+ *
+ * Precomputed TIM3 CCR3 sequences for the PWM LED (led_pwm.h),
+ * one byte per PWM period. The tables live in flash and are
+ * streamed into CCR3 by DMA, the CPU never touches a step.
+ *
+ * The tables in led_wave.c are generated on the host:
+ *   cd Sim && make wave       (Sim/Tools/led_wavegen.c)
+ * Change the lengths here, then regenerate.
+ *
+ * All ramps are gamma-corrected: equal steps in the table index
+ * are equal steps in perceived brightness.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_LED_WAVE_H_
+#define INC_LED_WAVE_H_
+
+#include <stdint.h>
+
+#define LED_PWM_MAX             255U    /* TIM3 ARR: 8-bit duty */
+#define LED_WAVE_STEP_MS        2U      /* one sample per PWM period (500 Hz) */
+#define LED_WAVE_GAMMA          2.2     /* generator only */
+
+#define LED_WAVE_BREATHE_LEN    1000U   /* 2 s, looped */
+#define LED_WAVE_FADE_LEN       250U    /* 0.5 s, one shot */
+#define LED_GAMMA_LEN           101U    /* 0 .. 100 % brightness */
+
+extern const uint8_t led_wave_breathe[LED_WAVE_BREATHE_LEN];
+extern const uint8_t led_wave_fade_in[LED_WAVE_FADE_LEN];
+extern const uint8_t led_wave_fade_out[LED_WAVE_FADE_LEN];
+extern const uint8_t led_gamma[LED_GAMMA_LEN];
+
+#endif /* INC_LED_WAVE_H_ */
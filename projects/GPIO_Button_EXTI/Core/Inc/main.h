@@ -50,6 +50,8 @@ extern "C" {
 /* USER CODE END EM */
 
 /* Exported functions prototypes ---------------------------------------------*/
+void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
+
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
@@ -66,14 +68,26 @@ void Error_Handler(void);
 #define USART_RX_GPIO_Port GPIOA
 #define LED_Pin GPIO_PIN_5
 #define LED_GPIO_Port GPIOA
+#define LED_PWM_Pin GPIO_PIN_0
+#define LED_PWM_GPIO_Port GPIOB
 #define TMS_Pin GPIO_PIN_13
 #define TMS_GPIO_Port GPIOA
 #define TCK_Pin GPIO_PIN_14
 #define TCK_GPIO_Port GPIOA
 #define SWO_Pin GPIO_PIN_3
 #define SWO_GPIO_Port GPIOB
+#define CAP_BUTTON_Pin GPIO_PIN_6
+#define CAP_BUTTON_GPIO_Port GPIOB
 
 /* USER CODE BEGIN Private defines */
+/* CAP_BUTTON also raises EXTI6 to wake the capture backend, see button_cap.h */
+#define CAP_BUTTON_EXTI_IRQn EXTI9_5_IRQn
+
+/* Optional key panel on GPIOB (keep PB0/LED_PWM, PB3/SWO and PB6/CAP_BUTTON free), active LOW, see button_bank.h */
+#define PANEL_KEYS_GPIO_Port GPIOB
+#ifndef PANEL_KEYS_Pins
+#define PANEL_KEYS_Pins 0U              /* 0 = no panel fitted */
+#endif
 
 /* USER CODE END Private defines */
 
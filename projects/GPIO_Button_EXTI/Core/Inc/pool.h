@@ -0,0 +1,78 @@
+/*
+ * Memory pool public interface
+ *
+ * Fixed-block allocator with compile-time size classes, used in
+ * place of the newlib heap (malloc / _sbrk are disabled, see
+ * sysmem.c):
+ *
+ *  - Pool_Alloc(size) takes a block of the smallest class that
+ *    fits; when that class is empty it spills to the next larger
+ *    one, NULL when none is free
+ *  - alloc and free are O(1): one bitmap per class, the free block
+ *    is found with a count-trailing-zeros, the class of a pointer
+ *    by its address range (at most POOL_CLASS_COUNT compares)
+ *  - any context: the bitmaps are updated in a short PRIMASK
+ *    section, ISRs may allocate and free
+ *  - no fragmentation, no headers: a block costs exactly its size
+ *  - freeing a pointer that is not an allocated block (foreign,
+ *    misaligned, double free) is ignored and counted
+ *  - a request larger than the largest class fails, it is counted
+ *    with that class
+ *
+ * Blocks are aligned to 8 bytes, the contents of a new block are
+ * undefined.
+ *
+ * Size classes: POOL_CLASSES(X) lists X(block_bytes, blocks) in
+ * ascending size, at most 32 blocks per class, block sizes a
+ * multiple of 8. Override it on the compiler command line to
+ * resize the pool for a build.
+ *
+ * Users: Log_Printf format buffer (128 B), wrapped command lines
+ * (64 B).
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_POOL_H_
+#define INC_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef POOL_CLASSES
+#define POOL_CLASSES(X) \
+    X(16U,  16U)        \
+    X(32U,   8U)        \
+    X(64U,   4U)        \
+    X(128U,  4U)
+#endif
+
+#define POOL_COUNT_(size, blocks)   + 1U
+#define POOL_CLASS_COUNT    (0U POOL_CLASSES(POOL_COUNT_))
+
+/* ===== Statistics, per class ===== */
+typedef struct {
+    uint16_t size;              /* block bytes */
+    uint16_t blocks;
+    uint16_t used;              /* allocated now */
+    uint16_t high_water;        /* most allocated at once */
+    uint32_t allocs;            /* blocks handed out by this class */
+    uint32_t spills;            /* of those, for a smaller request */
+    uint32_t fails;             /* requests that fit here first, got NULL */
+} PoolStats_t;
+
+/* Public API */
+void     Pool_Init(void);                   /* boot only: forget all blocks */
+
+void    *Pool_Alloc(size_t size);           /* any context, NULL = no block */
+void     Pool_Free(void *p);                /* any context, NULL is ignored */
+
+uint32_t Pool_ClassCount(void);
+void     Pool_GetStats(uint32_t cls, PoolStats_t *out);
+uint32_t Pool_BadFrees(void);               /* frees of non-blocks */
+
+/* newlib heap requests refused by _sbrk (sysmem.c) */
+void     Pool_OnSbrk(void);
+uint32_t Pool_SbrkRefused(void);
+
+#endif /* INC_POOL_H_ */
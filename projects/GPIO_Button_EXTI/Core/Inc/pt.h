@@ -0,0 +1,165 @@
+/*
+ * Protothread public interface
+ *
+ * Stackless coroutines for main-loop tasks: a task is a plain C
+ * function that returns at every wait and is re-entered at the
+ * same line on the next pass (switch / __LINE__ continuations).
+ * A multi-step sequence is written top to bottom instead of as a
+ * state enum plus one timestamp field per step.
+ *
+ * Writing a task:
+ *
+ *     static uint8_t Blink3(PtTask_t *t)
+ *     {
+ *         static uint8_t i;
+ *
+ *         PT_BEGIN(t);
+ *         for (i = 0; i < 3U; i++) {
+ *             Led_On();
+ *             PT_AWAIT_TIMEOUT(t, 200U);
+ *             Led_Off();
+ *             PT_AWAIT_EVENT_UNTIL(t, 1U << SIG_STOP, Pt_NowMs() + 300U);
+ *             if (t->got != 0U)
+ *                 PT_EXIT(t);
+ *         }
+ *         PT_END(t);
+ *     }
+ *
+ * Rules (the price of having no stack):
+ *  - locals do not survive a wait: keep them static, or in a
+ *    struct that embeds the PtTask_t as its first member
+ *  - waits only in the task function itself, not in callees
+ *  - no switch statement around a wait, one wait per source line
+ *
+ * Waits (arguments are evaluated once, when the wait starts):
+ *  - PT_AWAIT_COND(t, cond): re-checked on every scheduler pass
+ *  - PT_AWAIT_TIMEOUT(t, ms) / PT_AWAIT_UNTIL(t, at_ms)
+ *  - PT_AWAIT_EVENT(t, mask): any signal of the mask, the taken
+ *    signals are in t->got
+ *  - PT_AWAIT_COND_UNTIL / PT_AWAIT_EVENT_UNTIL: the same with a
+ *    time limit, cond / t->got tell which one ended the wait
+ *  - PT_YIELD(t): give the other tasks a pass
+ *
+ * Signals 0 .. 15 are delivered by Pt_Signal from any context and
+ * stay pending until a wait takes them (no lost wake-up); Pt_Clear
+ * drops stale ones before a wait that wants only new signals.
+ *
+ * Scheduling: Pt_Run() from the superloop resumes every task whose
+ * wait may be over (condition waits always, timed / event waits
+ * only when due). Time is Timebase_NowMs(), read once per pass.
+ * Pt_NextDeadlineMs() feeds the idle scheduler: condition waits
+ * add no deadline, they are re-checked after any wake-up, so a
+ * condition must change together with an interrupt or another
+ * task's progress.
+ *
+ * Memory: 24 bytes per task on the target (list link, function,
+ * continuation, wait, signals, deadline), no stack.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_PT_H_
+#define INC_PT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PT_NO_DEADLINE      UINT32_MAX
+
+/* task function results */
+#define PT_WAITING          0U
+#define PT_DONE             1U
+
+/* wait kinds, PtTask_t.wait */
+#define PT_WAIT_NONE        0x00U
+#define PT_WAIT_COND        0x01U
+#define PT_WAIT_TIME        0x02U
+#define PT_WAIT_EVENT       0x04U
+#define PT_WAIT_YIELD       0x08U
+#define PT_WAIT_DONE        0x80U   /* ended, Pt_Start restarts it */
+
+typedef struct PtTask PtTask_t;
+
+/* resumes the task, returns PT_WAITING or PT_DONE (PT_BEGIN / PT_END) */
+typedef uint8_t (*PtFn)(PtTask_t *t);
+
+/* ===== Task ===== */
+struct PtTask {
+    PtTask_t   *next;
+    PtFn        fn;
+    uint16_t    lc;                 /* continuation: source line, 0 = start */
+    uint8_t     wait;
+    volatile uint16_t events;       /* pending signals, bit = signal */
+    uint16_t    mask;               /* signals the event wait takes */
+    uint16_t    got;                /* signals the last event wait took */
+    uint32_t    deadline;           /* PT_WAIT_TIME, Timebase ms */
+};
+
+#if defined(__GNUC__) && (__GNUC__ >= 7)
+#define PT_FALLTHROUGH_     __attribute__((fallthrough))
+#else
+#define PT_FALLTHROUGH_     ((void)0)
+#endif
+
+/* ===== Task body ===== */
+#define PT_BEGIN(t)         switch ((t)->lc) { case 0U:
+#define PT_END(t)           } (t)->lc = 0U; (t)->wait = PT_WAIT_DONE; return PT_DONE
+#define PT_EXIT(t)          do { (t)->lc = 0U; (t)->wait = PT_WAIT_DONE; return PT_DONE; } while (0)
+
+/* suspend here until `ready` holds; the wait kind is set by the caller */
+#define PT_WAIT_(t, ready)                                          \
+    do {                                                            \
+        (t)->lc = (uint16_t)__LINE__;                               \
+        PT_FALLTHROUGH_;                                            \
+    case __LINE__:                                                  \
+        if (!(ready))                                               \
+            return PT_WAITING;                                      \
+        (t)->wait = PT_WAIT_NONE;                                   \
+    } while (0)
+
+#define PT_AWAIT_COND(t, cond)                                      \
+    do { Pt_Arm((t), PT_WAIT_COND, 0U, 0U);                         \
+         PT_WAIT_(t, (cond)); } while (0)
+
+#define PT_AWAIT_UNTIL(t, at_ms)                                    \
+    do { Pt_Arm((t), PT_WAIT_TIME, 0U, (at_ms));                    \
+         PT_WAIT_(t, Pt_Due(t)); } while (0)
+
+#define PT_AWAIT_TIMEOUT(t, ms)     PT_AWAIT_UNTIL((t), Pt_NowMs() + (ms))
+
+#define PT_AWAIT_COND_UNTIL(t, cond, at_ms)                         \
+    do { Pt_Arm((t), PT_WAIT_COND | PT_WAIT_TIME, 0U, (at_ms));     \
+         PT_WAIT_(t, (cond) || Pt_Due(t)); } while (0)
+
+#define PT_AWAIT_EVENT(t, sigmask)                                  \
+    do { Pt_Arm((t), PT_WAIT_EVENT, (sigmask), 0U);                 \
+         PT_WAIT_(t, Pt_Take(t)); } while (0)
+
+#define PT_AWAIT_EVENT_UNTIL(t, sigmask, at_ms)                     \
+    do { Pt_Arm((t), PT_WAIT_EVENT | PT_WAIT_TIME, (sigmask), (at_ms)); \
+         PT_WAIT_(t, Pt_Take(t) || Pt_Due(t)); } while (0)
+
+#define PT_YIELD(t)                                                 \
+    do { Pt_Arm((t), PT_WAIT_YIELD, 0U, 0U);                        \
+         PT_WAIT_(t, (t)->wait == PT_WAIT_NONE); } while (0)
+
+/* Public API */
+void     Pt_Init(void);                     /* forget all tasks */
+void     Pt_Start(PtTask_t *t, PtFn fn);    /* (re)start from PT_BEGIN */
+void     Pt_Stop(PtTask_t *t);              /* no further resumes */
+uint8_t  Pt_Running(const PtTask_t *t);     /* 1 = started, not ended */
+
+void     Pt_Signal(PtTask_t *t, uint8_t sig);   /* any context */
+void     Pt_Clear(PtTask_t *t, uint16_t sigmask);
+
+void     Pt_Run(void);                      /* superloop */
+void     Pt_RunAt(uint32_t now_ms);         /* same, caller's clock (replay) */
+uint32_t Pt_NextDeadlineMs(void);           /* 0 = run again, PT_NO_DEADLINE */
+
+/* used by the wait macros */
+uint32_t Pt_NowMs(void);                    /* time of the current pass */
+void     Pt_Arm(PtTask_t *t, uint8_t wait, uint16_t sigmask, uint32_t at_ms);
+uint8_t  Pt_Due(const PtTask_t *t);
+uint8_t  Pt_Take(PtTask_t *t);
+
+#endif /* INC_PT_H_ */
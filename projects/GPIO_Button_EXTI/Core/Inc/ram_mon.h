@@ -0,0 +1,71 @@
+/*
+ * RAM monitor public interface
+ *
+ * Stack high-water marks and RAM usage at run time, so the stack
+ * reservations in the linker script can be sized from measurements
+ * instead of guesses.
+ *
+ * Stacks (STM32F103RBTX_FLASH.ld, startup_stm32f103rbtx.s):
+ *  - two stacks: the main thread runs on PSP (_Min_Stack_Size),
+ *    every exception on MSP (_Min_Isr_Stack_Size) at the top of
+ *    RAM; Reset_Handler switches thread mode to PSP before main()
+ *  - both are painted with RAM_MON_PAINT at reset; the high-water
+ *    mark is the lowest word that no longer holds the paint
+ *  - the lowest word of each stack is its guard: once it is
+ *    overwritten the stack has reached (or passed) its end
+ *
+ * The F103 has no MPU: an overflow is detected after the fact by
+ * RamMon_Poll, not prevented. A main-stack overflow runs into the
+ * free RAM below the reservation, an ISR-stack overflow into the
+ * top of the main stack.
+ *
+ * Usage model:
+ *  - RamMon_Init() once after Log_Init()
+ *  - RamMon_Poll() from the superloop: guard check every call,
+ *    report every RAM_MON_REPORT_PERIOD_MS (0 = none)
+ *  - RamMon_GetStats() scans the stacks, cost proportional to the
+ *    stack space never used so far
+ *
+ * Per-function frame sizes: build with -fstack-usage (CubeIDE
+ * default) and run `make stack` in Sim/ (Sim/Tools/stack_usage.c).
+ *
+ * Platform: STM32 (Cortex-M3) + HAL
+ */
+
+#ifndef INC_RAM_MON_H_
+#define INC_RAM_MON_H_
+
+#include <stdint.h>
+
+#define RAM_MON_PAINT           0xA5A5A5A5U     /* startup StackPaint */
+
+#ifndef RAM_MON_REPORT_PERIOD_MS
+#define RAM_MON_REPORT_PERIOD_MS 0U     /* 0 = no periodic USART2 report */
+#endif
+
+/* overflow flags */
+#define RAM_MON_OVF_MAIN        0x01U
+#define RAM_MON_OVF_ISR         0x02U
+
+/* ===== Statistics, bytes ===== */
+typedef struct {
+    uint32_t main_size;         /* thread stack (PSP) */
+    uint32_t main_used;         /* high-water */
+    uint32_t isr_size;          /* exception stack (MSP) */
+    uint32_t isr_used;
+    uint32_t static_ram;        /* .data + .ramfunc + .bss */
+    uint32_t free_ram;          /* between .bss and the stacks */
+    uint32_t pool_size;         /* all pool classes (pool.h) */
+    uint32_t pool_used;
+    uint32_t pool_high_water;   /* sum of the per-class high-water marks */
+    uint32_t sbrk_refused;      /* newlib heap requests, heap is off */
+    uint8_t  overflow;          /* RAM_MON_OVF_* seen so far */
+} RamMonStats_t;
+
+/* Public API */
+void    RamMon_Init(void);
+void    RamMon_Poll(void);
+void    RamMon_GetStats(RamMonStats_t *out);
+uint8_t RamMon_Overflow(void);          /* RAM_MON_OVF_*, guard words only */
+
+#endif /* INC_RAM_MON_H_ */
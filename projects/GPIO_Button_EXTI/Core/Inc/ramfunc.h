@@ -0,0 +1,57 @@
+/*
+ * RAM-executed functions public interface
+ *
+ * Placement of the interrupt hot path in SRAM, and the bench that
+ * decides which functions are worth it.
+ *
+ * At 64 MHz the flash needs 2 wait states; the 2 x 64-bit prefetch
+ * buffer hides them for straight-line code, every taken branch or
+ * literal load that misses it stalls. Code in SRAM runs without
+ * wait states, but its fetches go over the System bus and share it
+ * with the data accesses: a function is only faster from RAM when
+ * it branches a lot, which the bench shows per function.
+ *
+ * Placement (STM32F103RBTX_FLASH.ld, startup_stm32f103rbtx.s):
+ *  - RAMFUNC puts a function into the .ramfunc section (RAM, load
+ *    image in flash), copied by Reset_Handler next to .data
+ *  - RAMFUNC_ENABLE=0 leaves everything in flash (and is the host
+ *    simulation setting)
+ *  - calls between flash and RAM are out of BL range: the linker
+ *    adds a long-branch veneer (a few cycles), calls inside
+ *    .ramfunc stay direct, the vector table points into RAM
+ *
+ * Bench (RAMFUNC_BENCH_ENABLE=1):
+ *  - RamFunc_BenchReport() once at boot, right after App_Init
+ *    (TIM2 not started), calls each candidate RAMFUNC_BENCH_ROUNDS
+ *    times and prints "ramfunc: <name> <ram|flash> min mean max"
+ *  - capture the output of a RAMFUNC_ENABLE=0 and a =1 build;
+ *    Sim/Tools/ramfunc_cmp prints the savings per function
+ *
+ * Platform: STM32 (Cortex-M3) + HAL
+ */
+
+#ifndef INC_RAMFUNC_H_
+#define INC_RAMFUNC_H_
+
+#ifndef RAMFUNC_ENABLE
+#define RAMFUNC_ENABLE          1
+#endif
+
+#ifndef RAMFUNC_BENCH_ENABLE
+#define RAMFUNC_BENCH_ENABLE    0
+#endif
+
+#define RAMFUNC_BENCH_ROUNDS    1000U
+
+/* noinline: an inlined copy would run from the caller's memory */
+#if RAMFUNC_ENABLE
+#define RAMFUNC     __attribute__((section(".ramfunc"), noinline))
+#else
+#define RAMFUNC
+#endif
+
+#if RAMFUNC_BENCH_ENABLE
+void RamFunc_BenchReport(void);
+#endif
+
+#endif /* INC_RAMFUNC_H_ */
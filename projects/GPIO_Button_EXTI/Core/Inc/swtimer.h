@@ -0,0 +1,77 @@
+/*
+ * Software timer public interface
+ *
+ * Hierarchical timing wheel for one-shot and periodic timeouts,
+ * clocked by the TIM2 tick (TICK_PERIOD_MS resolution).
+ *
+ * Wheel layout: SWTIMER_LEVELS levels of SWTIMER_SLOTS slots
+ *  - level 0 slot = 1 tick, level 1 slot = 64 ticks, level 2
+ *    slot = 4096 ticks (range 2^18 ticks, ~8.7 min at 2 ms);
+ *    longer timeouts park in the last level and re-cascade
+ *  - start / stop: O(1) (intrusive doubly linked slot lists)
+ *  - per tick: one level-0 slot, plus one cascaded upper slot
+ *    every 64 ticks, independent of the number of timers
+ *  - occupancy bitmaps give the next level-0 expiry in O(1)
+ *
+ * Usage model:
+ *  - SwTimer_OnTick() is a tick consumer (ISR): counts ticks only
+ *  - SwTimer_Process() runs in the main loop: advances the wheel
+ *    and calls expired callbacks in main-loop context
+ *  - SwTimer_Alloc / Start / Stop / Free from the main loop only
+ *
+ * Nodes come from a static pool of SWTIMER_POOL_SIZE entries.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_SWTIMER_H_
+#define INC_SWTIMER_H_
+
+#include <stdint.h>
+
+#ifndef SWTIMER_POOL_SIZE
+#define SWTIMER_POOL_SIZE   32U
+#endif
+
+#define SWTIMER_LEVELS      3U
+#define SWTIMER_SLOT_BITS   6U
+#define SWTIMER_SLOTS       (1U << SWTIMER_SLOT_BITS)
+
+#define SWTIMER_NO_DEADLINE UINT32_MAX
+
+/* ===== Timer callback, main-loop context ===== */
+typedef void (*SwTimerFn)(void *arg);
+
+/* ===== Timer node ===== */
+typedef struct SwTimer {
+    struct SwTimer *next;
+    struct SwTimer *prev;
+    uint32_t  expires;          /* absolute wheel tick */
+    uint32_t  period;           /* ticks, 0 = one-shot */
+    SwTimerFn fn;
+    void     *arg;
+    uint8_t   level;
+    uint8_t   slot;
+    uint8_t   active;
+    uint8_t   in_use;
+} SwTimer_t;
+
+/* Public API */
+void       SwTimer_Init(void);
+
+SwTimer_t *SwTimer_Alloc(SwTimerFn fn, void *arg);    /* NULL = pool empty */
+void       SwTimer_Free(SwTimer_t *tmr);
+
+/* (re)arm: first expiry after delay_ms, then every period_ms (0 = once) */
+void       SwTimer_Start(SwTimer_t *tmr, uint32_t delay_ms, uint32_t period_ms);
+void       SwTimer_Stop(SwTimer_t *tmr);
+uint8_t    SwTimer_IsActive(const SwTimer_t *tmr);
+
+void       SwTimer_OnTick(void);
+void       SwTimer_Process(void);
+
+/* ms until the next expiry (upper bound), 0 = pending work */
+uint32_t   SwTimer_NextDeadlineMs(void);
+uint32_t   SwTimer_ActiveCount(void);
+
+#endif /* INC_SWTIMER_H_ */
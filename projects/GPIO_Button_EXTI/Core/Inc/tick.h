@@ -0,0 +1,55 @@
+/*
+ * System tick public interface
+ *
+ * TIM2 update event (2 ms) fan-out to registered tick consumers.
+ *
+ * Two dispatch paths share the same consumer list:
+ *  - fast path (TICK_FAST_PATH=1): TIM2_IRQHandler calls
+ *    Tick_IRQHandler(), which only checks / clears UIF and
+ *    walks the consumer array
+ *  - HAL path  (TICK_FAST_PATH=0): HAL_TIM_IRQHandler scans all
+ *    TIM flags and ends in HAL_TIM_PeriodElapsedCallback,
+ *    which calls Tick_Dispatch()
+ *
+ * Consumers run in ISR context and must follow the template rule:
+ * only counters / event flags, no blocking, no HAL_Delay().
+ *
+ * TICK_BENCH_ENABLE=1 adds Tick_BenchReport(), a boot-time
+ * cycle-count comparison of both paths sent over USART2.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_TICK_H_
+#define INC_TICK_H_
+
+#include <stdint.h>
+
+#ifndef TICK_FAST_PATH
+#define TICK_FAST_PATH      1
+#endif
+
+#ifndef TICK_BENCH_ENABLE
+#define TICK_BENCH_ENABLE   0
+#endif
+
+/* TIM2 update period, must match MX_TIM2_Init (PSC / ARR) */
+#define TICK_PERIOD_MS      2U
+
+/* maximum number of registered tick consumers */
+#define TICK_MAX_CONSUMERS  8U
+
+/* ===== Tick consumer callback ===== */
+typedef void (*TickFn)(void);
+
+/* Public API */
+void    Tick_Init(void);
+uint8_t Tick_Register(TickFn fn);   /* 1 = registered, 0 = table full */
+void    Tick_Dispatch(void);
+void    Tick_IRQHandler(void);
+
+#if TICK_BENCH_ENABLE
+void    Tick_BenchReport(void);
+#endif
+
+#endif /* INC_TICK_H_ */
@@ -0,0 +1,38 @@
+/*
+ * Timebase public interface
+ *
+ * One monotonic time service for HAL and all FSMs, replacing
+ * the per-module tick counters.
+ *
+ * Backing counter: SysTick (HCLK, 1 ms reload)
+ *  - HAL_IncTick() / HAL_GetTick() are overridden here, the
+ *    SysTick ISR advances a single 64-bit millisecond counter
+ *  - sub-millisecond part is read from SysTick->VAL
+ *  - SysTick keeps counting in SLEEP (DWT CYCCNT stops in WFI);
+ *    the tickless idle scheduler stretches its reload or stops it
+ *    and reports the interrupts it skipped via Timebase_SkipTicks
+ *  - STOP mode halts SysTick: STOP residency is not accounted
+ *
+ * All functions are callable from ISR and thread context.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_TIMEBASE_H_
+#define INC_TIMEBASE_H_
+
+#include <stdint.h>
+
+/* Public API */
+void     Timebase_Init(void);
+
+uint64_t Timebase_NowUs(void);
+uint64_t Timebase_NowMs64(void);
+
+/* low 32 bits of the ms counter, compare as (now - start) */
+uint32_t Timebase_NowMs(void);
+
+/* SysTick interrupts that did not happen (idle.c), interrupts masked */
+void     Timebase_SkipTicks(uint32_t ticks);
+
+#endif /* INC_TIMEBASE_H_ */
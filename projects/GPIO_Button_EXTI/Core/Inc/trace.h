@@ -0,0 +1,69 @@
+/*
+ * Binary trace public interface
+ *
+ * Deferred-formatting trace: the target writes a format-string
+ * ID and the raw 32-bit arguments, the host rebuilds the text
+ * from the ELF (Sim/Tools/trace_decode.c).
+ *
+ * Record layout (little-endian, 8 + 4 * nargs bytes):
+ *  - byte 0     : TRACE_SYNC (0xA5, never part of ASCII log text)
+ *  - byte 1     : number of arguments (0..TRACE_MAX_ARGS)
+ *  - bytes 2..3 : format ID = offset of the string in trace_fmt
+ *  - bytes 4..7 : HAL_GetTick() timestamp (ms)
+ *  - then       : arguments, each cast to uint32_t
+ *
+ * Format strings live in the "trace_fmt" section, which the
+ * linker script keeps as a non-loaded INFO section: no flash is
+ * spent on them. Integer conversions only (%d %u %x %c %p).
+ *
+ * Records share the uart_log ring with text output, so a capture
+ * holds both; the decoder passes ASCII through unchanged.
+ *
+ * TRACE_ENABLE=0 (default) compiles every TRACE() to nothing.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_TRACE_H_
+#define INC_TRACE_H_
+
+#include <stdint.h>
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE    0
+#endif
+
+#define TRACE_SYNC      0xA5U
+#define TRACE_MAX_ARGS  4U
+
+#if TRACE_ENABLE
+
+/* start of the trace_fmt section (linker script / GNU ld) */
+extern const char __start_trace_fmt[];
+
+uint32_t HAL_GetTick(void);
+
+void Trace_Emit(const uint32_t *words, uint32_t nwords);
+
+#define TRACE_NARGS(...)    TRACE_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define TRACE_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+
+#define TRACE(fmt, ...)                                                         \
+    do {                                                                        \
+        static const char trace_fmt_[]                                          \
+            __attribute__((section("trace_fmt"), used)) = fmt;                  \
+        uint32_t trace_rec_[] = {                                               \
+            TRACE_SYNC | ((uint32_t)TRACE_NARGS(__VA_ARGS__) << 8) |            \
+                ((uint32_t)(trace_fmt_ - __start_trace_fmt) << 16),             \
+            HAL_GetTick(), ##__VA_ARGS__                                        \
+        };                                                                      \
+        Trace_Emit(trace_rec_, sizeof(trace_rec_) / sizeof(trace_rec_[0]));     \
+    } while (0)
+
+#else
+
+#define TRACE(fmt, ...)     do { } while (0)
+
+#endif /* TRACE_ENABLE */
+
+#endif /* INC_TRACE_H_ */
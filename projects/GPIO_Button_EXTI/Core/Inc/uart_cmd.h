@@ -0,0 +1,76 @@
+/*
+ * UART command receiver public interface
+ *
+ * Line-based command input on USART2: DMA1 Channel 6 writes into
+ * a circular RAM buffer, HAL_UARTEx_ReceiveToIdle_DMA reports
+ * progress on half-transfer, transfer-complete and line IDLE.
+ *
+ * Behavior:
+ *  - no per-byte interrupts: the ISR only advances a byte count
+ *  - Cmd_Process() (main loop) splits the stream at '\n' and
+ *    calls the handler with a (pointer, length) view into the
+ *    DMA buffer, nothing is copied
+ *  - only a line that wraps around the buffer end is copied,
+ *    into a block from the pool (pool.h) that is freed when the
+ *    handler returns (counted in wrap_copies, a line without a
+ *    free block is dropped and counted in no_memory)
+ *  - '\r' before '\n' is stripped, args are NOT NUL-terminated
+ *  - a view stays valid until the handler returns, as long as
+ *    fewer than CMD_RX_BUF_SIZE new bytes arrive meanwhile
+ *    (512 B = ~44 ms at the shipped 115200 baud, ~5.5 ms at
+ *    921600, the rate the host sim checks)
+ *  - if the DMA overwrote unparsed data, parsing resumes at the
+ *    next '\n' in the newest half buffer (counted in overflows)
+ *
+ * Command table: { "name", handler, "help text" }, the first
+ * word of a line selects the entry, "help" lists the table.
+ * Replies go through the UART log (Log_Printf).
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_UART_CMD_H_
+#define INC_UART_CMD_H_
+
+#include <stdint.h>
+
+#ifndef CMD_RX_BUF_SIZE
+#define CMD_RX_BUF_SIZE     512U    /* power of two, DMA circular buffer */
+#endif
+
+#ifndef CMD_LINE_MAX
+#define CMD_LINE_MAX        64U     /* longer lines are dropped */
+#endif
+
+/* args / len: rest of the line after the command word */
+typedef void (*CmdHandler)(const char *args, uint32_t len);
+
+typedef struct {
+    const char *name;
+    CmdHandler  fn;
+    const char *help;
+} CmdEntry_t;
+
+/* ===== Statistics ===== */
+typedef struct {
+    uint32_t rx_bytes;
+    uint32_t frames;            /* non-empty lines parsed */
+    uint32_t unknown;
+    uint32_t too_long;
+    uint32_t overflows;         /* lines lost to DMA overwrite */
+    uint32_t wrap_copies;
+    uint32_t no_memory;         /* wrapped lines lost, pool empty */
+    uint32_t uart_errors;       /* reception restarted */
+} CmdStats_t;
+
+/* Public API */
+void    Cmd_Init(const CmdEntry_t *table, uint32_t count);
+void    Cmd_Process(void);
+uint8_t Cmd_Pending(void);                  /* 1 = unparsed bytes */
+void    Cmd_GetStats(CmdStats_t *out);
+
+/* USART2 ISR hooks (HAL_UARTEx_RxEventCallback / HAL_UART_ErrorCallback) */
+void    Cmd_OnRxEvent(uint16_t pos);
+void    Cmd_OnUartError(void);
+
+#endif /* INC_UART_CMD_H_ */
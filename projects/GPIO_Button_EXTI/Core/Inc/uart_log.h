@@ -0,0 +1,59 @@
+/*
+ * UART log public interface
+ *
+ * Non-blocking log channel on USART2: writers copy into a RAM
+ * ring buffer, DMA1 Channel 7 drains it in the background.
+ *
+ * Behavior:
+ *  - Log_Write() / Log_Printf() cost one memcpy (+ vsnprintf),
+ *    never the ~87 us per byte of a blocking 115200 transfer
+ *  - each DMA transfer covers one contiguous chunk of the ring;
+ *    its TX-complete interrupt releases the chunk and starts
+ *    the next one (wrap = two chunks)
+ *  - messages are all-or-nothing: if a message does not fit it
+ *    is dropped and counted, so binary dumps are never torn
+ *  - callable from any context (short PRIMASK section)
+ *
+ * LOG_RETARGET_STDIO=1 routes printf() (newlib _write) here.
+ *
+ * Platform: STM32 + HAL
+ */
+
+#ifndef INC_UART_LOG_H_
+#define INC_UART_LOG_H_
+
+#include <stdint.h>
+
+#ifndef LOG_BUF_SIZE
+#define LOG_BUF_SIZE        1024U   /* power of two */
+#endif
+
+#ifndef LOG_LINE_MAX
+#define LOG_LINE_MAX        128U    /* Log_Printf pool block, <= largest POOL_CLASSES size */
+#endif
+
+#ifndef LOG_RETARGET_STDIO
+#define LOG_RETARGET_STDIO  1
+#endif
+
+/* ===== Statistics ===== */
+typedef struct {
+    uint32_t bytes_written;
+    uint32_t bytes_dropped;
+    uint32_t msgs_dropped;
+    uint32_t dma_chunks;
+    uint32_t dma_errors;
+    uint32_t high_water;        /* max bytes queued */
+} LogStats_t;
+
+/* Public API */
+void     Log_Init(void);
+uint8_t  Log_Write(const void *data, uint32_t len);    /* 1 = queued, 0 = dropped */
+int      Log_Printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+uint32_t Log_Pending(void);                             /* bytes queued or in flight */
+void     Log_GetStats(LogStats_t *out);
+
+/* USART2 TX complete (HAL_UART_TxCpltCallback, ISR context) */
+void     Log_OnTxComplete(void);
+
+#endif /* INC_UART_LOG_H_ */
@@ -0,0 +1,206 @@
+/*
+ * Active object module
+ *
+ * Priority run-to-completion dispatcher over per-AO event queues,
+ * see ao.h.
+ *
+ * Responsibilities:
+ *  - register AOs by priority, keep the ready bitmask
+ *  - post / notify / publish into AO queues
+ *  - hand one event at a time to the highest ready AO
+ *  - count dispatched events and the longest queue wait
+ *
+ * Design principles:
+ *  - the queues are the evq.h SPSC rings; the main loop becomes a
+ *    second producer only inside a PRIMASK section, which the
+ *    ISRs (one NVIC level) cannot interleave with
+ *  - the ready bit is cleared with IRQs masked and only when the
+ *    queue is seen empty, so a post from an ISR is never lost
+ *  - no blocking and no preemption between AOs: a handler is the
+ *    unit of latency, keep it short
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include <stddef.h>
+
+#include "ao.h"
+#include "main.h"
+#include "ramfunc.h"
+
+static Ao_t *ao_table[AO_MAX_PRIO];
+static volatile uint32_t ao_ready;          /* bit = prio - 1 */
+static uint32_t ao_subs[AO_MAX_SIGNALS];    /* subscribers, bit = prio - 1 */
+
+static uint32_t Ao_Bit(const Ao_t *ao)
+{
+    return 1UL << (ao->prio - 1U);
+}
+
+/* ISR context or IRQs masked; prio 0 = not started yet */
+static RAMFUNC uint8_t Ao_Enqueue(Ao_t *ao, uint16_t sig, uint16_t arg)
+{
+    if (!EvQ_Post(&ao->queue, sig, arg))
+        return 0;
+    if (ao->prio != 0U)
+        ao_ready |= Ao_Bit(ao);
+    return 1;
+}
+
+/* ISR context or IRQs masked */
+static RAMFUNC uint8_t Ao_EnqueueOnce(Ao_t *ao, uint16_t sig)
+{
+    uint32_t bit = 1UL << sig;
+
+    if (ao->latched & bit)
+        return 1;                   /* one is still queued */
+    if (!Ao_Enqueue(ao, sig, 0))
+        return 0;
+    ao->latched |= bit;
+    return 1;
+}
+
+/* public API */
+
+void Ao_Init(void)
+{
+    for (uint32_t i = 0; i < AO_MAX_PRIO; i++)
+        ao_table[i] = NULL;
+    for (uint32_t i = 0; i < AO_MAX_SIGNALS; i++)
+        ao_subs[i] = 0;
+    ao_ready = 0;
+}
+
+uint8_t Ao_Start(Ao_t *ao, const char *name, uint8_t prio, AoHandlerFn handler,
+                 Event_t *storage, uint32_t capacity)
+{
+    if (prio == 0U || prio > AO_MAX_PRIO || ao_table[prio - 1U] != NULL || handler == NULL)
+        return 0;
+    if (!EvQ_Init(&ao->queue, storage, capacity))
+        return 0;
+
+    ao->handler     = handler;
+    ao->name        = name;
+    ao->prio        = prio;
+    ao->latched     = 0;
+    ao->events      = 0;
+    ao->max_wait_ms = 0;
+    ao_table[prio - 1U] = ao;
+    return 1;
+}
+
+uint8_t Ao_Post(Ao_t *ao, uint16_t sig, uint16_t arg)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint8_t ok;
+
+    __disable_irq();
+    ok = Ao_Enqueue(ao, sig, arg);
+    __set_PRIMASK(primask);
+    return ok;
+}
+
+RAMFUNC uint8_t Ao_PostFromIsr(Ao_t *ao, uint16_t sig, uint16_t arg)
+{
+    return Ao_Enqueue(ao, sig, arg);
+}
+
+uint8_t Ao_Notify(Ao_t *ao, uint16_t sig)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint8_t ok;
+
+    if (sig >= AO_MAX_SIGNALS)
+        return 0;
+
+    __disable_irq();
+    ok = Ao_EnqueueOnce(ao, sig);
+    __set_PRIMASK(primask);
+    return ok;
+}
+
+RAMFUNC uint8_t Ao_NotifyFromIsr(Ao_t *ao, uint16_t sig)
+{
+    if (sig >= AO_MAX_SIGNALS)
+        return 0;
+    return Ao_EnqueueOnce(ao, sig);
+}
+
+void Ao_Subscribe(Ao_t *ao, uint16_t sig)
+{
+    if (sig < AO_MAX_SIGNALS)
+        ao_subs[sig] |= Ao_Bit(ao);
+}
+
+void Ao_Unsubscribe(Ao_t *ao, uint16_t sig)
+{
+    if (sig < AO_MAX_SIGNALS)
+        ao_subs[sig] &= ~Ao_Bit(ao);
+}
+
+uint32_t Ao_Publish(uint16_t sig, uint16_t arg)
+{
+    uint32_t subs, n = 0;
+
+    if (sig >= AO_MAX_SIGNALS)
+        return 0;
+
+    for (subs = ao_subs[sig]; subs != 0U; ) {
+        uint32_t p = 31U - (uint32_t)__builtin_clz(subs);
+
+        subs &= ~(1UL << p);
+        n += Ao_Post(ao_table[p], sig, arg);
+    }
+    return n;
+}
+
+uint8_t Ao_RunOne(void)
+{
+    uint32_t ready = ao_ready;
+    uint32_t primask, wait;
+    Event_t evt;
+    Ao_t *ao;
+
+    if (ready == 0U)
+        return 0;
+
+    ao = ao_table[31U - (uint32_t)__builtin_clz(ready)];
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (!EvQ_Get(&ao->queue, &evt)) {
+        ao_ready &= ~Ao_Bit(ao);
+        __set_PRIMASK(primask);
+        return 1;
+    }
+    if (EvQ_Count(&ao->queue) == 0U)
+        ao_ready &= ~Ao_Bit(ao);
+    if (evt.type < AO_MAX_SIGNALS)
+        ao->latched &= ~(1UL << evt.type);
+    __set_PRIMASK(primask);
+
+    wait = HAL_GetTick() - evt.ts_ms;
+    if (wait > ao->max_wait_ms)
+        ao->max_wait_ms = wait;
+    ao->events++;
+    ao->handler(ao, &evt);
+    return 1;
+}
+
+void Ao_Run(void)
+{
+    while (Ao_RunOne())
+        ;
+}
+
+uint8_t Ao_Ready(void)
+{
+    return ao_ready != 0U;
+}
+
+const Ao_t *Ao_Get(uint8_t prio)
+{
+    if (prio == 0U || prio > AO_MAX_PRIO)
+        return NULL;
+    return ao_table[prio - 1U];
+}
@@ -0,0 +1,633 @@
+/*
+ * Application module
+ *
+ * Superloop body and HAL callbacks of GPIO_Button_EXTI.
+ *
+ * Responsibilities:
+ *  - create and initialize button / LED FSM instances
+ *  - scan the optional key panel through a button bank
+ *  - run the second button (CAP_BUTTON) on the TIM4 capture backend
+ *  - route button events to LED modes
+ *  - register the FSM tick consumers
+ *  - serve the USART2 command line (led / echo / stats / cfg)
+ *  - restore and persist settings through the flash store
+ *
+ * Active objects (ao.h), highest priority first:
+ *  - buttons: EXTI edges and polls -> USER / CAP / panel FSMs,
+ *    publishes APP_EVT_BUTTON
+ *  - led:     subscribes APP_EVT_BUTTON, takes LED commands, owns
+ *             the LED mode and its persistence
+ *  - shell:   USART2 lines -> command table
+ *
+ * Main-loop tasks (pt.h): `led demo`, a timed walk through the LED
+ * modes written as one coroutine.
+ *
+ * Design principles:
+ *  - ISR callbacks only forward ticks / post events; heavier
+ *    interrupt-side work (capture conversion) is deferred to
+ *    PendSV (defer.h)
+ *  - all application decisions are taken in AO handlers, which
+ *    App_Process() runs; an AO without events is not called
+ *  - only HAL GPIO / TIM / UART symbols are used, so the module
+ *    links unchanged against the host HAL shim in Sim/
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include <string.h>
+
+#include "app.h"
+#include "main.h"
+#include "ramfunc.h"
+#include "ao.h"
+#include "defer.h"
+#include "pt.h"
+#include "pool.h"
+#include "tim.h"
+#include "usart.h"
+#include "uart_log.h"
+#include "uart_cmd.h"
+#include "kv_store.h"
+#include "tick.h"
+#include "timebase.h"
+#include "evq.h"
+#include "swtimer.h"
+#include "button_fsm.h"
+#include "button_bank.h"
+#include "button_cap.h"
+#include "led_fsm.h"
+#include "led_seq.h"
+#include "trace.h"
+
+/* AO queues; EXTI, TIM2 and USART2 share NVIC priority 0 */
+#define APP_EVQ_SIZE        16U     /* buttons: one event per EXTI edge */
+#define APP_LED_EVQ_SIZE    8U
+#define APP_SHELL_EVQ_SIZE  4U
+
+/* AO priorities */
+enum {
+    APP_PRIO_SHELL = 1,
+    APP_PRIO_LED,
+    APP_PRIO_BUTTONS,
+};
+
+/* signals; below AO_MAX_SIGNALS: publish / notify capable */
+enum {
+    APP_EVT_EXTI = 1,       /* -> buttons, arg = GPIO pin mask */
+    APP_EVT_BTN_POLL,       /* -> buttons, notify: tick while busy, CAP edge */
+    APP_EVT_BUTTON,         /* published, arg = APP_BTN_x << 8 | ButtonEvent_t */
+    APP_EVT_PANEL,          /* published, arg = key << 8 | ButtonEvent_t */
+    APP_EVT_LED_MODE,       /* -> led, arg = LedMode_t, stored */
+    APP_EVT_LED_LEVEL,      /* -> led, arg = DIM percent, stored */
+    APP_EVT_LED_PATTERN,    /* -> led, arg = APP_PAT_x */
+    APP_EVT_LED_SHOW,       /* -> led, arg = LedMode_t, not stored (demo) */
+    APP_EVT_CMD_RX,         /* -> shell, notify: USART2 bytes / error */
+};
+
+/* LED patterns by number: sos, heartbeat, then Morse codes 1.. */
+enum {
+    APP_PAT_SOS = 0,
+    APP_PAT_HEARTBEAT,
+    APP_PAT_CODE,
+};
+
+/* `led demo`: time per mode; signals of the demo task */
+#define APP_DEMO_STEP_MS    1500U
+
+enum {
+    APP_DEMO_SIG_STOP = 0,  /* another LED change: leave it alone */
+};
+
+/* button tags in TRACE records */
+enum {
+    APP_BTN_USER = 0,
+    APP_BTN_CAP,
+};
+
+ButtonCtx_t btn_user;
+ButtonCtx_t btn_cap;        /* PB6, TIM4 input capture backend */
+ButtonBank_t panel_keys;
+
+static Event_t ao_buttons_buf[APP_EVQ_SIZE];
+static Event_t ao_led_buf[APP_LED_EVQ_SIZE];
+static Event_t ao_shell_buf[APP_SHELL_EVQ_SIZE];
+
+static Ao_t ao_buttons = AO_INITIALIZER(ao_buttons_buf, APP_EVQ_SIZE);
+static Ao_t ao_led     = AO_INITIALIZER(ao_led_buf, APP_LED_EVQ_SIZE);
+static Ao_t ao_shell   = AO_INITIALIZER(ao_shell_buf, APP_SHELL_EVQ_SIZE);
+
+/* buttons AO: a gesture is in progress, the tick polls it */
+static volatile uint8_t app_btn_busy;
+
+/* USER button: stored debounce / long press, multi-click on; no
+ * hold repeat, so a held button leaves the tick gated */
+static ButtonProfile_t app_btn_profile =
+    BTN_PROFILE_INIT(BTN_DEBOUNCE_MS, BTN_LONG_PRESS_MS, BTN_MULTI_CLICK_MS, 0U);
+
+/* Application-level LED state (decoupled from LED FSM internals) */
+static LedMode_t app_led_mode = LED_MODE_OFF;
+
+static PtTask_t app_demo;
+
+/* sequencer channels: LD2 first (LED_CH_LD2), status LEDs after it */
+static LedSeqChan_t app_leds[] = {
+    LED_SEQ_CHANNEL(LED_GPIO_Port, LED_Pin),
+};
+
+static uint8_t UserButton_Read(void)
+{
+    /* кнопка активна по LOW */
+    return (HAL_GPIO_ReadPin(USER_BUTTON_GPIO_Port, USER_BUTTON_Pin) == GPIO_PIN_RESET);
+}
+
+/* ===== LED AO ===== */
+
+/* LED mode survives a reset: stored on every change */
+static void App_SetLedMode(LedMode_t mode)
+{
+    app_led_mode = mode;
+    Led_SetMode(mode);
+    (void)Kv_SetU32(KV_KEY_LED_MODE, (uint32_t)mode);
+}
+
+/* patterns signal a live condition: not stored, a reset clears them */
+static void App_SetLedPattern(uint16_t id)
+{
+    const LedSeqPattern_t *pat;
+
+    if (id == APP_PAT_SOS)
+        pat = &led_pat_sos;
+    else if (id == APP_PAT_HEARTBEAT)
+        pat = &led_pat_heartbeat;
+    else if ((uint32_t)id - APP_PAT_CODE < LED_SEQ_CODES)
+        pat = &led_pat_code[id - APP_PAT_CODE];
+    else
+        return;
+
+    app_led_mode = LED_MODE_PATTERN;
+    Led_SetPattern(pat);
+}
+
+/* USER and CAP_BUTTON share one meaning: btn only tags the trace */
+static void App_OnButtonEvent(uint32_t btn, ButtonEvent_t evt)
+{
+    switch (evt) {
+        case BTN_EVENT_SHORT:
+            if (app_led_mode == LED_MODE_OFF)
+                app_led_mode = LED_MODE_BLINK;
+            else
+                app_led_mode = LED_MODE_OFF;
+            TRACE("button %u short -> led mode %u\n", btn, app_led_mode);
+            App_SetLedMode(app_led_mode);
+            break;
+
+        case BTN_EVENT_LONG:
+            app_led_mode = LED_MODE_ON;
+            TRACE("button %u long -> led mode %u\n", btn, app_led_mode);
+            App_SetLedMode(app_led_mode);
+            break;
+
+        case BTN_EVENT_DOUBLE:
+            TRACE("button %u double -> breathe\n", btn);
+            App_SetLedMode(LED_MODE_BREATHE);
+            break;
+
+        case BTN_EVENT_TRIPLE:
+            TRACE("button %u triple -> heartbeat\n", btn);
+            App_SetLedPattern(APP_PAT_HEARTBEAT);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void App_LedHandler(Ao_t *me, const Event_t *evt)
+{
+    (void)me;
+
+    /* a button or a command takes the LED over from the demo */
+    if (evt->type != APP_EVT_LED_SHOW)
+        Pt_Signal(&app_demo, APP_DEMO_SIG_STOP);
+
+    switch (evt->type) {
+        case APP_EVT_BUTTON:
+            App_OnButtonEvent(evt->arg >> 8, (ButtonEvent_t)(evt->arg & 0xFFU));
+            break;
+
+        case APP_EVT_LED_MODE:
+            App_SetLedMode((LedMode_t)evt->arg);
+            break;
+
+        case APP_EVT_LED_LEVEL:
+            Led_SetLevel((uint8_t)evt->arg);
+            (void)Kv_SetU32(KV_KEY_LED_LEVEL, evt->arg);
+            break;
+
+        case APP_EVT_LED_PATTERN:
+            App_SetLedPattern(evt->arg);
+            break;
+
+        case APP_EVT_LED_SHOW:
+            Led_SetMode((LedMode_t)evt->arg);
+            break;
+
+        default:
+            break;
+    }
+    Led_Process();
+}
+
+/* ===== LED demo task ===== */
+
+static const LedMode_t app_demo_modes[] = {
+    LED_MODE_ON, LED_MODE_BLINK, LED_MODE_DIM, LED_MODE_BREATHE,
+    LED_MODE_FADE_OUT, LED_MODE_FADE_IN,
+};
+
+/* every mode for APP_DEMO_STEP_MS, then the stored mode again */
+static uint8_t App_DemoTask(PtTask_t *t)
+{
+    static uint32_t i;
+
+    PT_BEGIN(t);
+    for (i = 0; i < sizeof(app_demo_modes) / sizeof(app_demo_modes[0]); i++) {
+        /* LED queue full of button events: retry once it drained */
+        PT_AWAIT_COND(t, Ao_Post(&ao_led, APP_EVT_LED_SHOW, app_demo_modes[i]));
+        PT_AWAIT_EVENT_UNTIL(t, 1U << APP_DEMO_SIG_STOP, Pt_NowMs() + APP_DEMO_STEP_MS);
+        if (t->got != 0U)
+            PT_EXIT(t);
+    }
+    PT_AWAIT_COND(t, Ao_Post(&ao_led, APP_EVT_LED_MODE,
+                             (uint16_t)Kv_GetU32(KV_KEY_LED_MODE, LED_MODE_OFF)));
+    PT_END(t);
+}
+
+/* ===== USART2 commands ===== */
+
+static uint8_t App_ArgIs(const char *args, uint32_t len, const char *word)
+{
+    return (strlen(word) == len) && (memcmp(args, word, len) == 0);
+}
+
+/* "<word> <decimal>", returns 0 if the number is missing or malformed */
+static uint8_t App_ArgNumber(const char *args, uint32_t len, const char *word, uint32_t *value)
+{
+    uint32_t n = strlen(word), v = 0;
+
+    if (len <= n + 1U || memcmp(args, word, n) != 0 || args[n] != ' ')
+        return 0;
+
+    for (uint32_t i = n + 1U; i < len; i++) {
+        if (args[i] < '0' || args[i] > '9' || v > 100000U)
+            return 0;
+        v = v * 10U + (uint32_t)(args[i] - '0');
+    }
+    *value = v;
+    return 1;
+}
+
+/* LED changes are events for the LED AO, applied after this handler */
+static void App_CmdLed(const char *args, uint32_t len)
+{
+    uint32_t pct, code;
+    uint8_t ok;
+
+    if (App_ArgIs(args, len, "off"))
+        ok = Ao_Post(&ao_led, APP_EVT_LED_MODE, LED_MODE_OFF);
+    else if (App_ArgIs(args, len, "on"))
+        ok = Ao_Post(&ao_led, APP_EVT_LED_MODE, LED_MODE_ON);
+    else if (App_ArgIs(args, len, "blink"))
+        ok = Ao_Post(&ao_led, APP_EVT_LED_MODE, LED_MODE_BLINK);
+    else if (App_ArgIs(args, len, "dim"))
+        ok = Ao_Post(&ao_led, APP_EVT_LED_MODE, LED_MODE_DIM);
+    else if (App_ArgNumber(args, len, "dim", &pct) && pct <= 100U)
+        ok = Ao_Post(&ao_led, APP_EVT_LED_LEVEL, (uint16_t)pct) &&
+             Ao_Post(&ao_led, APP_EVT_LED_MODE, LED_MODE_DIM);
+    else if (App_ArgIs(args, len, "breathe"))
+        ok = Ao_Post(&ao_led, APP_EVT_LED_MODE, LED_MODE_BREATHE);
+    else if (App_ArgIs(args, len, "fade in"))
+        ok = Ao_Post(&ao_led, APP_EVT_LED_MODE, LED_MODE_FADE_IN);
+    else if (App_ArgIs(args, len, "fade out"))
+        ok = Ao_Post(&ao_led, APP_EVT_LED_MODE, LED_MODE_FADE_OUT);
+    else if (App_ArgIs(args, len, "sos"))
+        ok = Ao_Post(&ao_led, APP_EVT_LED_PATTERN, APP_PAT_SOS);
+    else if (App_ArgIs(args, len, "heartbeat"))
+        ok = Ao_Post(&ao_led, APP_EVT_LED_PATTERN, APP_PAT_HEARTBEAT);
+    else if (App_ArgNumber(args, len, "code", &code) && code >= 1U && code <= LED_SEQ_CODES)
+        ok = Ao_Post(&ao_led, APP_EVT_LED_PATTERN, (uint16_t)(APP_PAT_CODE + code - 1U));
+    else if (App_ArgIs(args, len, "demo")) {
+        Pt_Start(&app_demo, App_DemoTask);
+        ok = 1;
+    } else {
+        (void)Log_Printf("ERR led off|on|blink|dim [0..100]|breathe|fade in|fade out|"
+                         "sos|heartbeat|code <1..12>|demo\r\n");
+        return;
+    }
+
+    (void)Log_Printf(ok ? "OK\r\n" : "ERR busy\r\n");
+}
+
+/* timing settings are read once at boot: applied after the next reset */
+static void App_CmdCfg(const char *args, uint32_t len)
+{
+    KvStats_t ks;
+    uint32_t v;
+
+    if (App_ArgNumber(args, len, "debounce", &v)) {
+        (void)Log_Printf(Kv_SetU32(KV_KEY_DEBOUNCE_MS, v) ? "OK, after reset\r\n" : "ERR flash\r\n");
+        return;
+    }
+    if (App_ArgNumber(args, len, "long", &v)) {
+        (void)Log_Printf(Kv_SetU32(KV_KEY_LONG_PRESS_MS, v) ? "OK, after reset\r\n" : "ERR flash\r\n");
+        return;
+    }
+    if (len != 0U) {
+        (void)Log_Printf("ERR cfg [debounce <ms>|long <ms>]\r\n");
+        return;
+    }
+
+    Kv_GetStats(&ks);
+    (void)Log_Printf("debounce %lu long %lu led %lu\r\n",
+                     (unsigned long)Kv_GetU32(KV_KEY_DEBOUNCE_MS, BTN_DEBOUNCE_MS),
+                     (unsigned long)Kv_GetU32(KV_KEY_LONG_PRESS_MS, BTN_LONG_PRESS_MS),
+                     (unsigned long)app_led_mode);
+    (void)Log_Printf("kv records %lu erases %lu gc %lu crc %lu err %lu free %lu\r\n",
+                     (unsigned long)ks.records, (unsigned long)ks.page_erases,
+                     (unsigned long)ks.gc_copies, (unsigned long)ks.crc_errors,
+                     (unsigned long)ks.flash_errors, (unsigned long)ks.free_bytes);
+}
+
+static void App_CmdEcho(const char *args, uint32_t len)
+{
+    (void)Log_Printf("%.*s\r\n", (int)len, args);
+}
+
+static void App_CmdStats(const char *args, uint32_t len)
+{
+    CmdStats_t cs;
+    LogStats_t ls;
+    BtnCapStats_t bs;
+    DeferStats_t ds;
+
+    (void)args;
+    (void)len;
+    Cmd_GetStats(&cs);
+    Log_GetStats(&ls);
+    BtnCap_GetStats(&bs);
+    Defer_GetStats(&ds);
+
+    (void)Log_Printf("rx %lu frames %lu unknown %lu long %lu ovf %lu wrap %lu nomem %lu err %lu\r\n",
+                     (unsigned long)cs.rx_bytes, (unsigned long)cs.frames,
+                     (unsigned long)cs.unknown, (unsigned long)cs.too_long,
+                     (unsigned long)cs.overflows, (unsigned long)cs.wrap_copies,
+                     (unsigned long)cs.no_memory, (unsigned long)cs.uart_errors);
+    (void)Log_Printf("tx %lu dropped %lu/%lu hw %lu\r\n",
+                     (unsigned long)ls.bytes_written, (unsigned long)ls.msgs_dropped,
+                     (unsigned long)ls.bytes_dropped, (unsigned long)ls.high_water);
+    for (uint8_t prio = AO_MAX_PRIO; prio != 0U; prio--) {
+        const Ao_t *ao = Ao_Get(prio);
+
+        if (ao != NULL)
+            (void)Log_Printf("ao %s ev %lu wait %lu ms hw %lu ovf %lu\r\n", ao->name,
+                             (unsigned long)ao->events, (unsigned long)ao->max_wait_ms,
+                             (unsigned long)EvQ_HighWater(&ao->queue),
+                             (unsigned long)EvQ_Overflows(&ao->queue));
+    }
+    (void)Log_Printf("cap edges %lu wakes %lu ovf %lu resync %lu press %lu us\r\n",
+                     (unsigned long)bs.edges, (unsigned long)bs.wakes,
+                     (unsigned long)bs.overflows, (unsigned long)bs.resyncs,
+                     (unsigned long)bs.last_press_us);
+    (void)Log_Printf("defer sched %lu coalesced %lu runs %lu batch %lu\r\n",
+                     (unsigned long)ds.scheduled, (unsigned long)ds.coalesced,
+                     (unsigned long)ds.runs, (unsigned long)ds.max_batch);
+    for (uint32_t c = 0; c < Pool_ClassCount(); c++) {
+        PoolStats_t ps;
+
+        Pool_GetStats(c, &ps);
+        (void)Log_Printf("pool %3u B used %u/%u hw %u allocs %lu spills %lu fails %lu\r\n",
+                         ps.size, ps.used, ps.blocks, ps.high_water,
+                         (unsigned long)ps.allocs, (unsigned long)ps.spills,
+                         (unsigned long)ps.fails);
+    }
+    (void)Log_Printf("pool bad frees %lu, sbrk refused %lu\r\n",
+                     (unsigned long)Pool_BadFrees(), (unsigned long)Pool_SbrkRefused());
+}
+
+static const CmdEntry_t app_cmds[] = {
+    { "led",   App_CmdLed,   "off|on|blink|dim [0..100]|breathe|fade in|fade out|"
+                             "sos|heartbeat|code <1..12>|demo" },
+    { "echo",  App_CmdEcho,  "<text>, replies with text" },
+    { "stats", App_CmdStats, "rx / tx / active object / capture / defer / pool counters" },
+    { "cfg",   App_CmdCfg,   "[debounce <ms>|long <ms>], stored in flash" },
+};
+
+/* ===== Shell AO ===== */
+
+static void App_ShellHandler(Ao_t *me, const Event_t *evt)
+{
+    (void)me;
+    (void)evt;
+    Cmd_Process();
+}
+
+/* ===== Buttons AO ===== */
+
+/* ISR-side work: sampling the polled key panel, waking the buttons
+ * AO on a panel edge or every tick while a gesture is running */
+static RAMFUNC void App_OnTickButtons(void)
+{
+    ButtonBank_OnTick(&panel_keys);
+
+    if (app_btn_busy || (panel_keys.press_edges | panel_keys.release_edges) != 0U)
+        (void)Ao_NotifyFromIsr(&ao_buttons, APP_EVT_BTN_POLL);
+}
+
+static void App_PublishButton(uint32_t btn, ButtonCtx_t *ctx)
+{
+    ButtonEvent_t evt;
+
+    while ((evt = Button_GetEvent(ctx)) != BTN_EVENT_NONE)
+        (void)Ao_Publish(APP_EVT_BUTTON, (uint16_t)((btn << 8) | evt));
+}
+
+static void App_PublishPanel(ButtonEvent_t evt)
+{
+    uint32_t keys = ButtonBank_TakeEvents(&panel_keys, evt);
+
+    /* клавиши панели: бит i маски = клавиша i */
+    if (keys != 0U)
+        TRACE("panel %u keys 0x%08lx\n", evt, keys);
+    for (; keys != 0U; keys &= keys - 1U)
+        (void)Ao_Publish(APP_EVT_PANEL,
+                         (uint16_t)(((uint32_t)__builtin_ctz(keys) << 8) | evt));
+}
+
+static void App_ButtonsHandler(Ao_t *me, const Event_t *evt)
+{
+    (void)me;
+
+    if (evt->type == APP_EVT_EXTI && evt->arg == USER_BUTTON_Pin)
+        Button_OnExti(&btn_user);
+
+    Button_Process(&btn_user);
+    BtnCap_Process();
+    ButtonBank_Process(&panel_keys);
+
+    App_PublishButton(APP_BTN_USER, &btn_user);
+    App_PublishButton(APP_BTN_CAP, &btn_cap);
+    App_PublishPanel(BTN_EVENT_SHORT);
+    App_PublishPanel(BTN_EVENT_LONG);
+
+    /* nothing timed left: sleep until the next EXTI / panel edge */
+    app_btn_busy = (Button_NextDeadline(&btn_user) != BTN_NO_DEADLINE) ||
+                   (BtnCap_NextDeadlineMs() != BTN_CAP_NO_DEADLINE) ||
+                   (ButtonBank_Pressed(&panel_keys) != 0U);
+}
+
+void App_Init(void)
+{
+    Pool_Init();
+    Timebase_Init();
+
+    Defer_Init();
+    Pt_Init();
+    Ao_Init();
+    app_btn_busy = 0;
+    if (!Ao_Start(&ao_buttons, "buttons", APP_PRIO_BUTTONS, App_ButtonsHandler,
+                  ao_buttons_buf, APP_EVQ_SIZE) ||
+        !Ao_Start(&ao_led, "led", APP_PRIO_LED, App_LedHandler,
+                  ao_led_buf, APP_LED_EVQ_SIZE) ||
+        !Ao_Start(&ao_shell, "shell", APP_PRIO_SHELL, App_ShellHandler,
+                  ao_shell_buf, APP_SHELL_EVQ_SIZE))
+        Error_Handler();
+    Ao_Subscribe(&ao_led, APP_EVT_BUTTON);
+    /* first pass arms the capture button and settles app_btn_busy */
+    (void)Ao_Notify(&ao_buttons, APP_EVT_BTN_POLL);
+
+    /* compiled-in thresholds until App_InitLate loads the stored ones */
+    SwTimer_Init();
+    Button_Init(&btn_user, UserButton_Read);
+    Button_SetProfile(&btn_user, &app_btn_profile);
+    BtnCap_Init(&btn_cap);
+    Button_SetProfile(&btn_cap, &app_btn_profile);
+    LedSeq_Init(app_leds, sizeof(app_leds) / sizeof(app_leds[0]));
+
+    Tick_Init();
+    Tick_Register(App_OnTickButtons);
+    Tick_Register(SwTimer_OnTick);
+    Tick_Register(LedSeq_OnTick);
+    Tick_Register(BtnCap_OnTick);
+}
+
+void App_InitLate(void)
+{
+    uint32_t debounce_ms, long_ms, primask;
+
+    /* flash scan, an erase after a torn write */
+    Kv_Init();
+
+    app_led_mode = (LedMode_t)Kv_GetU32(KV_KEY_LED_MODE, LED_MODE_OFF);
+    if (app_led_mode >= LED_MODE_PATTERN)
+        app_led_mode = LED_MODE_OFF;
+    debounce_ms = Kv_GetU32(KV_KEY_DEBOUNCE_MS, BTN_DEBOUNCE_MS);
+    long_ms     = Kv_GetU32(KV_KEY_LONG_PRESS_MS, BTN_LONG_PRESS_MS);
+
+    /* the tick may already sample the panel and the capture button */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    app_btn_profile.debounce_ms = debounce_ms;
+    app_btn_profile.long_ms     = long_ms;
+
+    /* PANEL_KEYS_Pins = 0: no panel fitted, the bank stays empty */
+    ButtonBank_Init(&panel_keys, debounce_ms, long_ms);
+    ButtonBank_AddLane(&panel_keys, 0, &PANEL_KEYS_GPIO_Port->IDR,
+                       PANEL_KEYS_Pins, PANEL_KEYS_Pins);
+    __set_PRIMASK(primask);
+
+    Led_Init();
+    Led_SetLevel((uint8_t)Kv_GetU32(KV_KEY_LED_LEVEL, LED_DIM_DEFAULT_PCT));
+    Led_SetMode(app_led_mode);
+    Cmd_Init(app_cmds, sizeof(app_cmds) / sizeof(app_cmds[0]));
+}
+
+/* time events first (their callbacks may post), then every AO, then
+ * the tasks: their posts run next pass, a full queue has drained */
+void App_Process(void)
+{
+    SwTimer_Process();
+    Ao_Run();
+    Pt_Run();
+}
+
+static uint32_t App_MinDeadline(uint32_t a, uint32_t b)
+{
+    return (a < b) ? a : b;
+}
+
+uint32_t App_NextDeadlineMs(void)
+{
+    uint32_t next;
+
+    if (Ao_Ready() || Cmd_Pending())
+        return 0;
+
+    next = Button_NextDeadline(&btn_user);
+
+    next = App_MinDeadline(next, BtnCap_NextDeadlineMs());
+    next = App_MinDeadline(next, ButtonBank_NextDeadline(&panel_keys));
+    next = App_MinDeadline(next, SwTimer_NextDeadlineMs());
+    next = App_MinDeadline(next, LedSeq_NextDeadlineMs());
+    next = App_MinDeadline(next, Pt_NextDeadlineMs());
+    return next;
+}
+
+const EvQueue_t *App_EventQueue(void)
+{
+    return &ao_buttons.queue;
+}
+
+/* ===== HAL callbacks (ISR context) ===== */
+
+/* HAL dispatch path only (TICK_FAST_PATH=0), see tick.h */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    if (htim->Instance == TIM2)
+    {
+    	//HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin); // DEBUG
+    	Tick_Dispatch();
+    }
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART2)
+        Log_OnTxComplete();
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    if (huart->Instance == USART2) {
+        Cmd_OnRxEvent(Size);
+        (void)Ao_NotifyFromIsr(&ao_shell, APP_EVT_CMD_RX);
+    }
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART2) {
+        Cmd_OnUartError();
+        (void)Ao_NotifyFromIsr(&ao_shell, APP_EVT_CMD_RX);
+    }
+}
+
+RAMFUNC void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    /* capture backend: converts its captures here, the AO only polls */
+    if (GPIO_Pin == CAP_BUTTON_Pin) {
+        BtnCap_OnExti();
+        (void)Ao_NotifyFromIsr(&ao_buttons, APP_EVT_BTN_POLL);
+        return;
+    }
+    (void)Ao_PostFromIsr(&ao_buttons, APP_EVT_EXTI, GPIO_Pin);
+}
@@ -0,0 +1,166 @@
+/*
+ * Boot module
+ *
+ * Reset-to-ready profile and the fast-start clock path, see boot.h.
+ *
+ * Responsibilities:
+ *  - start HSE + PLL from Reset_Handler, switch SYSCLK once locked
+ *  - phase stamps from the startup code and from main()
+ *  - init deferred until the first superloop pass
+ *  - one report line per phase on USART2
+ *
+ * Design principles:
+ *  - Boot_ClockStart runs before .data / .bss are initialised: it
+ *    touches RCC registers and locals only, never a static
+ *  - every wait on the oscillators is bounded: without the HSE the
+ *    fast path backs out and SystemClock_Config fails the same way
+ *    it does without fast start
+ *  - the report goes out one line per Boot_Poll call and retries a
+ *    line the log ring had no room for, so nothing is lost to the
+ *    first burst of traffic
+ *
+ * Platform: STM32 (Cortex-M3) + HAL
+ */
+
+#include "boot.h"
+#include "main.h"
+#include "uart_log.h"
+
+/* bounded oscillator waits, loop passes on HSI (PLL lock < 200 us) */
+#define BOOT_HSE_WAIT       2000U
+#define BOOT_PLL_WAIT       20000U
+
+static const char *const boot_phase_name[BOOT_PHASES] = {
+    "sysinit", ".data", ".bss", "pll", "libc",
+    "hal", "clock", "mx", "app", "ready"
+};
+
+static uint32_t boot_stamp[BOOT_PHASES];    /* CYCCNT at the phase end */
+static uint32_t boot_hz[BOOT_PHASES];       /* core clock at the phase end */
+static BootDeferFn boot_defer[BOOT_DEFER_MAX];
+static uint8_t  boot_defer_count;
+static uint8_t  boot_ready;
+static uint8_t  boot_report;                /* next report line, BOOT_PHASES + 1 = done */
+
+void Boot_ClockStart(void)
+{
+#if BOOT_FAST_START
+    uint32_t n = BOOT_HSE_WAIT;
+
+    /* 8 MHz from the ST-LINK MCO; ready a few HSE cycles after ON */
+    RCC->CR |= BOOT_HSE_STATE & RCC_CR_HSEBYP;
+    RCC->CR |= RCC_CR_HSEON;
+    while ((RCC->CR & RCC_CR_HSERDY) == 0U)
+        if (--n == 0U)
+            return;
+
+    /* HSE / 2 x 16 = 64 MHz; the PLL locks while the RAM init runs */
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_PLLSRC | RCC_CFGR_PLLXTPRE | RCC_CFGR_PLLMULL,
+               BOOT_PLL_SOURCE | BOOT_PLL_PREDIV | BOOT_PLL_MUL);
+    RCC->CR |= RCC_CR_PLLON;
+#endif
+}
+
+void Boot_ClockSwitch(void)
+{
+#if BOOT_FAST_START
+    uint32_t n = BOOT_PLL_WAIT;
+
+    if ((RCC->CR & RCC_CR_PLLON) == 0U)
+        return;
+    while ((RCC->CR & RCC_CR_PLLRDY) == 0U)
+        if (--n == 0U)
+            return;
+
+    /* wait states before the clock goes up */
+    MODIFY_REG(FLASH->ACR, FLASH_ACR_LATENCY, FLASH_LATENCY_2);
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2,
+               RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV2 | RCC_CFGR_PPRE2_DIV1);
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_SW, RCC_CFGR_SW_PLL);
+    while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL)
+        ;
+    SystemCoreClockUpdate();
+#endif
+}
+
+void Boot_ResetStamps(uint32_t sysinit, uint32_t data, uint32_t bss, uint32_t pll)
+{
+#if BOOT_PROF_ENABLE
+    boot_stamp[BOOT_SYSINIT] = sysinit;
+    boot_stamp[BOOT_DATA]    = data;
+    boot_stamp[BOOT_BSS]     = bss;
+    boot_stamp[BOOT_PLL]     = pll;
+    boot_hz[BOOT_SYSINIT] = HSI_VALUE;
+    boot_hz[BOOT_DATA]    = HSI_VALUE;
+    boot_hz[BOOT_BSS]     = HSI_VALUE;
+    boot_hz[BOOT_PLL]     = SystemCoreClock;
+#else
+    (void)sysinit; (void)data; (void)bss; (void)pll;
+#endif
+}
+
+void Boot_Mark(BootPhase_t phase)
+{
+#if BOOT_PROF_ENABLE
+    boot_stamp[phase] = DWT->CYCCNT;
+    boot_hz[phase]    = SystemCoreClock;
+#else
+    (void)phase;
+#endif
+}
+
+void Boot_Defer(BootDeferFn fn)
+{
+    if (boot_ready) {
+        fn();
+        return;
+    }
+    if (boot_defer_count < BOOT_DEFER_MAX)
+        boot_defer[boot_defer_count++] = fn;
+    else
+        fn();                   /* list full: run now, never drop */
+}
+
+/* phase length in us, at the clock the phase started with */
+static uint32_t Boot_PhaseUs(uint32_t phase)
+{
+    uint32_t start = (phase == 0U) ? 0U : boot_stamp[phase - 1U];
+    uint32_t hz    = (phase == 0U) ? HSI_VALUE : boot_hz[phase - 1U];
+
+    return (boot_stamp[phase] - start) / (hz / 1000000U);
+}
+
+void Boot_Poll(void)
+{
+    if (!boot_ready) {
+        Boot_Mark(BOOT_READY);
+        boot_ready = 1;
+        for (uint32_t i = 0; i < boot_defer_count; i++)
+            boot_defer[i]();
+        boot_defer_count = 0;
+    }
+
+#if BOOT_PROF_ENABLE
+    if (boot_report > BOOT_PHASES)
+        return;
+
+    if (boot_report == 0U) {
+        uint32_t total = 0;
+
+        for (uint32_t i = 0; i < BOOT_PHASES; i++)
+            total += Boot_PhaseUs(i);
+        if (Log_Printf("boot: reset -> ready %lu us, fast start %s\r\n",
+                       (unsigned long)total, BOOT_FAST_START ? "on" : "off") < 0)
+            return;
+    } else {
+        uint32_t i = boot_report - 1U;
+
+        if (Log_Printf("boot: %-8s %6lu us %8lu cyc @ %lu MHz\r\n", boot_phase_name[i],
+                       (unsigned long)Boot_PhaseUs(i),
+                       (unsigned long)(boot_stamp[i] - ((i == 0U) ? 0U : boot_stamp[i - 1U])),
+                       (unsigned long)(((i == 0U) ? HSI_VALUE : boot_hz[i - 1U]) / 1000000U)) < 0)
+            return;
+    }
+    boot_report++;
+#endif
+}
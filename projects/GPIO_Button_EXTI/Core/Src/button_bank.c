@@ -0,0 +1,159 @@
+/*
+ * Button bank module
+ *
+ * Bit-parallel debounce and press timing for up to 32 buttons,
+ * see button_bank.h for the layout.
+ *
+ * Responsibilities:
+ *  - sample every configured pin with one IDR read per GPIO port
+ *  - debounce all pins at once with a 2-bit vertical counter
+ *  - detect short / long presses per button
+ *
+ * Design principles:
+ *  - ISR cost is independent of the number of buttons
+ *  - main-loop cost is proportional to buttons that changed or
+ *    are held, never to the number of configured buttons
+ *  - edges are handed over as bit masks, cleared atomically
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include <string.h>
+
+#include "button_bank.h"
+#include "main.h"
+#include "ramfunc.h"
+#include "tick.h"
+#include "timebase.h"
+
+/* index of the lowest set bit, mask must be non-zero */
+static inline uint32_t Bank_Ctz(uint32_t mask)
+{
+    return (uint32_t)__builtin_ctz(mask);
+}
+
+static uint32_t Bank_Sample(const ButtonBank_t *bank)
+{
+    uint32_t raw = 0;
+
+    for (uint32_t lane = 0; lane < BANK_LANES; lane++) {
+        if (bank->idr[lane] != NULL)
+            raw |= (*bank->idr[lane] & 0xFFFFU) << (lane * BANK_LANE_PINS);
+    }
+
+    /* 1 = pressed, unused pins forced to released */
+    return (raw ^ bank->active_low_mask) & bank->used_mask;
+}
+
+void ButtonBank_Init(ButtonBank_t *bank, uint32_t debounce_ms, uint32_t long_press_ms)
+{
+    const uint32_t per_sample = 4U * TICK_PERIOD_MS;
+    uint32_t ticks = (debounce_ms + per_sample - 1U) / per_sample;
+
+    memset(bank, 0, sizeof(*bank));
+    bank->long_press_ms = long_press_ms;
+    bank->sample_ticks  = (uint8_t)((ticks == 0U) ? 1U : ticks);
+    bank->cnt0 = UINT32_MAX;
+    bank->cnt1 = UINT32_MAX;
+}
+
+uint8_t ButtonBank_AddLane(ButtonBank_t *bank, uint8_t lane,
+                           volatile const uint32_t *idr,
+                           uint16_t pins, uint16_t active_low_pins)
+{
+    const uint32_t shift = (uint32_t)lane * BANK_LANE_PINS;
+
+    if (lane >= BANK_LANES || idr == NULL)
+        return 0;
+
+    bank->idr[lane] = idr;
+    bank->used_mask       |= (uint32_t)pins << shift;
+    bank->active_low_mask |= (uint32_t)(active_low_pins & pins) << shift;
+    return 1;
+}
+
+RAMFUNC void ButtonBank_OnTick(ButtonBank_t *bank)
+{
+    uint32_t changed;
+
+    if (++bank->sample_cnt < bank->sample_ticks)
+        return;
+    bank->sample_cnt = 0;
+
+    /* vertical counter: a bit toggles after 4 consecutive differing samples */
+    changed    = bank->state ^ Bank_Sample(bank);
+    bank->cnt0 = ~(bank->cnt0 & changed);
+    bank->cnt1 = bank->cnt0 ^ (bank->cnt1 & changed);
+    changed   &= bank->cnt0 & bank->cnt1;
+
+    bank->state         ^= changed;
+    bank->press_edges   |= changed & bank->state;
+    bank->release_edges |= changed & ~bank->state;
+}
+
+void ButtonBank_Process(ButtonBank_t *bank)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t pressed, released, held, now;
+
+    __disable_irq();
+    pressed  = bank->press_edges;
+    released = bank->release_edges;
+    bank->press_edges   = 0;
+    bank->release_edges = 0;
+    __set_PRIMASK(primask);
+
+    now = Timebase_NowMs();
+
+    for (uint32_t m = pressed; m != 0U; m &= m - 1U)
+        bank->press_start_ms[Bank_Ctz(m)] = now;
+
+    /* release before long press: short event, else end of long press */
+    bank->short_events |= released & ~bank->long_fired;
+    bank->long_fired   &= ~released;
+
+    held = bank->state & ~bank->long_fired;
+    for (uint32_t m = held; m != 0U; m &= m - 1U) {
+        uint32_t i = Bank_Ctz(m);
+
+        if ((now - bank->press_start_ms[i]) >= bank->long_press_ms) {
+            bank->long_events |= 1UL << i;
+            bank->long_fired  |= 1UL << i;
+        }
+    }
+}
+
+uint32_t ButtonBank_TakeEvents(ButtonBank_t *bank, ButtonEvent_t evt)
+{
+    uint32_t mask = 0;
+
+    if (evt == BTN_EVENT_SHORT) {
+        mask = bank->short_events;
+        bank->short_events = 0;
+    } else if (evt == BTN_EVENT_LONG) {
+        mask = bank->long_events;
+        bank->long_events = 0;
+    }
+    return mask;
+}
+
+uint32_t ButtonBank_Pressed(const ButtonBank_t *bank)
+{
+    return bank->state;
+}
+
+/*
+ * Polled inputs: while any lane is configured the bank needs the
+ * tick to sample, so it never allows the tick to be gated off.
+ */
+uint32_t ButtonBank_NextDeadline(const ButtonBank_t *bank)
+{
+    if (bank->short_events | bank->long_events |
+        bank->press_edges  | bank->release_edges)
+        return 0;
+
+    if (bank->used_mask == 0U)
+        return BTN_NO_DEADLINE;
+
+    return (uint32_t)bank->sample_ticks * TICK_PERIOD_MS;
+}
@@ -0,0 +1,325 @@
+/*
+ * Button capture backend module
+ *
+ * TIM4 input capture + DMA edge stream for CAP_BUTTON, see
+ * button_cap.h.
+ *
+ * Responsibilities:
+ *  - start both capture channels with their DMA and keep them
+ *    running, the DMA interrupts stay masked
+ *  - merge rising / falling captures into one ordered edge stream
+ *    with absolute microsecond timestamps
+ *  - replay the stream through the button FSM at the recorded
+ *    times, timer transitions included
+ *  - sleep on the EXTI line while nothing is in progress
+ *
+ * Design principles:
+ *  - ISR side (tick, EXTI) only schedules the conversion as
+ *    deferred work (defer.h): a 16-bit stamp is only meaningful
+ *    while the counter has not wrapped, so it is anchored to the
+ *    Timebase clock at most one tick later, right after the ISR,
+ *    whatever the main loop is doing
+ *  - the conversion runs in one context only (PendSV), the main
+ *    loop drains itself with IRQs masked, which PendSV cannot
+ *    interleave with
+ *  - the main loop owns the FSM; the edge ring between both sides
+ *    is single producer / single consumer
+ *  - the FSM itself is unchanged: Button_OnEdgeAt / ProcessAt get
+ *    the edge time instead of "now" and the level of the stream
+ *    instead of the pin
+ *  - filtered edges alternate, captures are still merged by age,
+ *    which also keeps the order across a lost capture
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "button_cap.h"
+#include "defer.h"
+#include "main.h"
+#include "ramfunc.h"
+#include "tim.h"
+#include "timebase.h"
+
+typedef struct {
+    uint64_t t_us;
+    uint8_t  pressed;
+} BtnCapEdge_t;
+
+/* DMA targets: TIM4 CCR1 (rising = release), CCR2 (falling = press) */
+static uint16_t cap_rise[BTN_CAP_DMA_LEN];
+static uint16_t cap_fall[BTN_CAP_DMA_LEN];
+static uint16_t cap_rise_rd, cap_fall_rd;
+
+/* ISR -> main loop */
+static BtnCapEdge_t cap_edges[BTN_CAP_EDGES];
+static volatile uint32_t cap_head, cap_tail;
+
+static ButtonCtx_t *cap_btn;
+static void BtnCap_Work(void *arg);
+static DeferWork_t cap_work = DEFER_WORK_INIT(BtnCap_Work, NULL);
+static volatile uint8_t cap_sync;   /* EXTI wake: check the pin level as well */
+
+static uint8_t  cap_isr_pressed;    /* level after the newest converted edge */
+static uint8_t  cap_pressed;        /* level seen by the FSM */
+static volatile uint8_t cap_armed;  /* 1 = EXTI wake-up enabled, nothing in progress */
+static uint64_t cap_press_us;
+static BtnCapStats_t cap_stats;
+
+static uint8_t BtnCap_Read(void)
+{
+    return cap_pressed;
+}
+
+/* кнопка активна по LOW */
+static uint8_t BtnCap_PinPressed(void)
+{
+    return (HAL_GPIO_ReadPin(CAP_BUTTON_GPIO_Port, CAP_BUTTON_Pin) == GPIO_PIN_RESET);
+}
+
+/* DMA write index of a circular capture buffer */
+static uint16_t BtnCap_WriteIndex(uint32_t dma_id)
+{
+    uint32_t left = __HAL_DMA_GET_COUNTER(htim4.hdma[dma_id]);
+
+    return (uint16_t)((BTN_CAP_DMA_LEN - left) % BTN_CAP_DMA_LEN);
+}
+
+static void BtnCap_Push(uint64_t t_us, uint8_t pressed)
+{
+    /* same level twice: a capture was lost or already resynced */
+    if (pressed == cap_isr_pressed)
+        return;
+
+    if (cap_head - cap_tail >= BTN_CAP_EDGES) {
+        cap_stats.overflows++;
+        return;
+    }
+
+    cap_edges[cap_head % BTN_CAP_EDGES].t_us = t_us;
+    cap_edges[cap_head % BTN_CAP_EDGES].pressed = pressed;
+    cap_head++;
+    cap_isr_pressed = pressed;
+}
+
+/*
+ * New captures -> edge ring. Deferred work or interrupts masked.
+ * The DMA positions are read before the counter, so every stamp
+ * taken here is older than `cnt` and its age fits in 16 bits;
+ * `cnt` and `now` are read back to back, no ISR in between.
+ */
+static void BtnCap_Drain(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint16_t rise_wr, fall_wr, cnt;
+    uint64_t now;
+
+    __disable_irq();
+    rise_wr = BtnCap_WriteIndex(TIM_DMA_ID_CC1);
+    fall_wr = BtnCap_WriteIndex(TIM_DMA_ID_CC2);
+    cnt = (uint16_t)__HAL_TIM_GET_COUNTER(&htim4);
+    now = Timebase_NowUs();
+    __set_PRIMASK(primask);
+
+    while (cap_rise_rd != rise_wr || cap_fall_rd != fall_wr) {
+        uint16_t age_r = (uint16_t)(cnt - cap_rise[cap_rise_rd]);
+        uint16_t age_f = (uint16_t)(cnt - cap_fall[cap_fall_rd]);
+        uint8_t  fall;
+
+        if (cap_rise_rd == rise_wr)
+            fall = 1;
+        else if (cap_fall_rd == fall_wr)
+            fall = 0;
+        else if (age_r != age_f)
+            fall = (age_f > age_r);
+        else
+            fall = !cap_isr_pressed;
+
+        if (fall) {
+            BtnCap_Push(now - (uint64_t)age_f * (1000000U / BTN_CAP_TIMER_HZ), 1);
+            cap_fall_rd = (uint16_t)((cap_fall_rd + 1U) % BTN_CAP_DMA_LEN);
+        } else {
+            BtnCap_Push(now - (uint64_t)age_r * (1000000U / BTN_CAP_TIMER_HZ), 0);
+            cap_rise_rd = (uint16_t)((cap_rise_rd + 1U) % BTN_CAP_DMA_LEN);
+        }
+    }
+}
+
+/* pin level the stream does not know about: the timer was stopped
+   (STOP mode) when the edge came, stamp it with the current time */
+static void BtnCap_Sync(void)
+{
+    uint8_t pin = BtnCap_PinPressed();
+
+    if (pin != cap_isr_pressed) {
+        cap_stats.resyncs++;
+        BtnCap_Push(Timebase_NowUs(), pin);
+    }
+}
+
+static void BtnCap_ExtiMask(uint8_t masked)
+{
+    if (masked) {
+        EXTI->IMR &= ~(uint32_t)CAP_BUTTON_Pin;
+    } else {
+        __HAL_GPIO_EXTI_CLEAR_IT(CAP_BUTTON_Pin);
+        EXTI->IMR |= CAP_BUTTON_Pin;
+    }
+}
+
+/* fire every FSM timer due up to t_ms, each at its own time */
+static void BtnCap_RunTo(uint32_t t_ms)
+{
+    uint32_t due;
+
+    while (Button_DueAt(cap_btn, cap_pressed, &due) && (int32_t)(due - t_ms) <= 0)
+        Button_ProcessAt(cap_btn, due, cap_pressed);
+}
+
+static void BtnCap_Apply(const BtnCapEdge_t *e)
+{
+    uint32_t t = (uint32_t)(e->t_us / 1000U);
+    ButtonState_t st;
+
+    BtnCap_RunTo(t);
+
+    st = cap_btn->state;
+    if (e->pressed && (st == BTN_STATE_IDLE || st == BTN_STATE_CLICK_WAIT))
+        cap_press_us = e->t_us;
+    if (!e->pressed && (st == BTN_STATE_PRESSED || st == BTN_STATE_LONG))
+        cap_stats.last_press_us = (uint32_t)(e->t_us - cap_press_us);
+
+    cap_pressed = e->pressed;
+    Button_OnEdgeAt(cap_btn, t);
+    Button_ProcessAt(cap_btn, t, cap_pressed);
+    cap_stats.edges++;
+}
+
+/* PendSV: captures of the last tick / EXTI wake-up */
+static void BtnCap_Work(void *arg)
+{
+    (void)arg;
+
+    BtnCap_Drain();
+    if (cap_sync) {
+        cap_sync = 0;
+        BtnCap_Sync();
+    }
+}
+
+/* nothing in progress: wake up on the next edge through EXTI */
+static void BtnCap_Arm(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    BtnCap_ExtiMask(0);
+    cap_armed = 1;
+
+    /* edges that came before the line was unmasked */
+    BtnCap_Drain();
+    BtnCap_Sync();
+    if (cap_head != cap_tail) {
+        BtnCap_ExtiMask(1);
+        cap_armed = 0;
+    }
+    __set_PRIMASK(primask);
+}
+
+/* public API */
+
+void BtnCap_Init(ButtonCtx_t *btn)
+{
+    cap_btn = btn;
+    Button_Init(btn, BtnCap_Read);
+
+    cap_rise_rd = 0;
+    cap_fall_rd = 0;
+    cap_head = 0;
+    cap_tail = 0;
+    cap_armed = 0;
+    cap_sync = 0;
+    cap_press_us = 0;
+    cap_stats = (BtnCapStats_t){0};
+    cap_pressed = BtnCap_PinPressed();
+    cap_isr_pressed = cap_pressed;
+
+    /* armed by the first BtnCap_Process */
+    BtnCap_ExtiMask(1);
+
+    if (HAL_TIM_IC_Start_DMA(&htim4, TIM_CHANNEL_1, (uint32_t *)cap_rise, BTN_CAP_DMA_LEN) != HAL_OK ||
+        HAL_TIM_IC_Start_DMA(&htim4, TIM_CHANNEL_2, (uint32_t *)cap_fall, BTN_CAP_DMA_LEN) != HAL_OK)
+        Error_Handler();
+
+    /* circular and read by position: no half / complete interrupts */
+    __HAL_DMA_DISABLE_IT(htim4.hdma[TIM_DMA_ID_CC1], DMA_IT_HT | DMA_IT_TC);
+    __HAL_DMA_DISABLE_IT(htim4.hdma[TIM_DMA_ID_CC2], DMA_IT_HT | DMA_IT_TC);
+}
+
+RAMFUNC void BtnCap_OnTick(void)
+{
+    if (!cap_armed)
+        (void)Defer_Schedule(&cap_work);
+}
+
+void BtnCap_OnExti(void)
+{
+    if (cap_armed) {
+        BtnCap_ExtiMask(1);
+        cap_armed = 0;
+        cap_stats.wakes++;
+    }
+    cap_sync = 1;
+    (void)Defer_Schedule(&cap_work);
+}
+
+void BtnCap_Process(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t now = Timebase_NowMs();
+    uint32_t due;
+
+    /* captures up to `now` first, the timers below must not overtake them */
+    __disable_irq();
+    if (!cap_armed)
+        BtnCap_Drain();
+    __set_PRIMASK(primask);
+
+    while (cap_tail != cap_head) {
+        BtnCap_Apply(&cap_edges[cap_tail % BTN_CAP_EDGES]);
+        cap_tail++;
+    }
+    BtnCap_RunTo(now);
+
+    if (!cap_armed && !Button_DueAt(cap_btn, cap_pressed, &due))
+        BtnCap_Arm();
+}
+
+/*
+ * While an edge sequence is in progress the tick has to keep
+ * running (it converts the captures), so any finite deadline is
+ * returned; armed = no deadline at all, EXTI wakes the core.
+ */
+uint32_t BtnCap_NextDeadlineMs(void)
+{
+    uint32_t due;
+    int32_t left;
+
+    if (cap_tail != cap_head || EvQ_Count(&cap_btn->events) != 0U)
+        return 0;
+    if (cap_armed)
+        return BTN_CAP_NO_DEADLINE;
+    if (!Button_DueAt(cap_btn, cap_pressed, &due))
+        return 0;                   /* quiet: BtnCap_Process arms */
+
+    left = (int32_t)(due - Timebase_NowMs());
+    return (left <= 0) ? 0U : (uint32_t)left;
+}
+
+void BtnCap_GetStats(BtnCapStats_t *out)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *out = cap_stats;
+    __set_PRIMASK(primask);
+}
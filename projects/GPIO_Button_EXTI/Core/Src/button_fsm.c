@@ -8,91 +8,210 @@
  *  - debounce handling
  *  - short press detection
  *  - long press detection
+ *  - click counting and hold auto-repeat (gesture layer)
  *
  * Design principles:
  *  - no blocking delays
  *  - no application logic in ISR
  *  - main-loop-driven state machine
+ *  - every threshold comes from the button's profile, one FSM
+ *    serves buttons with different timing
  *
  * Platform: STM32 + HAL
  */
 
 
 
+#include <stddef.h>
+
 #include "button_fsm.h"
+#include "timebase.h"
+
+const ButtonProfile_t btn_profile_default =
+    BTN_PROFILE_INIT(BTN_DEBOUNCE_MS, BTN_LONG_PRESS_MS, 0U, 0U);
 
-/* internal time base, incremented from TIM ISR */
+/* click count -> gesture */
+static const ButtonEvent_t btn_click_events[] = {
+    BTN_EVENT_NONE, BTN_EVENT_SHORT, BTN_EVENT_DOUBLE, BTN_EVENT_TRIPLE
+};
 
-static volatile uint32_t btn_time_ms = 0;
+#define BTN_MAX_CLICKS  3U
+
+static void Button_Post(ButtonCtx_t *btn, ButtonEvent_t evt)
+{
+    (void)EvQ_Post(&btn->events, (uint16_t)evt, 0);
+}
+
+/* the click sequence is over: one event for all of it */
+static void Button_PostClicks(ButtonCtx_t *btn)
+{
+    if (btn->clicks != 0U)
+        Button_Post(btn, btn_click_events[btn->clicks]);
+    btn->clicks = 0;
+}
 
 /* public API */
 
 void Button_Init(ButtonCtx_t *btn, ButtonReadFn read)
 {
     btn->state = BTN_STATE_IDLE;
+    btn->profile = &btn_profile_default;
     btn->debounce_start_ms = 0;
     btn->press_start_ms = 0;
-    btn->event = BTN_EVENT_NONE;
+    btn->release_ms = 0;
+    btn->repeat_ms = 0;
+    btn->clicks = 0;
+    EvQ_Init(&btn->events, btn->event_buf, BTN_EVQ_SIZE);
     btn->read = read;
 }
 
+void Button_SetProfile(ButtonCtx_t *btn, const ButtonProfile_t *profile)
+{
+    btn->profile = (profile != NULL) ? profile : &btn_profile_default;
+}
+
 void Button_OnExti(ButtonCtx_t *btn)
+{
+    Button_OnEdgeAt(btn, Timebase_NowMs());
+}
+
+void Button_OnEdgeAt(ButtonCtx_t *btn, uint32_t t_ms)
 {
     /* EXTI only signals activity */
-    if (btn->state == BTN_STATE_IDLE) {
+    if (btn->state == BTN_STATE_IDLE || btn->state == BTN_STATE_CLICK_WAIT) {
         btn->state = BTN_STATE_DEBOUNCE;
-        btn->debounce_start_ms = btn_time_ms;
+        btn->debounce_start_ms = t_ms;
     }
 }
 
-void Button_OnTick(ButtonCtx_t *btn)
+void Button_Process(ButtonCtx_t *btn)
 {
-    (void)btn;
-    btn_time_ms++; /* global button time base (shared by all button instances) */
+    Button_ProcessAt(btn, Timebase_NowMs(), btn->read());
 }
 
-void Button_Process(ButtonCtx_t *btn)
+void Button_ProcessAt(ButtonCtx_t *btn, uint32_t now, uint8_t level)
 {
+    const ButtonProfile_t *p = btn->profile;
+
     switch (btn->state)
     {
         case BTN_STATE_IDLE:
             break;
 
         case BTN_STATE_DEBOUNCE:
-            if ((btn_time_ms - btn->debounce_start_ms) >= BTN_DEBOUNCE_MS) {
-                if (btn->read()) {
+            if ((now - btn->debounce_start_ms) >= p->debounce_ms) {
+                if (level) {
+                    /* press edge after the click window: a new gesture */
+                    if (btn->clicks != 0U &&
+                        (btn->debounce_start_ms - btn->release_ms) >= p->multi_ms)
+                        Button_PostClicks(btn);
                     btn->state = BTN_STATE_PRESSED;
-                    btn->press_start_ms = btn_time_ms;
+                    btn->press_start_ms = now;
                 } else {
-                    btn->state = BTN_STATE_IDLE;
+                    btn->state = (btn->clicks != 0U) ? BTN_STATE_CLICK_WAIT : BTN_STATE_IDLE;
                 }
             }
             break;
 
         case BTN_STATE_PRESSED:
-            if (btn->read()) {
-                if ((btn_time_ms - btn->press_start_ms) >= BTN_LONG_PRESS_MS) {
-                    btn->event = BTN_EVENT_LONG;
+            if (level) {
+                if ((now - btn->press_start_ms) >= p->long_ms) {
+                    Button_PostClicks(btn);
+                    Button_Post(btn, BTN_EVENT_LONG);
                     btn->state = BTN_STATE_LONG;
+                    btn->repeat_ms = now;
                 }
             } else {
-                btn->event = BTN_EVENT_SHORT;
-                btn->state = BTN_STATE_IDLE;
+                btn->clicks++;
+                if (p->multi_ms == 0U || btn->clicks >= BTN_MAX_CLICKS) {
+                    Button_PostClicks(btn);
+                    btn->state = BTN_STATE_IDLE;
+                } else {
+                    btn->release_ms = now;
+                    btn->state = BTN_STATE_CLICK_WAIT;
+                }
             }
             break;
 
         case BTN_STATE_LONG:
-            if (!btn->read()) {
+            if (!level) {
+                Button_Post(btn, BTN_EVENT_RELEASE);
+                btn->state = BTN_STATE_IDLE;
+            } else if (p->repeat_ms != 0U && (now - btn->repeat_ms) >= p->repeat_ms) {
+                Button_Post(btn, BTN_EVENT_HOLD_REPEAT);
+                btn->repeat_ms += p->repeat_ms;
+            }
+            break;
+
+        case BTN_STATE_CLICK_WAIT:
+            if ((now - btn->release_ms) >= p->multi_ms) {
+                Button_PostClicks(btn);
                 btn->state = BTN_STATE_IDLE;
             }
             break;
     }
 }
+
 ButtonEvent_t Button_GetEvent(ButtonCtx_t *btn)
 {
-    ButtonEvent_t evt = btn->event;
-    btn->event = BTN_EVENT_NONE;
-    return evt;
+    Event_t evt;
+
+    if (!EvQ_Get(&btn->events, &evt))
+        return BTN_EVENT_NONE;
+    return (ButtonEvent_t)evt.type;
 }
 
+/*
+ * Absolute time of the next timed transition for a given input
+ * level. A level that already disagrees with the state (released
+ * while PRESSED / LONG) is due at once: the returned time is in
+ * the past. Returns 0 when only an edge can change the state.
+ */
+uint8_t Button_DueAt(const ButtonCtx_t *btn, uint8_t level, uint32_t *t_ms)
+{
+    const ButtonProfile_t *p = btn->profile;
 
+    switch (btn->state)
+    {
+        case BTN_STATE_DEBOUNCE:
+            *t_ms = btn->debounce_start_ms + p->debounce_ms;
+            return 1;
+
+        case BTN_STATE_PRESSED:
+            *t_ms = level ? btn->press_start_ms + p->long_ms : btn->press_start_ms;
+            return 1;
+
+        case BTN_STATE_LONG:
+            if (level && p->repeat_ms == 0U)
+                return 0;
+            *t_ms = level ? btn->repeat_ms + p->repeat_ms : btn->repeat_ms;
+            return 1;
+
+        case BTN_STATE_CLICK_WAIT:
+            *t_ms = btn->release_ms + p->multi_ms;
+            return 1;
+
+        case BTN_STATE_IDLE:
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Idle hint for the idle scheduler (idle.h). Press and release both
+ * raise EXTI, so only debounce, long-press, click-window and
+ * repeat timing need ticks.
+ */
+uint32_t Button_NextDeadline(const ButtonCtx_t *btn)
+{
+    uint32_t due;
+    int32_t left;
+
+    if (EvQ_Count(&btn->events) != 0U)
+        return 0;
+    if (!Button_DueAt(btn, btn->read(), &due))
+        return BTN_NO_DEADLINE;
+
+    left = (int32_t)(due - Timebase_NowMs());
+    return (left <= 0) ? 0U : (uint32_t)left;
+}
@@ -0,0 +1,347 @@
+/*
+ * Clock manager module
+ *
+ * Load-driven switching between HSI 8 MHz and PLL 64 MHz, see
+ * clk_mgr.h for the levels, the policy and the costs.
+ *
+ * Responsibilities:
+ *  - measure the load per window from the idle statistics
+ *  - lock / stop the PLL through HAL_RCC_OscConfig, switch SYSCLK
+ *    by register
+ *  - retime SysTick, Timebase, TIM2 / TIM3 / TIM4 and USART2
+ *  - notify the registered listeners around each switch
+ *
+ * Design principles:
+ *  - the PLL lock wait runs with the interrupts live; only the
+ *    SYSCLK switch and the retiming are masked, so no interrupt
+ *    ever sees the new clock with the old dividers
+ *  - nothing under the mask waits on HAL_GetTick (it cannot
+ *    advance there): the switch polls SWS a bounded number of
+ *    times and backs out, HAL is only called with interrupts on
+ *  - prescalers are always scaled from the values captured at
+ *    64 MHz, never from the previous level: rounding cannot add up
+ *  - a switch that cannot happen now (USART2 busy) is retried on
+ *    the next poll, the policy never waits
+ *  - a level the USART2 baud rate cannot be set at is refused
+ *    before anything is touched, not found out in the retiming
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "clk_mgr.h"
+#include "main.h"
+#include "boot.h"
+#include "idle.h"
+#include "tim.h"
+#include "timebase.h"
+#include "uart_log.h"
+#include "usart.h"
+
+/* CubeMX clock setup in main.c, the HIGH level as generated */
+void SystemClock_Config(void);
+
+/* bounded SWS wait, loop passes (the switch takes a few cycles of
+   the old and the new clock) */
+#define CLK_MGR_SWITCH_WAIT     1000U
+
+/* PCLK1 at LOW: HSI, APB1 undivided */
+#define CLK_MGR_LOW_PCLK1_HZ    HSI_VALUE
+
+typedef struct {
+    TIM_HandleTypeDef *htim;
+    uint32_t psc_high;          /* prescaler at 64 MHz (MX_TIMx_Init) */
+} ClkMgrTim_t;
+
+static ClkMgrTim_t clk_tims[] = {
+    { &htim2, 0 },
+    { &htim3, 0 },
+    { &htim4, 0 },
+};
+
+static ClkMgrNotifyFn clk_listeners[CLK_MGR_MAX_LISTENERS];
+static uint32_t   clk_listener_count;
+static ClkLevel_t clk_level;
+static uint32_t   clk_tclk_high;        /* timer kernel clock at HIGH */
+static ClkMgrStats_t clk_stats;
+static uint32_t   clk_level_since_ms;
+static uint32_t   clk_window_start_ms;
+static uint64_t   clk_window_total, clk_window_sleep;   /* idle stats at window start */
+static uint32_t   clk_low_windows;
+static uint32_t   clk_last_report_ms;
+
+/* APB1 timers run at 2 x PCLK1 unless APB1 is undivided */
+static uint32_t ClkMgr_TimClock(void)
+{
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+
+    return ((RCC->CFGR & RCC_CFGR_PPRE1) == RCC_CFGR_PPRE1_DIV1) ? pclk1 : 2U * pclk1;
+}
+
+/* 16x oversampling: USARTDIV >= 1, i.e. BRR >= 16 */
+static uint8_t ClkMgr_BaudFits(uint32_t pclk1_hz)
+{
+    return huart2.Init.BaudRate <= pclk1_hz / 16U;
+}
+
+static void ClkMgr_Retime(void)
+{
+    uint32_t tclk = ClkMgr_TimClock();
+
+    for (uint32_t i = 0; i < sizeof(clk_tims) / sizeof(clk_tims[0]); i++) {
+        TIM_TypeDef *tim = clk_tims[i].htim->Instance;
+        uint32_t urs = tim->CR1 & TIM_CR1_URS;
+        uint32_t div = (uint32_t)((((uint64_t)clk_tims[i].psc_high + 1U) * tclk +
+                                   clk_tclk_high / 2U) / clk_tclk_high);
+
+        if (div == 0U)
+            div = 1U;
+        clk_tims[i].htim->Init.Prescaler = div - 1U;
+        tim->PSC = div - 1U;
+
+        /* load PSC now: URS keeps the forced update from raising
+           UIF or a DMA request, only the counter restarts */
+        tim->CR1 |= TIM_CR1_URS;
+        tim->EGR = TIM_EGR_UG;
+        tim->CR1 = (tim->CR1 & ~TIM_CR1_URS) | urs;
+    }
+
+    huart2.Instance->BRR = UART_BRR_SAMPLING16(HAL_RCC_GetPCLK1Freq(), huart2.Init.BaudRate);
+}
+
+/*
+ * SYSCLK switch by register, interrupts masked. Wait states go up
+ * before the clock and down after it, APB1 is halved before the
+ * PLL takes over: no bus ever runs out of spec in between. Then
+ * SystemCoreClock and the SysTick reload follow the new HCLK.
+ * Returns 0 with the old setting back if SWS never follows.
+ */
+static uint8_t ClkMgr_Switch(ClkLevel_t level)
+{
+    const uint32_t div_mask = RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2;
+    uint32_t cfgr = RCC->CFGR;
+    uint32_t acr  = FLASH->ACR;
+    uint32_t sw, sws, n = CLK_MGR_SWITCH_WAIT;
+
+    if (level == CLK_LEVEL_HIGH) {
+        MODIFY_REG(FLASH->ACR, FLASH_ACR_LATENCY, FLASH_LATENCY_2);
+        MODIFY_REG(RCC->CFGR, div_mask,
+                   RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV2 | RCC_CFGR_PPRE2_DIV1);
+        sw  = RCC_CFGR_SW_PLL;
+        sws = RCC_CFGR_SWS_PLL;
+    } else {
+        sw  = RCC_CFGR_SW_HSI;
+        sws = RCC_CFGR_SWS_HSI;
+    }
+
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_SW, sw);
+    while ((RCC->CFGR & RCC_CFGR_SWS) != sws) {
+        if (--n == 0U) {
+            MODIFY_REG(RCC->CFGR, RCC_CFGR_SW | div_mask, cfgr & (RCC_CFGR_SW | div_mask));
+            FLASH->ACR = acr;
+            return 0;
+        }
+    }
+
+    if (level == CLK_LEVEL_LOW) {
+        MODIFY_REG(RCC->CFGR, div_mask,
+                   RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV1 | RCC_CFGR_PPRE2_DIV1);
+        MODIFY_REG(FLASH->ACR, FLASH_ACR_LATENCY, FLASH_LATENCY_0);
+    }
+
+    /* what HAL_InitTick would do, minus the priority */
+    SystemCoreClockUpdate();
+    SysTick->LOAD = SystemCoreClock / (1000U / uwTickFreq) - 1U;
+    SysTick->VAL  = 0U;
+    return 1;
+}
+
+static void ClkMgr_Notify(ClkMgrPhase_t phase, ClkLevel_t level)
+{
+    for (uint32_t i = 0; i < clk_listener_count; i++)
+        clk_listeners[i](phase, level);
+}
+
+static uint8_t ClkMgr_UartIdle(void)
+{
+    return Log_Pending() == 0U && huart2.gState == HAL_UART_STATE_READY &&
+           (huart2.Instance->SR & USART_SR_TC) != 0U;
+}
+
+static void ClkMgr_Account(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    if (clk_level == CLK_LEVEL_LOW)
+        clk_stats.low_ms += now - clk_level_since_ms;
+    else
+        clk_stats.high_ms += now - clk_level_since_ms;
+    clk_level_since_ms = now;
+}
+
+static void ClkMgr_WindowRestart(void)
+{
+    IdleStats_t st;
+
+    Idle_GetStats(&st);
+    clk_window_total = st.total_cycles;
+    clk_window_sleep = st.sleep_cycles;
+    clk_window_start_ms = HAL_GetTick();
+}
+
+void ClkMgr_Init(void)
+{
+    for (uint32_t i = 0; i < sizeof(clk_tims) / sizeof(clk_tims[0]); i++)
+        clk_tims[i].psc_high = clk_tims[i].htim->Init.Prescaler;
+    clk_tclk_high = ClkMgr_TimClock();
+    clk_level = CLK_LEVEL_HIGH;
+    clk_stats = (ClkMgrStats_t){0};
+    clk_low_windows = 0;
+    clk_level_since_ms = HAL_GetTick();
+    clk_last_report_ms = clk_level_since_ms;
+    ClkMgr_WindowRestart();
+}
+
+uint8_t ClkMgr_Register(ClkMgrNotifyFn fn)
+{
+    if (fn == NULL || clk_listener_count >= CLK_MGR_MAX_LISTENERS)
+        return 0;
+
+    clk_listeners[clk_listener_count++] = fn;
+    return 1;
+}
+
+uint8_t ClkMgr_Request(ClkLevel_t level)
+{
+    RCC_OscInitTypeDef osc = {0};
+    uint32_t primask;
+    uint8_t ok = 1;
+
+    if (level == clk_level)
+        return 1;
+    if (level == CLK_LEVEL_LOW && !ClkMgr_BaudFits(CLK_MGR_LOW_PCLK1_HZ)) {
+        clk_stats.baud_refused++;
+        return 0;
+    }
+    if (!ClkMgr_UartIdle()) {
+        clk_stats.deferred++;
+        return 0;
+    }
+
+    ClkMgr_Notify(CLK_MGR_PRE, level);
+
+    if (level == CLK_LEVEL_HIGH) {
+        /* same oscillators as SystemClock_Config, locked before the switch */
+        osc.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+        osc.HSEState = BOOT_HSE_STATE;
+        osc.HSEPredivValue = BOOT_PLL_PREDIV;
+        osc.HSIState = RCC_HSI_ON;
+        osc.PLL.PLLState = RCC_PLL_ON;
+        osc.PLL.PLLSource = BOOT_PLL_SOURCE;
+        osc.PLL.PLLMUL = BOOT_PLL_MUL;
+        ok = HAL_RCC_OscConfig(&osc) == HAL_OK;
+    }
+
+    if (ok) {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        ok = ClkMgr_Switch(level);
+        if (ok) {
+            ClkMgr_Retime();
+            Timebase_Init();
+            ClkMgr_Account();
+            clk_level = level;
+        }
+        __set_PRIMASK(primask);
+    }
+
+    if (ok && level == CLK_LEVEL_LOW) {
+        /* nothing runs from the PLL any more */
+        osc.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+        osc.PLL.PLLState = RCC_PLL_OFF;
+        (void)HAL_RCC_OscConfig(&osc);
+    }
+
+    if (!ok)
+        clk_stats.fails++;
+    else if (level == CLK_LEVEL_HIGH)
+        clk_stats.ups++;
+    else
+        clk_stats.downs++;
+
+    ClkMgr_Notify(CLK_MGR_POST, clk_level);
+    ClkMgr_WindowRestart();
+    return ok;
+}
+
+void ClkMgr_Restore(void)
+{
+    /* STOP wakes up on HSI with the dividers kept: LOW is already
+       back, HIGH needs the PLL again */
+    if (clk_level == CLK_LEVEL_HIGH)
+        SystemClock_Config();
+}
+
+ClkLevel_t ClkMgr_Level(void)
+{
+    return clk_level;
+}
+
+void ClkMgr_GetStats(ClkMgrStats_t *out)
+{
+    ClkMgr_Account();
+    *out = clk_stats;
+    out->hclk_hz = HAL_RCC_GetHCLKFreq();
+    out->level   = clk_level;
+}
+
+void ClkMgr_Poll(void)
+{
+#if CLK_MGR_ENABLE
+    IdleStats_t st;
+    uint64_t total, sleep;
+    uint32_t load;
+
+    if ((HAL_GetTick() - clk_window_start_ms) >= CLK_MGR_WINDOW_MS) {
+        Idle_GetStats(&st);
+        if (st.total_cycles < clk_window_total) {
+            /* idle statistics were reset inside the window */
+            ClkMgr_WindowRestart();
+            return;
+        }
+        total = st.total_cycles - clk_window_total;
+        sleep = st.sleep_cycles - clk_window_sleep;
+        load  = (total != 0U) ? (uint32_t)(((total - sleep) * 1000U) / total) : 1000U;
+
+        if (clk_level == CLK_LEVEL_LOW) {
+            if (load > CLK_MGR_UP_PERMILLE)
+                (void)ClkMgr_Request(CLK_LEVEL_HIGH);
+        } else if (load < CLK_MGR_DOWN_PERMILLE) {
+            if (++clk_low_windows >= CLK_MGR_DOWN_WINDOWS && ClkMgr_Request(CLK_LEVEL_LOW))
+                clk_low_windows = 0;
+        } else {
+            clk_low_windows = 0;
+        }
+        ClkMgr_WindowRestart();
+    }
+#endif
+
+#if CLK_MGR_REPORT_PERIOD_MS
+    {
+        ClkMgrStats_t cs;
+        uint32_t now = HAL_GetTick();
+
+        if ((now - clk_last_report_ms) < CLK_MGR_REPORT_PERIOD_MS)
+            return;
+        clk_last_report_ms = now;
+
+        ClkMgr_GetStats(&cs);
+        (void)Log_Printf("clock: %lu MHz, up %lu down %lu deferred %lu fails %lu "
+                         "baud refused %lu, low %lu s high %lu s\r\n",
+                         (unsigned long)(cs.hclk_hz / 1000000U),
+                         (unsigned long)cs.ups, (unsigned long)cs.downs,
+                         (unsigned long)cs.deferred, (unsigned long)cs.fails,
+                         (unsigned long)cs.baud_refused,
+                         (unsigned long)(cs.low_ms / 1000U), (unsigned long)(cs.high_ms / 1000U));
+    }
+#endif
+}
@@ -0,0 +1,117 @@
+/*
+ * Deferred interrupt work module
+ *
+ * PendSV-driven FIFO of work items scheduled by interrupt
+ * handlers, see defer.h.
+ *
+ * Responsibilities:
+ *  - queue work items, coalesce schedules of a pending item
+ *  - pend PendSV, run the queue from PendSV_Handler
+ *  - count schedules / runs, record schedule -> run latency
+ *
+ * Design principles:
+ *  - intrusive singly linked list: no storage of its own, an item
+ *    is queued at most once (pending mark), so no overflow case
+ *  - the list is touched only inside short PRIMASK sections: the
+ *    schedulers run at any priority, PendSV at the lowest
+ *  - Defer_Run detaches one item at a time and calls it with IRQs
+ *    enabled; an ISR scheduling during the run appends behind it
+ *    and re-pends PendSV, which tail-chains after this exception
+ *
+ * PendSV must have the lowest priority (15, HAL_MspInit), otherwise
+ * the work runs inside the ISRs it was meant to take load off.
+ *
+ * Platform: STM32 (Cortex-M3) + HAL
+ */
+
+#include "defer.h"
+#include "isr_prof.h"
+#include "main.h"
+
+static DeferWork_t *defer_head;
+static DeferWork_t *defer_tail;
+static DeferStats_t defer_stats;
+
+void Defer_Init(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    for (DeferWork_t *w = defer_head; w != NULL; w = w->next)
+        w->pending = 0;
+    defer_head = NULL;
+    defer_tail = NULL;
+    defer_stats = (DeferStats_t){0};
+    __set_PRIMASK(primask);
+}
+
+uint8_t Defer_Schedule(DeferWork_t *w)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (w->pending) {
+        defer_stats.coalesced++;
+        __set_PRIMASK(primask);
+        return 0;
+    }
+
+    w->pending = 1;
+    w->posted  = ISR_PROF_STAMP();
+    w->next    = NULL;
+    if (defer_tail != NULL)
+        defer_tail->next = w;
+    else
+        defer_head = w;
+    defer_tail = w;
+    defer_stats.scheduled++;
+
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    __set_PRIMASK(primask);
+    return 1;
+}
+
+void Defer_Run(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t batch = 0;
+
+    for (;;) {
+        DeferWork_t *w;
+
+        __disable_irq();
+        w = defer_head;
+        if (w == NULL) {
+            __set_PRIMASK(primask);
+            break;
+        }
+        defer_head = w->next;
+        if (defer_head == NULL)
+            defer_tail = NULL;
+        w->pending = 0;
+        __set_PRIMASK(primask);
+
+        ISR_PROF_LATENCY(ISR_PROF_PENDSV, w->posted);
+        w->fn(w->arg);
+        batch++;
+    }
+
+    /* only this handler writes runs / max_batch */
+    defer_stats.runs += batch;
+    if (batch > defer_stats.max_batch)
+        defer_stats.max_batch = batch;
+}
+
+uint8_t Defer_Pending(void)
+{
+    return defer_head != NULL;
+}
+
+void Defer_GetStats(DeferStats_t *out)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *out = defer_stats;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,89 @@
+/*
+ * Event queue module
+ *
+ * SPSC ring buffer, see evq.h for the ownership rules.
+ *
+ * Responsibilities:
+ *  - post / get timestamped events without critical sections
+ *  - count dropped events and track the fill high-water mark
+ *
+ * Design principles:
+ *  - slot is written before head is published (__DMB between),
+ *    slot is read before tail releases it (__DMB between)
+ *  - each index has exactly one writer, so no read-modify-write
+ *    of shared state needs LDREX/STREX or PRIMASK
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "evq.h"
+#include "main.h"
+#include "ramfunc.h"
+
+uint8_t EvQ_Init(EvQueue_t *q, Event_t *storage, uint32_t capacity)
+{
+    if (storage == NULL || capacity == 0U || (capacity & (capacity - 1U)) != 0U)
+        return 0;
+
+    q->buf        = storage;
+    q->mask       = capacity - 1U;
+    q->head       = 0;
+    q->tail       = 0;
+    q->overflows  = 0;
+    q->high_water = 0;
+    return 1;
+}
+
+RAMFUNC uint8_t EvQ_Post(EvQueue_t *q, uint16_t type, uint16_t arg)
+{
+    uint32_t head = q->head;
+    uint32_t used = head - q->tail;
+    Event_t *slot;
+
+    if (used > q->mask) {
+        q->overflows++;
+        return 0;
+    }
+
+    slot = &q->buf[head & q->mask];
+    slot->ts_ms = HAL_GetTick();
+    slot->type  = type;
+    slot->arg   = arg;
+
+    __DMB();            /* slot visible before the new head */
+    q->head = head + 1U;
+
+    if (used + 1U > q->high_water)
+        q->high_water = used + 1U;
+    return 1;
+}
+
+RAMFUNC uint8_t EvQ_Get(EvQueue_t *q, Event_t *out)
+{
+    uint32_t tail = q->tail;
+
+    if (tail == q->head)
+        return 0;
+
+    __DMB();            /* head observed before reading the slot */
+    *out = q->buf[tail & q->mask];
+
+    __DMB();            /* slot copied before it is released */
+    q->tail = tail + 1U;
+    return 1;
+}
+
+uint32_t EvQ_Count(const EvQueue_t *q)
+{
+    return q->head - q->tail;
+}
+
+uint32_t EvQ_Overflows(const EvQueue_t *q)
+{
+    return q->overflows;
+}
+
+uint32_t EvQ_HighWater(const EvQueue_t *q)
+{
+    return q->high_water;
+}
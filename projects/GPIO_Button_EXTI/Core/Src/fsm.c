@@ -0,0 +1,70 @@
+/*
+ * Table-driven state machine module
+ *
+ * Dispatch engine for machines described by const tables, see
+ * fsm.h.
+ *
+ * Responsibilities:
+ *  - find the first row of the current state that matches the
+ *    signal and passes its guard
+ *  - run exit / action / entry in that order
+ *  - optional trace of every fired row
+ *
+ * Design principles:
+ *  - no state of its own: tables are const, the current state
+ *    is passed in and returned, so one engine serves every
+ *    instance of every machine
+ *  - a dispatch only walks the rows of one state; states with
+ *    few rows per signal keep it a short scan with no branches
+ *    that depend on the machine
+ *  - no allocation, no recursion: actions must not dispatch to
+ *    the same instance
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "fsm.h"
+#include "trace.h"
+
+uint8_t Fsm_Start(const FsmDef_t *def, uint8_t initial, void *ctx)
+{
+    FsmActionFn entry = def->states[initial].entry;
+
+    if (entry != NULL)
+        entry(ctx);
+    return initial;
+}
+
+uint8_t Fsm_Dispatch(const FsmDef_t *def, uint8_t state, uint8_t sig, void *ctx)
+{
+    const FsmState_t *s = &def->states[state];
+    const FsmRow_t *row = s->rows;
+    const FsmRow_t *end = row + s->nrows;
+
+    for (; row != end; row++) {
+        if (row->sig != sig || (row->guard != NULL && !row->guard(ctx)))
+            continue;
+
+        if (row->next == FSM_SAME) {
+            if (row->action != NULL)
+                row->action(ctx);
+#if FSM_TRACE_ENABLE
+            TRACE("fsm %u: %u -> %u on %u\n", def->id, state, state, sig);
+#endif
+            return state;
+        }
+
+        if (s->exit != NULL)
+            s->exit(ctx);
+        if (row->action != NULL)
+            row->action(ctx);
+        if (def->states[row->next].entry != NULL)
+            def->states[row->next].entry(ctx);
+#if FSM_TRACE_ENABLE
+        TRACE("fsm %u: %u -> %u on %u\n", def->id, state, row->next, sig);
+#endif
+        return row->next;
+    }
+
+    return state;
+}
@@ -55,7 +55,7 @@ void MX_GPIO_Init(void)
 
   /*Configure GPIO pin : USER_BUTTON_Pin */
   GPIO_InitStruct.Pin = USER_BUTTON_Pin;
-  GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
   GPIO_InitStruct.Pull = GPIO_PULLUP;
   HAL_GPIO_Init(USER_BUTTON_GPIO_Port, &GPIO_InitStruct);
 
@@ -73,5 +73,34 @@ void MX_GPIO_Init(void)
 }
 
 /* USER CODE BEGIN 2 */
+/* Key panel inputs (PANEL_KEYS_Pins), polled by the button bank, no EXTI */
+void MX_PanelKeys_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  if (PANEL_KEYS_Pins == 0U)
+    return;
+
+  GPIO_InitStruct.Pin = PANEL_KEYS_Pins;
+  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+  GPIO_InitStruct.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(PANEL_KEYS_GPIO_Port, &GPIO_InitStruct);
+}
+
+/* CAP_BUTTON: input capture pin of TIM4 (MX_TIM4_Init), plus EXTI6 on
+   both edges as the wake-up of the capture backend. Call after
+   MX_TIM4_Init(); button_cap.c masks the line while it follows edges */
+void MX_CapButton_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  GPIO_InitStruct.Pin = CAP_BUTTON_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
+  GPIO_InitStruct.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(CAP_BUTTON_GPIO_Port, &GPIO_InitStruct);
+
+  HAL_NVIC_SetPriority(CAP_BUTTON_EXTI_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(CAP_BUTTON_EXTI_IRQn);
+}
 
 /* USER CODE END 2 */
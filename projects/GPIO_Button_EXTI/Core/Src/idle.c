@@ -0,0 +1,302 @@
+/*
+ * Idle scheduler module
+ *
+ * Puts the core to sleep between events, see idle.h for the
+ * idle levels and the meaning of the statistics.
+ *
+ * Design principles:
+ *  - deadline check and WFI happen with PRIMASK set: a pending
+ *    interrupt still terminates WFI, its handler runs right after
+ *    __enable_irq(), so no wakeup is ever lost
+ *  - SysTick and TIM2 are reprogrammed and restored inside that
+ *    critical section; the handlers of the waking interrupt see
+ *    the compensated Timebase
+ *  - a tick already pending on entry (the reload or update came
+ *    after the mask) keeps both counters as they are: WFI returns
+ *    at once and the handler counts it
+ *  - a stretched SysTick expires on a 1 ms boundary and reloads
+ *    with 1 ms right away, so the wall clock stays in phase; an
+ *    early wakeup restarts it on the next boundary. Stopping the
+ *    counter to read it costs a few cycles per sleep
+ *  - TIM2 never loses its phase: CNT goes back to the position in
+ *    the tick period it would have had
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "idle.h"
+#include "main.h"
+#include "clk_mgr.h"
+#include "tick.h"
+#include "tim.h"
+#include "timebase.h"
+#include "uart_log.h"
+#include "led_pwm.h"
+
+#if IDLE_REPORT_PERIOD_MS
+#include <stdio.h>
+#endif
+
+static IdleStats_t idle_stats;
+static uint64_t idle_epoch_cycles;
+static uint32_t idle_last_report_ms;
+static uint32_t idle_tick_arr;      /* TIM2 ARR of the tick period */
+static uint32_t idle_tick_cnt;      /* TIM2 CNT when it was held */
+
+/* Wall clock in HCLK cycles; call with interrupts masked */
+static uint64_t Idle_WallCycles(void)
+{
+    uint32_t load = SysTick->LOAD + 1U;
+    uint32_t tick = HAL_GetTick();
+    uint32_t val  = SysTick->VAL;
+
+    /* reload already happened but SysTick_Handler is held off */
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        val = SysTick->VAL;
+        tick++;
+    }
+
+    return (uint64_t)tick * load + (load - 1U - val);
+}
+
+/* SysTick restarted on a 1 ms boundary 'first' cycles from now,
+   1 ms reload from there on */
+static void Idle_SysTickRestart(uint32_t first, uint32_t load)
+{
+    (void)SysTick_Config(first);
+    HAL_NVIC_SetPriority(SysTick_IRQn, uwTickPrio, 0U);
+    SysTick->LOAD = load - 1U;
+}
+
+/* SysTick stopped, TIM2 without updates: ARR to the maximum, CNT
+   counts on (1 ms per count at both clock levels, clk_mgr.c).
+   0 with both running as before if a tick came after the mask:
+   WFI has to return at once for its handler */
+static uint8_t Idle_TicksHold(void)
+{
+    TIM_TypeDef *tim = htim2.Instance;
+
+    /* a reload just before the stop stays pending */
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        return 0;
+    }
+
+    idle_tick_arr = tim->ARR;
+    idle_tick_cnt = tim->CNT;
+    tim->ARR = 0xFFFFU;
+
+    /* an update just before: CNT restarted at 0, ARR can go back */
+    if (tim->SR & TIM_SR_UIF) {
+        tim->ARR = idle_tick_arr;
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        return 0;
+    }
+    return 1;
+}
+
+/* back to the tick period in phase; returns the counts since the
+   last update, the skipped updates are that / (ARR + 1) */
+static uint32_t Idle_TickResume(void)
+{
+    TIM_TypeDef *tim = htim2.Instance;
+    uint32_t pos = tim->CNT;
+
+    /* 16-bit overflow (65.5 s): its IRQ is what woke us, the
+       handler finds UIF clear and dispatches nothing */
+    if (tim->SR & TIM_SR_UIF) {
+        tim->SR = ~(uint32_t)TIM_SR_UIF;
+        pos = tim->CNT + 0x10000U;
+    }
+
+    /* CNT first: a counter above the new ARR would run to 0xFFFF */
+    tim->CNT = pos % (idle_tick_arr + 1U);
+    tim->ARR = idle_tick_arr;
+    return pos;
+}
+
+/* SysTick expires on the ms boundary of the deadline instead of
+   every ms, TIM2 updates are dispatched after WFI */
+static void Idle_SleepStretched(uint32_t ms)
+{
+    uint32_t load = SysTick->LOAD + 1U;
+    uint32_t skipped, left, pos;
+
+    if (ms > IDLE_MAX_SLEEP_MS)
+        ms = IDLE_MAX_SLEEP_MS;
+    if (ms > SysTick_LOAD_RELOAD_Msk / load)
+        ms = SysTick_LOAD_RELOAD_Msk / load;
+
+    Idle_SysTickRestart(SysTick->VAL + 1U + (ms - 1U) * load, load);
+    idle_stats.tick_stretched++;
+
+    HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        /* expired, already on the 1 ms reload: the handler counts
+           the last ms */
+        skipped = ms - 1U;
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    } else {
+        /* woken early: boundaries up to the deadline not reached */
+        left = SysTick->VAL + 1U;
+        skipped = ms - (left + load - 1U) / load;
+        Idle_SysTickRestart((left - 1U) % load + 1U, load);
+    }
+    Timebase_SkipTicks(skipped);
+
+    /* ISR context for the consumers, as from TIM2_IRQHandler */
+    for (pos = Idle_TickResume(); pos > idle_tick_arr; pos -= idle_tick_arr + 1U)
+        Tick_Dispatch();
+}
+
+/* nothing due: SysTick stopped, TIM2 measures the sleep; its
+   skipped updates are dropped, no consumer is waiting for one */
+static void Idle_SleepStopped(void)
+{
+    uint32_t counts;
+
+    idle_stats.tick_stopped++;
+
+    HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+
+    counts = Idle_TickResume() - idle_tick_cnt;
+    Timebase_SkipTicks((counts * TICK_PERIOD_MS) / (idle_tick_arr + 1U));
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+}
+
+void Idle_Init(void)
+{
+    Idle_ResetStats();
+    idle_last_report_ms = HAL_GetTick();
+}
+
+void Idle_Run(IdleDeadlineFn next_deadline_ms)
+{
+    uint64_t t0, t1;
+    uint32_t deadline;
+
+    __disable_irq();
+
+    deadline = next_deadline_ms();
+    if (deadline == 0U) {
+        __enable_irq();
+        return;
+    }
+
+#if IDLE_USE_STOP
+    /* STOP gates the USART / DMA / TIM3 clocks: drain the log and
+       keep the PWM LED running in SLEEP */
+    if (deadline == IDLE_NO_DEADLINE && Log_Pending() == 0U && !LedPwm_Active()) {
+        idle_stats.stops++;
+        HAL_SuspendTick();
+        HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+        /* STOP wakes up on HSI: the restore waits on HAL_GetTick
+           timeouts, the tick has to run first. The wakeup handler
+           runs at 8 MHz with the old dividers, the log is drained */
+        HAL_ResumeTick();
+        __enable_irq();
+        ClkMgr_Restore();
+        return;
+    }
+#endif
+
+    t0 = Idle_WallCycles();
+
+    if (deadline < IDLE_TICKLESS_MIN_MS || !Idle_TicksHold())
+        HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    else if (deadline == IDLE_NO_DEADLINE)
+        Idle_SleepStopped();
+    else
+        Idle_SleepStretched(deadline);
+
+    /* woken by SysTick: cycles since its reload = wakeup latency */
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        uint32_t lat = SysTick->LOAD - SysTick->VAL;
+
+        if (idle_stats.wake_count == 0U || lat < idle_stats.wake_lat_min)
+            idle_stats.wake_lat_min = lat;
+        if (lat > idle_stats.wake_lat_max)
+            idle_stats.wake_lat_max = lat;
+        idle_stats.wake_lat_sum += lat;
+        idle_stats.wake_count++;
+    }
+
+    t1 = Idle_WallCycles();
+    idle_stats.sleep_cycles += t1 - t0;
+    idle_stats.sleeps++;
+
+    __enable_irq();
+}
+
+void Idle_GetStats(IdleStats_t *out)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *out = idle_stats;
+    out->total_cycles = Idle_WallCycles() - idle_epoch_cycles;
+    __set_PRIMASK(primask);
+}
+
+void Idle_ResetStats(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    idle_stats = (IdleStats_t){0};
+    idle_epoch_cycles = Idle_WallCycles();
+    __set_PRIMASK(primask);
+}
+
+uint32_t Idle_DutyPermille(const IdleStats_t *st)
+{
+    if (st->total_cycles == 0U)
+        return 1000U;
+
+    return (uint32_t)(((st->total_cycles - st->sleep_cycles) * 1000U) / st->total_cycles);
+}
+
+#if IDLE_REPORT_PERIOD_MS
+/* count per second of wall time; the statistics restart on every
+   clock switch, so SystemCoreClock held for all of it */
+static uint32_t Idle_PerSecond(const IdleStats_t *st, uint32_t count)
+{
+    if (st->total_cycles == 0U)
+        return 0;
+
+    return (uint32_t)(((uint64_t)count * SystemCoreClock) / st->total_cycles);
+}
+#endif
+
+void Idle_Poll(void)
+{
+#if IDLE_REPORT_PERIOD_MS
+    IdleStats_t st;
+    char line[192];
+    uint32_t now = HAL_GetTick();
+    int len;
+
+    if ((now - idle_last_report_ms) < IDLE_REPORT_PERIOD_MS)
+        return;
+    idle_last_report_ms = now;
+
+    Idle_GetStats(&st);
+    len = snprintf(line, sizeof(line),
+                   "idle: duty %lu.%lu%% sleeps %lu stretched %lu stopped %lu stops %lu "
+                   "wakes %lu/s (systick %lu/s) wake lat %lu/%lu/%lu cyc\r\n",
+                   (unsigned long)(Idle_DutyPermille(&st) / 10U),
+                   (unsigned long)(Idle_DutyPermille(&st) % 10U),
+                   (unsigned long)st.sleeps, (unsigned long)st.tick_stretched,
+                   (unsigned long)st.tick_stopped, (unsigned long)st.stops,
+                   (unsigned long)Idle_PerSecond(&st, st.sleeps),
+                   (unsigned long)Idle_PerSecond(&st, st.wake_count),
+                   (unsigned long)st.wake_lat_min,
+                   (unsigned long)(st.wake_count ? st.wake_lat_sum / st.wake_count : 0U),
+                   (unsigned long)st.wake_lat_max);
+    Log_Write(line, (uint32_t)len);
+    Idle_ResetStats();
+#endif
+}
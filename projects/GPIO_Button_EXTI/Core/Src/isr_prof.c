@@ -0,0 +1,190 @@
+/*
+ * ISR profiler module
+ *
+ * DWT->CYCCNT based duration / period / jitter / latency
+ * statistics for interrupt handlers, see isr_prof.h for the usage
+ * model.
+ *
+ * Design principles:
+ *  - ISR side does a fixed, branch-light amount of work
+ *  - no division in ISR context (means are computed on the host)
+ *  - the main loop only copies a consistent snapshot and sends it
+ *
+ * CYCCNT wraps every 67 s at 64 MHz; all deltas are computed
+ * with unsigned 32-bit arithmetic, so a single wrap is harmless.
+ *
+ * Platform: STM32 (Cortex-M3) + HAL
+ */
+
+#include <string.h>
+
+#include "isr_prof.h"
+#include "main.h"
+#include "uart_log.h"
+
+#if ISR_PROF_ENABLE
+
+static IsrProfStats_t isr_prof_stats[ISR_PROF_COUNT];
+static uint32_t isr_prof_overhead;
+static uint32_t isr_prof_last_dump_ms;
+static IsrProfDump_t isr_prof_dump;
+
+/* the dump is queued as one log message */
+_Static_assert(sizeof(IsrProfDump_t) <= LOG_BUF_SIZE, "IsrProfDump_t exceeds LOG_BUF_SIZE");
+
+static inline uint32_t IsrProf_Bin(uint32_t v)
+{
+    uint32_t bin = (v == 0U) ? 0U : (31U - __CLZ(v));
+    return (bin < ISR_PROF_HIST_BINS) ? bin : (ISR_PROF_HIST_BINS - 1U);
+}
+
+static void IsrProf_ClearStats(void)
+{
+    memset(isr_prof_stats, 0, sizeof(isr_prof_stats));
+    for (uint32_t i = 0; i < ISR_PROF_COUNT; i++) {
+        isr_prof_stats[i].dur_min    = UINT32_MAX;
+        isr_prof_stats[i].period_min = UINT32_MAX;
+        isr_prof_stats[i].lat_min    = UINT32_MAX;
+    }
+}
+
+uint32_t IsrProf_Enter(IsrProfId_t id)
+{
+    uint32_t now = DWT->CYCCNT;
+    IsrProfStats_t *s = &isr_prof_stats[id];
+
+    if (s->count != 0U) {
+        uint32_t period = now - s->last_entry;
+
+        if (period < s->period_min) s->period_min = period;
+        if (period > s->period_max) s->period_max = period;
+        s->period_sum += period;
+        s->period_count++;
+
+        if (s->period_expected != 0U) {
+            uint32_t jitter = (period > s->period_expected)
+                            ? (period - s->period_expected)
+                            : (s->period_expected - period);
+            if (jitter > s->jitter_max) s->jitter_max = jitter;
+            s->jitter_hist[IsrProf_Bin(jitter)]++;
+        }
+    }
+    s->last_entry = now;
+
+    return now;
+}
+
+void IsrProf_Exit(IsrProfId_t id, uint32_t t_entry)
+{
+    uint32_t dur = DWT->CYCCNT - t_entry;
+    IsrProfStats_t *s = &isr_prof_stats[id];
+
+    dur = (dur > isr_prof_overhead) ? (dur - isr_prof_overhead) : 0U;
+
+    if (dur < s->dur_min) s->dur_min = dur;
+    if (dur > s->dur_max) s->dur_max = dur;
+    s->dur_sum += dur;
+    s->count++;
+    s->dur_hist[IsrProf_Bin(dur)]++;
+}
+
+uint32_t IsrProf_Stamp(void)
+{
+    return DWT->CYCCNT;
+}
+
+/* stamp -> now, no overhead correction: the probe is one read */
+void IsrProf_Latency(IsrProfId_t id, uint32_t t_stamp)
+{
+    uint32_t lat = DWT->CYCCNT - t_stamp;
+    IsrProfStats_t *s = &isr_prof_stats[id];
+
+    if (lat < s->lat_min) s->lat_min = lat;
+    if (lat > s->lat_max) s->lat_max = lat;
+    s->lat_sum += lat;
+    s->lat_count++;
+    s->lat_hist[IsrProf_Bin(lat)]++;
+}
+
+void IsrProf_Init(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    /* already counting since Reset_Handler (boot.h); CYCCNT is not
+       cleared, the boot profile stamps are taken against it */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    /* calibrate: cost of an empty ENTER/EXIT pair; masked, the
+       deferred boot init runs this with the interrupts live */
+    __disable_irq();
+    isr_prof_overhead = 0;
+    IsrProf_ClearStats();
+    {
+        ISR_PROF_ENTER(ISR_PROF_TIM2);
+        ISR_PROF_EXIT(ISR_PROF_TIM2);
+    }
+    isr_prof_overhead = isr_prof_stats[ISR_PROF_TIM2].dur_min;
+
+    IsrProf_ClearStats();
+    __set_PRIMASK(primask);
+    isr_prof_last_dump_ms = HAL_GetTick();
+}
+
+void IsrProf_SetPeriod(IsrProfId_t id, uint32_t expected_cycles)
+{
+    isr_prof_stats[id].period_expected = expected_cycles;
+}
+
+void IsrProf_Reset(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t expected[ISR_PROF_COUNT];
+
+    __disable_irq();
+    for (uint32_t i = 0; i < ISR_PROF_COUNT; i++)
+        expected[i] = isr_prof_stats[i].period_expected;
+    IsrProf_ClearStats();
+    for (uint32_t i = 0; i < ISR_PROF_COUNT; i++)
+        isr_prof_stats[i].period_expected = expected[i];
+    __set_PRIMASK(primask);
+}
+
+void IsrProf_Snapshot(IsrProfDump_t *out)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    out->magic           = ISR_PROF_MAGIC;
+    out->version         = ISR_PROF_VERSION;
+    out->source_count    = ISR_PROF_COUNT;
+    out->core_clock_hz   = SystemCoreClock;
+    out->overhead_cycles = isr_prof_overhead;
+
+    /* short critical section: ~1 µs copy at 64 MHz */
+    __disable_irq();
+    memcpy(out->stats, isr_prof_stats, sizeof(isr_prof_stats));
+    __set_PRIMASK(primask);
+}
+
+void IsrProf_Poll(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    if ((now - isr_prof_last_dump_ms) < ISR_PROF_DUMP_PERIOD_MS)
+        return;
+    isr_prof_last_dump_ms = now;
+
+    /* dropped as a whole if the log ring is busy: never a torn dump */
+    IsrProf_Snapshot(&isr_prof_dump);
+    Log_Write(&isr_prof_dump, sizeof(isr_prof_dump));
+}
+
+#else /* !ISR_PROF_ENABLE */
+
+void IsrProf_Init(void) {}
+void IsrProf_SetPeriod(IsrProfId_t id, uint32_t expected_cycles) { (void)id; (void)expected_cycles; }
+void IsrProf_Reset(void) {}
+void IsrProf_Snapshot(IsrProfDump_t *out) { memset(out, 0, sizeof(*out)); }
+void IsrProf_Poll(void) {}
+
+#endif /* ISR_PROF_ENABLE */
@@ -0,0 +1,385 @@
+/*
+ * Settings store module
+ *
+ * Log-structured key / value records in flash, see kv_store.h
+ * for the on-flash layout and the power-loss rules.
+ *
+ * Responsibilities:
+ *  - append records with HAL_FLASH_Program (halfwords)
+ *  - open / compact / erase pages with HAL_FLASHEx_Erase
+ *  - rebuild the RAM index and repair the region at boot
+ *
+ * Design principles:
+ *  - flash is only ever programmed from 0xFFFF, except the page
+ *    check word which is cleared to 0x0000 before an erase
+ *  - all offsets are relative to KV_FLASH_BASE, flash is read
+ *    through the memory map
+ *  - compaction copies at most one page of live records into a
+ *    freshly opened page, so it never needs another free page
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include <string.h>
+
+#include "kv_store.h"
+#include "main.h"
+
+#define KV_MAGIC        0x4B56U     /* "KV" */
+#define KV_HDR_SIZE     8U
+#define KV_NONE         0xFFFFU
+#define KV_REC_SIZE(len) (4U + (((uint32_t)(len) + 1U) & ~1U))
+#define KV_REC_HDR(key, len) ((uint16_t)(((uint32_t)(key) << 8) | (uint32_t)(len)))
+#define KV_REC_MAX      KV_REC_SIZE(KV_VALUE_MAX)
+
+/* one page holds every live record plus a torn one and the pending one */
+_Static_assert(KV_HDR_SIZE + (KV_MAX_KEYS + 2U) * KV_REC_MAX <= KV_PAGE_SIZE,
+               "live settings must fit in one page");
+_Static_assert(KV_PAGES >= 2U, "compaction needs a spare page");
+
+static uint16_t kv_index[KV_MAX_KEYS];  /* offset of the newest record */
+static uint32_t kv_seq[KV_PAGES];       /* 0 = erased */
+static uint32_t kv_head;                /* page being appended to */
+static uint32_t kv_wr;                  /* write offset inside kv_head */
+static uint8_t  kv_compacting;
+static KvStats_t kv_stats;
+
+static inline uint16_t Kv_Rd16(uint32_t off)
+{
+    return *(const volatile uint16_t *)(uintptr_t)(KV_FLASH_BASE + off);
+}
+
+static inline const uint8_t *Kv_Ptr(uint32_t off)
+{
+    return (const uint8_t *)(uintptr_t)(KV_FLASH_BASE + off);
+}
+
+static uint16_t Kv_Crc(uint16_t key, uint16_t len, const uint8_t *data)
+{
+    uint8_t head[2] = { (uint8_t)len, (uint8_t)key };
+    uint16_t crc = 0xFFFFU;
+
+    /* CRC-16/CCITT-FALSE over record header and value */
+    for (uint32_t i = 0; i < 2U + len; i++) {
+        crc ^= (uint16_t)((i < 2U) ? head[i] : data[i - 2U]) << 8;
+        for (uint32_t b = 0; b < 8U; b++)
+            crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+static uint16_t Kv_HeaderCheck(uint32_t seq)
+{
+    return (uint16_t)~(KV_MAGIC ^ (seq & 0xFFFFU) ^ (seq >> 16));
+}
+
+/* ===== Flash access ===== */
+
+static uint8_t Kv_Program(uint32_t off, uint16_t value)
+{
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, KV_FLASH_BASE + off, value) != HAL_OK) {
+        kv_stats.flash_errors++;
+        return 0;
+    }
+    return 1;
+}
+
+static void Kv_ErasePage(uint32_t page)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t page_error;
+
+    /* obsolete first: an interrupted erase is never mistaken for data */
+    (void)Kv_Program(page * KV_PAGE_SIZE + 6U, 0x0000U);
+
+    erase.TypeErase   = FLASH_TYPEERASE_PAGES;
+    erase.PageAddress = KV_FLASH_BASE + page * KV_PAGE_SIZE;
+    erase.NbPages     = 1;
+    if (HAL_FLASHEx_Erase(&erase, &page_error) != HAL_OK)
+        kv_stats.flash_errors++;
+
+    kv_seq[page] = 0;
+    kv_stats.page_erases++;
+}
+
+/* sequence number of a valid page header, 0 otherwise */
+static uint32_t Kv_PageSeq(uint32_t page)
+{
+    uint32_t off = page * KV_PAGE_SIZE;
+    uint32_t seq = Kv_Rd16(off + 2U) | ((uint32_t)Kv_Rd16(off + 4U) << 16);
+
+    if (Kv_Rd16(off) != KV_MAGIC || Kv_Rd16(off + 6U) != Kv_HeaderCheck(seq))
+        return 0;
+    return seq;
+}
+
+static uint8_t Kv_PageBlank(uint32_t page)
+{
+    for (uint32_t off = 0; off < KV_PAGE_SIZE; off += 2U) {
+        if (Kv_Rd16(page * KV_PAGE_SIZE + off) != 0xFFFFU)
+            return 0;
+    }
+    return 1;
+}
+
+/* ===== Pages ===== */
+
+static uint32_t Kv_ErasedPages(void)
+{
+    uint32_t n = 0;
+
+    for (uint32_t p = 0; p < KV_PAGES; p++)
+        n += (kv_seq[p] == 0U);
+    return n;
+}
+
+static uint32_t Kv_OldestPage(void)
+{
+    uint32_t oldest = kv_head;
+
+    for (uint32_t p = 0; p < KV_PAGES; p++) {
+        if (kv_seq[p] != 0U && kv_seq[p] < kv_seq[oldest])
+            oldest = p;
+    }
+    return oldest;
+}
+
+static void Kv_OpenPage(uint32_t page, uint32_t seq)
+{
+    uint32_t off = page * KV_PAGE_SIZE;
+
+    /* 0x0000 / 0xFFFF check words are reserved */
+    while (seq == 0U || Kv_HeaderCheck(seq) == 0x0000U || Kv_HeaderCheck(seq) == 0xFFFFU)
+        seq++;
+
+    (void)Kv_Program(off, KV_MAGIC);
+    (void)Kv_Program(off + 2U, (uint16_t)seq);
+    (void)Kv_Program(off + 4U, (uint16_t)(seq >> 16));
+    (void)Kv_Program(off + 6U, Kv_HeaderCheck(seq));
+
+    kv_seq[page] = seq;
+    kv_head = page;
+    kv_wr   = KV_HDR_SIZE;
+}
+
+static uint8_t Kv_Append(uint16_t key, const uint8_t *data, uint32_t len);
+
+/* move the live records out of the oldest page, then erase it */
+static void Kv_Compact(void)
+{
+    uint32_t oldest = Kv_OldestPage();
+
+    if (oldest == kv_head)
+        return;
+
+    kv_compacting = 1;
+    for (uint16_t key = 0; key < KV_MAX_KEYS; key++) {
+        uint32_t off = kv_index[key];
+
+        if (off == KV_NONE || off / KV_PAGE_SIZE != oldest)
+            continue;
+        if (!Kv_Append(key, Kv_Ptr(off + 2U), Kv_Rd16(off) & 0xFFU))
+            break;
+        kv_stats.gc_copies++;
+    }
+    kv_compacting = 0;
+
+    /* a record that could not be moved keeps its page alive */
+    for (uint16_t key = 0; key < KV_MAX_KEYS; key++) {
+        if (kv_index[key] != KV_NONE && kv_index[key] / KV_PAGE_SIZE == oldest)
+            return;
+    }
+    Kv_ErasePage(oldest);
+}
+
+/* next erased page in round-robin order; compacts if it was the last one */
+static uint8_t Kv_NextPage(void)
+{
+    for (uint32_t i = 1; i < KV_PAGES; i++) {
+        uint32_t p = (kv_head + i) % KV_PAGES;
+
+        if (kv_seq[p] == 0U) {
+            Kv_OpenPage(p, kv_seq[kv_head] + 1U);
+            if (Kv_ErasedPages() == 0U)
+                Kv_Compact();
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* ===== Records ===== */
+
+static uint8_t Kv_Append(uint16_t key, const uint8_t *data, uint32_t len)
+{
+    uint32_t size = KV_REC_SIZE(len);
+    uint32_t off, i;
+    uint8_t ok;
+
+    if (kv_wr + size > KV_PAGE_SIZE) {
+        if (kv_compacting || !Kv_NextPage())
+            return 0;
+    }
+
+    off = kv_head * KV_PAGE_SIZE + kv_wr;
+    kv_wr += size;      /* space is used even if programming fails */
+
+    ok = Kv_Program(off, KV_REC_HDR(key, len));
+    for (i = 0; i + 1U < len && ok; i += 2U)
+        ok &= Kv_Program(off + 2U + i, (uint16_t)(data[i] | (data[i + 1U] << 8)));
+    if (i < len && ok)
+        ok &= Kv_Program(off + 2U + i, (uint16_t)(data[i] | 0xFF00U));
+
+    /* CRC last: the record only counts once it is complete */
+    if (ok)
+        ok &= Kv_Program(off + size - 2U, Kv_Crc(key, (uint16_t)len, data));
+    if (!ok)
+        return 0;
+
+    kv_index[key] = (uint16_t)off;
+    kv_stats.records++;
+    return 1;
+}
+
+/* index every valid record of one page, returns the end of its log */
+static uint32_t Kv_ScanPage(uint32_t page)
+{
+    uint32_t base = page * KV_PAGE_SIZE;
+    uint32_t off  = KV_HDR_SIZE;
+
+    while (off + 2U <= KV_PAGE_SIZE) {
+        uint16_t hdr  = Kv_Rd16(base + off);
+        uint16_t key  = hdr >> 8;
+        uint16_t len  = hdr & 0xFFU;
+        uint32_t size = KV_REC_SIZE(len);
+
+        if (hdr == 0xFFFFU)
+            break;                      /* erased: end of the log */
+
+        /* torn header: nothing behind it was written, skip one halfword */
+        if (key >= KV_MAX_KEYS || len > KV_VALUE_MAX) {
+            kv_stats.crc_errors++;
+            off += 2U;
+            continue;
+        }
+        if (off + size > KV_PAGE_SIZE)
+            return KV_PAGE_SIZE;
+
+        if (Kv_Rd16(base + off + size - 2U) == Kv_Crc(key, len, Kv_Ptr(base + off + 2U)))
+            kv_index[key] = (uint16_t)(base + off);
+        else
+            kv_stats.crc_errors++;
+
+        off += size;
+    }
+    return off;
+}
+
+void Kv_Init(void)
+{
+    uint32_t order[KV_PAGES];
+    uint32_t n = 0;
+
+    memset(kv_index, 0xFF, sizeof(kv_index));
+    memset(&kv_stats, 0, sizeof(kv_stats));
+    kv_compacting = 0;
+
+    HAL_FLASH_Unlock();
+
+    /* torn headers and interrupted erases are erased again */
+    for (uint32_t p = 0; p < KV_PAGES; p++) {
+        kv_seq[p] = Kv_PageSeq(p);
+        if (kv_seq[p] == 0U && !Kv_PageBlank(p))
+            Kv_ErasePage(p);
+    }
+
+    /* pages in sequence order, oldest first */
+    for (uint32_t p = 0; p < KV_PAGES; p++) {
+        uint32_t i = n++;
+
+        if (kv_seq[p] == 0U) {
+            n--;
+            continue;
+        }
+        while (i > 0U && kv_seq[order[i - 1U]] > kv_seq[p]) {
+            order[i] = order[i - 1U];
+            i--;
+        }
+        order[i] = p;
+    }
+
+    if (n == 0U) {
+        Kv_OpenPage(0, 1);              /* blank region: format */
+    } else {
+        for (uint32_t i = 0; i < n; i++) {
+            kv_head = order[i];
+            kv_wr   = Kv_ScanPage(order[i]);
+        }
+
+        /* power lost during compaction: finish it */
+        if (Kv_ErasedPages() == 0U)
+            Kv_Compact();
+    }
+
+    HAL_FLASH_Lock();
+}
+
+uint8_t Kv_Get(uint16_t key, void *out, uint32_t *len)
+{
+    uint32_t off, n;
+
+    if (key >= KV_MAX_KEYS || kv_index[key] == KV_NONE)
+        return 0;
+
+    off = kv_index[key];
+    n   = Kv_Rd16(off) & 0xFFU;
+    if (n > *len)
+        return 0;
+
+    memcpy(out, Kv_Ptr(off + 2U), n);
+    *len = n;
+    return 1;
+}
+
+uint8_t Kv_Set(uint16_t key, const void *data, uint32_t len)
+{
+    uint8_t ok;
+
+    if (key >= KV_MAX_KEYS || len > KV_VALUE_MAX)
+        return 0;
+
+    /* unchanged value: no flash wear */
+    if (kv_index[key] != KV_NONE &&
+        Kv_Rd16(kv_index[key]) == KV_REC_HDR(key, len) &&
+        memcmp(Kv_Ptr(kv_index[key] + 2U), data, len) == 0)
+        return 1;
+
+    HAL_FLASH_Unlock();
+    ok = Kv_Append(key, (const uint8_t *)data, len);
+    HAL_FLASH_Lock();
+    return ok;
+}
+
+uint32_t Kv_GetU32(uint16_t key, uint32_t def)
+{
+    uint32_t value, len = sizeof(value);
+
+    if (!Kv_Get(key, &value, &len) || len != sizeof(value))
+        return def;
+    return value;
+}
+
+uint8_t Kv_SetU32(uint16_t key, uint32_t value)
+{
+    return Kv_Set(key, &value, sizeof(value));
+}
+
+void Kv_GetStats(KvStats_t *out)
+{
+    uint32_t erased = Kv_ErasedPages();
+
+    /* one erased page is kept as the compaction target */
+    *out = kv_stats;
+    out->free_bytes = (KV_PAGE_SIZE - kv_wr) +
+                      ((erased > 1U) ? (erased - 1U) * (KV_PAGE_SIZE - KV_HDR_SIZE) : 0U);
+}
@@ -5,64 +5,176 @@
  * for LED control on STM32.
  *
  * Responsibilities:
- *  - manage LED operating modes (OFF / ON / BLINK)
- *  - handle time-based blinking behavior
- *  - provide a single point of control for LED GPIO
+ *  - manage LED operating modes (OFF / ON / BLINK / PATTERN /
+ *    PWM modes)
+ *  - provide a single point of control for LED GPIO and PWM
  *
  * Design principles:
  *  - no blocking delays
- *  - no application logic inside ISR
- *  - ISR used only as a time base (tick source)
- *  - all state transitions are explicit
+ *  - blinking is a sequencer pattern (led_seq.h), the tick only
+ *    counts down and flips the pin
+ *  - all state transitions are explicit: one state per mode in
+ *    the const table led_states[] (fsm.h engine), the outputs
+ *    of a mode are set by its entry action
  *
  * Usage model:
  *  - Led_SetMode() is called from application logic
- *  - Led_OnTick() is called periodically from timer ISR
+ *  - BLINK / PATTERN play on sequencer channel LED_CH_LD2
+ *  - DIM sets a static duty, BREATHE / FADE_* hand a generated
+ *    table to the DMA (led_wave.h), nothing runs per step
+ *  - setting the current mode again restarts it (self-transition)
  *  - Led_Process() is reserved for future extensions
  *
  * Platform: STM32 + HAL
  */
 
+#include <stddef.h>
+
 #include "led_fsm.h"
+#include "fsm.h"
+#include "led_pwm.h"
+#include "led_seq.h"
+#include "led_wave.h"
 #include "main.h"
 
-/* параметры */
-#define LED_BLINK_PERIOD_MS 500
-#define SYS_TICK_PERIOD_MS   2
-static LedMode_t led_mode = LED_MODE_OFF;
-static uint32_t led_tick = 0;
+/* trace tag, FSM_TRACE_ENABLE */
+#define LED_FSM_ID      2U
+
+/* ===== Signals ===== */
+/* LED_MODE_x requests mode x (PATTERN through Led_SetPattern only) */
+#define LED_SIG_LEVEL   (LED_MODE_PATTERN + 1U)    /* DIM brightness changed */
+
+static uint8_t led_state = LED_MODE_OFF;
+static uint8_t led_dim_pct = LED_DIM_DEFAULT_PCT;
+static const LedSeqPattern_t *led_pattern;         /* entry of PATTERN */
+
+/* ===== Entry actions ===== */
+
+static void Led_EnterOff(void *ctx)
+{
+    (void)ctx;
+    LedSeq_Stop(LED_CH_LD2, 0);
+    LedPwm_SetLevel(0U);
+}
+
+static void Led_EnterOn(void *ctx)
+{
+    (void)ctx;
+    LedSeq_Stop(LED_CH_LD2, 1);
+    LedPwm_SetLevel(LED_PWM_MAX);
+}
+
+static void Led_EnterBlink(void *ctx)
+{
+    (void)ctx;
+    LedSeq_Play(LED_CH_LD2, &led_pat_blink);
+    LedPwm_SetLevel(0U);
+}
+
+static void Led_ApplyLevel(void *ctx)
+{
+    (void)ctx;
+    LedPwm_SetLevel(led_gamma[led_dim_pct]);
+}
+
+static void Led_EnterDim(void *ctx)
+{
+    LedSeq_Stop(LED_CH_LD2, 0);
+    Led_ApplyLevel(ctx);
+}
+
+static void Led_EnterBreathe(void *ctx)
+{
+    (void)ctx;
+    LedSeq_Stop(LED_CH_LD2, 0);
+    (void)LedPwm_Play(led_wave_breathe, LED_WAVE_BREATHE_LEN, 1);
+}
+
+static void Led_EnterFadeIn(void *ctx)
+{
+    (void)ctx;
+    LedSeq_Stop(LED_CH_LD2, 0);
+    (void)LedPwm_Play(led_wave_fade_in, LED_WAVE_FADE_LEN, 0);
+}
+
+static void Led_EnterFadeOut(void *ctx)
+{
+    (void)ctx;
+    LedSeq_Stop(LED_CH_LD2, 0);
+    (void)LedPwm_Play(led_wave_fade_out, LED_WAVE_FADE_LEN, 0);
+}
+
+static void Led_EnterPattern(void *ctx)
+{
+    (void)ctx;
+    LedSeq_Play(LED_CH_LD2, led_pattern);
+    LedPwm_SetLevel(0U);
+}
+
+/* ===== Tables ===== */
+
+/* every mode is reachable from every mode */
+#define LED_MODE_ROWS                                        \
+    { LED_MODE_OFF,      LED_MODE_OFF,      NULL, NULL },    \
+    { LED_MODE_ON,       LED_MODE_ON,       NULL, NULL },    \
+    { LED_MODE_BLINK,    LED_MODE_BLINK,    NULL, NULL },    \
+    { LED_MODE_DIM,      LED_MODE_DIM,      NULL, NULL },    \
+    { LED_MODE_BREATHE,  LED_MODE_BREATHE,  NULL, NULL },    \
+    { LED_MODE_FADE_IN,  LED_MODE_FADE_IN,  NULL, NULL },    \
+    { LED_MODE_FADE_OUT, LED_MODE_FADE_OUT, NULL, NULL },    \
+    { LED_MODE_PATTERN,  LED_MODE_PATTERN,  NULL, NULL }
+
+static const FsmRow_t led_rows[] = {
+    LED_MODE_ROWS
+};
+
+static const FsmRow_t led_rows_dim[] = {
+    { LED_SIG_LEVEL, FSM_SAME, NULL, Led_ApplyLevel },
+    LED_MODE_ROWS
+};
+
+/* indexed by LedMode_t */
+static const FsmState_t led_states[] = {
+    [LED_MODE_OFF]      = FSM_STATE(led_rows,     Led_EnterOff,     NULL),
+    [LED_MODE_ON]       = FSM_STATE(led_rows,     Led_EnterOn,      NULL),
+    [LED_MODE_BLINK]    = FSM_STATE(led_rows,     Led_EnterBlink,   NULL),
+    [LED_MODE_DIM]      = FSM_STATE(led_rows_dim, Led_EnterDim,     NULL),
+    [LED_MODE_BREATHE]  = FSM_STATE(led_rows,     Led_EnterBreathe, NULL),
+    [LED_MODE_FADE_IN]  = FSM_STATE(led_rows,     Led_EnterFadeIn,  NULL),
+    [LED_MODE_FADE_OUT] = FSM_STATE(led_rows,     Led_EnterFadeOut, NULL),
+    [LED_MODE_PATTERN]  = FSM_STATE(led_rows,     Led_EnterPattern, NULL),
+};
+
+static const FsmDef_t led_fsm = FSM_DEF(led_states, LED_FSM_ID);
 
 void Led_Init(void)
 {
-    led_mode = LED_MODE_OFF;
-    led_tick = 0;
-    HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin, GPIO_PIN_RESET);
+    LedPwm_Init();
+    led_state = Fsm_Start(&led_fsm, LED_MODE_OFF, NULL);
 }
 
 void Led_SetMode(LedMode_t mode)
 {
-    led_mode = mode;
-    led_tick = 0;
-
-    if (mode == LED_MODE_ON) {
-        HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin, GPIO_PIN_SET);
-    }
-    else if (mode == LED_MODE_OFF) {
-        HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin, GPIO_PIN_RESET);
-    }
+    if (mode == LED_MODE_PATTERN)
+        return;             /* only through Led_SetPattern() */
+
+    led_state = Fsm_Dispatch(&led_fsm, led_state, (uint8_t)mode, NULL);
 }
 
-void Led_OnTick(void)
+void Led_SetPattern(const LedSeqPattern_t *pat)
 {
-    if (led_mode != LED_MODE_BLINK)
-        return;
+    led_pattern = pat;
+    led_state = Fsm_Dispatch(&led_fsm, led_state, LED_MODE_PATTERN, NULL);
+}
 
-    if (++led_tick >= (LED_BLINK_PERIOD_MS / SYS_TICK_PERIOD_MS)) {
-        HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
-        led_tick = 0;
-    }
+void Led_SetLevel(uint8_t percent)
+{
+    led_dim_pct = (percent > 100U) ? 100U : percent;
+
+    led_state = Fsm_Dispatch(&led_fsm, led_state, LED_SIG_LEVEL, NULL);
 }
+
 void Led_Process(void)
 {
-	 /* Reserved for future non-tick-based LED logic */
+	 /* Reserved for future non-timer LED logic */
 }
@@ -0,0 +1,90 @@
+/*
+ * PWM LED backend module
+ *
+ * TIM3 channel 3 PWM with DMA-fed duty, see led_pwm.h.
+ *
+ * Responsibilities:
+ *  - keep the TIM3_CH3 PWM output running from init on
+ *  - switch CCR3 ownership between the CPU (static level) and
+ *    DMA1 Channel 2 (waveform)
+ *
+ * Design principles:
+ *  - HAL_TIM_PWM_Start_DMA enables the DMA half / complete
+ *    interrupts: both are masked right after the start, a
+ *    waveform costs no interrupt at all, not even per pass
+ *  - without the complete interrupt the HAL channel state stays
+ *    BUSY, so every switch goes through the matching Stop call
+ *  - DMA reads bytes and writes halfwords (zero-extended into
+ *    CCR3): one table byte per PWM period
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "led_pwm.h"
+#include "led_wave.h"
+#include "main.h"
+#include "tim.h"
+
+static uint8_t led_pwm_dma;         /* 1 = a waveform owns CCR3 */
+
+void LedPwm_Init(void)
+{
+    led_pwm_dma = 0;
+    __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_3, 0U);
+    if (HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_3) != HAL_OK)
+        Error_Handler();
+}
+
+void LedPwm_SetLevel(uint8_t duty)
+{
+    if (!led_pwm_dma) {
+        __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_3, duty);
+        return;
+    }
+
+    (void)HAL_TIM_PWM_Stop_DMA(&htim3, TIM_CHANNEL_3);
+    led_pwm_dma = 0;
+    __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_3, duty);
+    (void)HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_3);
+}
+
+uint8_t LedPwm_Play(const uint8_t *wave, uint32_t len, uint8_t loop)
+{
+    DMA_HandleTypeDef *hdma = htim3.hdma[TIM_DMA_ID_CC3];
+
+    if (wave == NULL || len == 0U || len > 0xFFFFU)
+        return 0;
+
+    if (led_pwm_dma)
+        (void)HAL_TIM_PWM_Stop_DMA(&htim3, TIM_CHANNEL_3);
+    else
+        (void)HAL_TIM_PWM_Stop(&htim3, TIM_CHANNEL_3);
+    led_pwm_dma = 0;
+
+    hdma->Init.Mode = loop ? DMA_CIRCULAR : DMA_NORMAL;
+    if (HAL_DMA_Init(hdma) != HAL_OK ||
+        HAL_TIM_PWM_Start_DMA(&htim3, TIM_CHANNEL_3, (const uint32_t *)(const void *)wave,
+                              (uint16_t)len) != HAL_OK) {
+        /* channel back to a dark static level */
+        __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_3, 0U);
+        (void)HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_3);
+        return 0;
+    }
+
+    __HAL_DMA_DISABLE_IT(hdma, DMA_IT_HT | DMA_IT_TC);
+    led_pwm_dma = 1;
+    return 1;
+}
+
+uint8_t LedPwm_Level(void)
+{
+    return (uint8_t)__HAL_TIM_GET_COMPARE(&htim3, TIM_CHANNEL_3);
+}
+
+uint8_t LedPwm_Active(void)
+{
+    if (led_pwm_dma && __HAL_DMA_GET_COUNTER(htim3.hdma[TIM_DMA_ID_CC3]) != 0U)
+        return 1;
+
+    return LedPwm_Level() != 0U;
+}
@@ -0,0 +1,190 @@
+/*
+ * LED sequencer module
+ *
+ * Pattern playback for GPIO LEDs, see led_seq.h for the format.
+ *
+ * Responsibilities:
+ *  - built-in pattern tables (blink, heartbeat, SOS, fault codes)
+ *  - per-tick step countdown for every channel
+ *  - start / stop of a channel from the main loop
+ *
+ * Design principles:
+ *  - all durations are tick counts fixed at compile time, the
+ *    tick path has no division and no millisecond arithmetic
+ *  - channels are one contiguous array walked linearly, an idle
+ *    or mid-step channel costs a compare and a decrement
+ *  - one HAL_GPIO_WritePin (a single BSRR store) per step change,
+ *    which keeps the tick consumer within the ISR template rule
+ *  - main-loop writers mask interrupts around the few fields the
+ *    tick also touches
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "led_seq.h"
+#include "main.h"
+#include "ramfunc.h"
+
+#define LED_SEQ_ON_BIT      0x8000U
+#define LED_SEQ_TICKS_MASK  0x7FFFU
+
+/* ===== Built-in patterns ===== */
+
+static const uint16_t led_steps_blink[] = {
+    LED_ON(500U), LED_OFF(500U)
+};
+
+/* double beat, 60 bpm */
+static const uint16_t led_steps_heartbeat[] = {
+    LED_ON(100U), LED_OFF(150U), LED_ON(100U), LED_OFF(650U)
+};
+
+/* 150 ms unit: dot 1, dash 3, element gap 1, letter gap 3, word gap 7 */
+static const uint16_t led_steps_sos[] = {
+    LED_ON(150U), LED_OFF(150U), LED_ON(150U), LED_OFF(150U), LED_ON(150U), LED_OFF(450U),
+    LED_ON(450U), LED_OFF(150U), LED_ON(450U), LED_OFF(150U), LED_ON(450U), LED_OFF(450U),
+    LED_ON(150U), LED_OFF(150U), LED_ON(150U), LED_OFF(150U), LED_ON(150U)
+};
+
+/* one blink of a fault code, repeated n times per cycle */
+static const uint16_t led_steps_code[] = {
+    LED_ON(200U), LED_OFF(300U)
+};
+
+#define LED_SEQ_CODE_GAP_MS 1500U
+#define LED_SEQ_CODE(n)     LED_SEQ_PATTERN(led_steps_code, (n), LED_SEQ_CODE_GAP_MS)
+
+const LedSeqPattern_t led_pat_blink     = LED_SEQ_PATTERN(led_steps_blink, 1U, 0U);
+const LedSeqPattern_t led_pat_heartbeat = LED_SEQ_PATTERN(led_steps_heartbeat, 1U, 0U);
+const LedSeqPattern_t led_pat_sos       = LED_SEQ_PATTERN(led_steps_sos, 1U, 1050U);
+
+const LedSeqPattern_t led_pat_code[LED_SEQ_CODES] = {
+    LED_SEQ_CODE(1U),  LED_SEQ_CODE(2U),  LED_SEQ_CODE(3U),  LED_SEQ_CODE(4U),
+    LED_SEQ_CODE(5U),  LED_SEQ_CODE(6U),  LED_SEQ_CODE(7U),  LED_SEQ_CODE(8U),
+    LED_SEQ_CODE(9U),  LED_SEQ_CODE(10U), LED_SEQ_CODE(11U), LED_SEQ_CODE(12U)
+};
+
+/* ===== Channels ===== */
+
+static LedSeqChan_t *seq_chans;
+static uint32_t      seq_count;
+
+static void LedSeq_Output(LedSeqChan_t *ch, uint8_t on)
+{
+    HAL_GPIO_WritePin((GPIO_TypeDef *)ch->port, ch->pin, on ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
+
+/* load the current step: pin level and its length */
+static void LedSeq_Load(LedSeqChan_t *ch)
+{
+    const LedSeqPattern_t *pat = ch->pat;
+    uint16_t s;
+
+    if (ch->step < pat->len) {
+        s = pat->steps[ch->step];
+        ch->left = (uint16_t)(s & LED_SEQ_TICKS_MASK);
+        LedSeq_Output(ch, (s & LED_SEQ_ON_BIT) != 0U);
+    } else {
+        ch->left = pat->gap;            /* gap: LED off */
+        LedSeq_Output(ch, 0);
+    }
+}
+
+/* current step ended: step table, `count` passes, then the gap */
+static void LedSeq_Next(LedSeqChan_t *ch)
+{
+    const LedSeqPattern_t *pat = ch->pat;
+
+    ch->step++;
+    if (ch->step == pat->len) {
+        if (++ch->pass < pat->count) {
+            ch->step = 0;
+        } else if (pat->gap == 0U) {
+            ch->pass = 0;
+            ch->step = 0;
+        }
+        /* else: step == len plays the gap */
+    } else if (ch->step > pat->len) {
+        ch->pass = 0;
+        ch->step = 0;
+    }
+
+    LedSeq_Load(ch);
+}
+
+void LedSeq_Init(LedSeqChan_t *chans, uint32_t count)
+{
+    seq_chans = chans;
+    seq_count = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        chans[i].pat  = NULL;
+        chans[i].left = 0;
+        chans[i].step = 0;
+        chans[i].pass = 0;
+        LedSeq_Output(&chans[i], 0);
+    }
+
+    seq_count = count;
+}
+
+void LedSeq_Play(uint32_t ch, const LedSeqPattern_t *pat)
+{
+    uint32_t primask;
+    LedSeqChan_t *c;
+
+    if (ch >= seq_count || pat == NULL || pat->len == 0U || pat->count == 0U)
+        return;
+
+    c = &seq_chans[ch];
+    primask = __get_PRIMASK();
+    __disable_irq();
+    c->pat  = pat;
+    c->step = 0;
+    c->pass = 0;
+    LedSeq_Load(c);
+    __set_PRIMASK(primask);
+}
+
+void LedSeq_Stop(uint32_t ch, uint8_t on)
+{
+    uint32_t primask;
+    LedSeqChan_t *c;
+
+    if (ch >= seq_count)
+        return;
+
+    c = &seq_chans[ch];
+    primask = __get_PRIMASK();
+    __disable_irq();
+    c->pat  = NULL;
+    c->left = 0;
+    LedSeq_Output(c, on);
+    __set_PRIMASK(primask);
+}
+
+RAMFUNC void LedSeq_OnTick(void)
+{
+    LedSeqChan_t *ch  = seq_chans;
+    LedSeqChan_t *end = seq_chans + seq_count;
+
+    for (; ch != end; ch++) {
+        if (ch->left == 0U || --ch->left != 0U)
+            continue;               /* idle, or step still running */
+        LedSeq_Next(ch);
+    }
+}
+
+uint32_t LedSeq_NextDeadlineMs(void)
+{
+    uint32_t min = LED_SEQ_NO_DEADLINE;
+
+    for (uint32_t i = 0; i < seq_count; i++) {
+        uint32_t left = seq_chans[i].left;
+
+        if (left != 0U && left * TICK_PERIOD_MS < min)
+            min = left * TICK_PERIOD_MS;
+    }
+
+    return min;
+}
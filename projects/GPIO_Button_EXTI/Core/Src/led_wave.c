@@ -0,0 +1,124 @@
+/*
+ * LED brightness waveforms, see led_wave.h
+ *
+ * GENERATED by Sim/Tools/led_wavegen.c (make wave), do not edit.
+ * gamma 2.2, 256-step duty, 2 ms per sample
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "led_wave.h"
+
+const uint8_t led_wave_breathe[LED_WAVE_BREATHE_LEN] = {
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   1,
+     1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+     1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,
+     2,   2,   3,   3,   3,   3,   3,   3,   3,   3,   3,   3,   4,   4,   4,   4,
+     4,   4,   4,   5,   5,   5,   5,   5,   5,   5,   6,   6,   6,   6,   6,   6,
+     7,   7,   7,   7,   7,   8,   8,   8,   8,   9,   9,   9,   9,  10,  10,  10,
+    10,  11,  11,  11,  11,  12,  12,  12,  12,  13,  13,  13,  14,  14,  14,  15,
+    15,  15,  16,  16,  16,  17,  17,  17,  18,  18,  19,  19,  19,  20,  20,  21,
+    21,  21,  22,  22,  23,  23,  24,  24,  25,  25,  26,  26,  27,  27,  28,  28,
+    29,  29,  30,  30,  31,  31,  32,  32,  33,  33,  34,  35,  35,  36,  36,  37,
+    38,  38,  39,  39,  40,  41,  41,  42,  43,  43,  44,  45,  45,  46,  47,  47,
+    48,  49,  50,  50,  51,  52,  52,  53,  54,  55,  55,  56,  57,  58,  59,  59,
+    60,  61,  62,  63,  63,  64,  65,  66,  67,  68,  68,  69,  70,  71,  72,  73,
+    74,  75,  76,  76,  77,  78,  79,  80,  81,  82,  83,  84,  85,  86,  87,  88,
+    89,  89,  90,  91,  92,  93,  94,  95,  96,  97,  98,  99, 100, 101, 102, 103,
+   104, 105, 106, 107, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119, 120,
+   121, 122, 123, 124, 125, 126, 128, 129, 130, 131, 132, 133, 134, 135, 136, 137,
+   138, 139, 140, 142, 143, 144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 155,
+   156, 157, 158, 159, 160, 161, 162, 163, 164, 165, 166, 167, 168, 170, 171, 172,
+   173, 174, 175, 176, 177, 178, 179, 180, 181, 182, 183, 184, 185, 186, 187, 188,
+   189, 190, 191, 192, 193, 194, 195, 196, 197, 198, 199, 200, 201, 202, 203, 204,
+   204, 205, 206, 207, 208, 209, 210, 211, 212, 213, 213, 214, 215, 216, 217, 218,
+   218, 219, 220, 221, 222, 222, 223, 224, 225, 225, 226, 227, 228, 228, 229, 230,
+   230, 231, 232, 232, 233, 234, 234, 235, 236, 236, 237, 238, 238, 239, 239, 240,
+   240, 241, 241, 242, 243, 243, 244, 244, 244, 245, 245, 246, 246, 247, 247, 248,
+   248, 248, 249, 249, 249, 250, 250, 250, 251, 251, 251, 252, 252, 252, 252, 253,
+   253, 253, 253, 253, 254, 254, 254, 254, 254, 254, 254, 255, 255, 255, 255, 255,
+   255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 254, 254,
+   254, 254, 254, 254, 254, 253, 253, 253, 253, 253, 252, 252, 252, 252, 251, 251,
+   251, 250, 250, 250, 249, 249, 249, 248, 248, 248, 247, 247, 246, 246, 245, 245,
+   244, 244, 244, 243, 243, 242, 241, 241, 240, 240, 239, 239, 238, 238, 237, 236,
+   236, 235, 234, 234, 233, 232, 232, 231, 230, 230, 229, 228, 228, 227, 226, 225,
+   225, 224, 223, 222, 222, 221, 220, 219, 218, 218, 217, 216, 215, 214, 213, 213,
+   212, 211, 210, 209, 208, 207, 206, 205, 204, 204, 203, 202, 201, 200, 199, 198,
+   197, 196, 195, 194, 193, 192, 191, 190, 189, 188, 187, 186, 185, 184, 183, 182,
+   181, 180, 179, 178, 177, 176, 175, 174, 173, 172, 171, 170, 168, 167, 166, 165,
+   164, 163, 162, 161, 160, 159, 158, 157, 156, 155, 153, 152, 151, 150, 149, 148,
+   147, 146, 145, 144, 143, 142, 140, 139, 138, 137, 136, 135, 134, 133, 132, 131,
+   130, 129, 128, 126, 125, 124, 123, 122, 121, 120, 119, 118, 117, 116, 115, 114,
+   113, 112, 111, 110, 109, 107, 106, 105, 104, 103, 102, 101, 100,  99,  98,  97,
+    96,  95,  94,  93,  92,  91,  90,  89,  89,  88,  87,  86,  85,  84,  83,  82,
+    81,  80,  79,  78,  77,  76,  76,  75,  74,  73,  72,  71,  70,  69,  68,  68,
+    67,  66,  65,  64,  63,  63,  62,  61,  60,  59,  59,  58,  57,  56,  55,  55,
+    54,  53,  52,  52,  51,  50,  50,  49,  48,  47,  47,  46,  45,  45,  44,  43,
+    43,  42,  41,  41,  40,  39,  39,  38,  38,  37,  36,  36,  35,  35,  34,  33,
+    33,  32,  32,  31,  31,  30,  30,  29,  29,  28,  28,  27,  27,  26,  26,  25,
+    25,  24,  24,  23,  23,  22,  22,  21,  21,  21,  20,  20,  19,  19,  19,  18,
+    18,  17,  17,  17,  16,  16,  16,  15,  15,  15,  14,  14,  14,  13,  13,  13,
+    12,  12,  12,  12,  11,  11,  11,  11,  10,  10,  10,  10,   9,   9,   9,   9,
+     8,   8,   8,   8,   7,   7,   7,   7,   7,   6,   6,   6,   6,   6,   6,   5,
+     5,   5,   5,   5,   5,   5,   4,   4,   4,   4,   4,   4,   4,   3,   3,   3,
+     3,   3,   3,   3,   3,   3,   3,   2,   2,   2,   2,   2,   2,   2,   2,   2,
+     2,   2,   2,   2,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+     1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+const uint8_t led_wave_fade_in[LED_WAVE_FADE_LEN] = {
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+     1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   3,
+     3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,   7,
+     7,   7,   7,   8,   8,   8,   9,   9,  10,  10,  10,  11,  11,  12,  12,  12,
+    13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,  20,  20,
+    21,  22,  22,  23,  23,  24,  25,  25,  26,  27,  27,  28,  29,  29,  30,  31,
+    31,  32,  33,  34,  34,  35,  36,  37,  37,  38,  39,  40,  41,  41,  42,  43,
+    44,  45,  46,  47,  48,  48,  49,  50,  51,  52,  53,  54,  55,  56,  57,  58,
+    59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  70,  71,  72,  73,  74,  75,
+    76,  78,  79,  80,  81,  82,  84,  85,  86,  87,  89,  90,  91,  92,  94,  95,
+    96,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 112, 113, 114, 116, 117,
+   119, 120, 122, 123, 125, 126, 128, 130, 131, 133, 134, 136, 137, 139, 141, 142,
+   144, 146, 147, 149, 151, 152, 154, 156, 157, 159, 161, 163, 164, 166, 168, 170,
+   172, 173, 175, 177, 179, 181, 183, 185, 187, 188, 190, 192, 194, 196, 198, 200,
+   202, 204, 206, 208, 210, 212, 214, 216, 218, 220, 222, 225, 227, 229, 231, 233,
+   235, 237, 239, 242, 244, 246, 248, 251, 253, 255,
+};
+
+const uint8_t led_wave_fade_out[LED_WAVE_FADE_LEN] = {
+   255, 253, 251, 248, 246, 244, 242, 239, 237, 235, 233, 231, 229, 227, 225, 222,
+   220, 218, 216, 214, 212, 210, 208, 206, 204, 202, 200, 198, 196, 194, 192, 190,
+   188, 187, 185, 183, 181, 179, 177, 175, 173, 172, 170, 168, 166, 164, 163, 161,
+   159, 157, 156, 154, 152, 151, 149, 147, 146, 144, 142, 141, 139, 137, 136, 134,
+   133, 131, 130, 128, 126, 125, 123, 122, 120, 119, 117, 116, 114, 113, 112, 110,
+   109, 107, 106, 105, 103, 102, 100,  99,  98,  96,  95,  94,  92,  91,  90,  89,
+    87,  86,  85,  84,  82,  81,  80,  79,  78,  76,  75,  74,  73,  72,  71,  70,
+    68,  67,  66,  65,  64,  63,  62,  61,  60,  59,  58,  57,  56,  55,  54,  53,
+    52,  51,  50,  49,  48,  48,  47,  46,  45,  44,  43,  42,  41,  41,  40,  39,
+    38,  37,  37,  36,  35,  34,  34,  33,  32,  31,  31,  30,  29,  29,  28,  27,
+    27,  26,  25,  25,  24,  23,  23,  22,  22,  21,  20,  20,  19,  19,  18,  18,
+    17,  17,  16,  16,  15,  15,  14,  14,  13,  13,  12,  12,  12,  11,  11,  10,
+    10,  10,   9,   9,   8,   8,   8,   7,   7,   7,   7,   6,   6,   6,   5,   5,
+     5,   5,   4,   4,   4,   4,   3,   3,   3,   3,   3,   2,   2,   2,   2,   2,
+     2,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+const uint8_t led_gamma[LED_GAMMA_LEN] = {
+     0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   2,   2,   2,   3,   3,   4,
+     5,   5,   6,   7,   7,   8,   9,  10,  11,  12,  13,  14,  15,  17,  18,  19,
+    21,  22,  24,  25,  27,  29,  30,  32,  34,  36,  38,  40,  42,  44,  46,  48,
+    51,  53,  55,  58,  60,  63,  66,  68,  71,  74,  77,  80,  83,  86,  89,  92,
+    96,  99, 102, 106, 109, 113, 116, 120, 124, 128, 131, 135, 139, 143, 148, 152,
+   156, 160, 165, 169, 174, 178, 183, 188, 192, 197, 202, 207, 212, 217, 223, 228,
+   233, 238, 244, 249, 255,
+};
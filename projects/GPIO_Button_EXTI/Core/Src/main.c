@@ -18,11 +18,19 @@
 /* USER CODE END Header */
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
+#include "dma.h"
 #include "tim.h"
 #include "usart.h"
 #include "gpio.h"
-#include "button_fsm.h"
-#include "led_fsm.h"
+#include "app.h"
+#include "isr_prof.h"
+#include "tick.h"
+#include "idle.h"
+#include "uart_log.h"
+#include "ram_mon.h"
+#include "boot.h"
+#include "ramfunc.h"
+#include "clk_mgr.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 
@@ -46,8 +54,7 @@
 /* Private variables ---------------------------------------------------------*/
 
 /* USER CODE BEGIN PV */
-ButtonCtx_t btn_user;
-ButtonCtx_t btn_aux;
+
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -58,6 +65,30 @@ void SystemClock_Config(void);
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+static void Main_IsrProfPeriod(void)
+{
+  /* TIM2 kernel clock == HCLK at both clock levels (clk_mgr.h) */
+  IsrProf_SetPeriod(ISR_PROF_TIM2, (htim2.Init.Prescaler + 1U) * (htim2.Init.Period + 1U));
+}
+
+/* profiler calibration and period, not needed for the first event */
+static void Main_IsrProfInit(void)
+{
+  IsrProf_Init();
+  Main_IsrProfPeriod();
+}
+
+/* cycle-based statistics do not survive a SYSCLK change */
+static void Main_OnClock(ClkMgrPhase_t phase, ClkLevel_t level)
+{
+  (void)level;
+  if (phase != CLK_MGR_POST)
+    return;
+  Idle_ResetStats();
+  IsrProf_Reset();
+  Main_IsrProfPeriod();
+}
+
 /*
  * === STM32 BASIC TEMPLATE ===
  * - Event-driven architecture
@@ -68,20 +99,10 @@ void SystemClock_Config(void);
  *
  * Project: GPIO_Button_EXTI
  * Source event: EXTI (USER BUTTON)
+ *
+ * Application logic lives in app.c (App_Init / App_Process),
+ * so the superloop body can also run in the host simulation.
  */
-/* Application-level LED state (decoupled from LED FSM internals) */
-static LedMode_t app_led_mode = LED_MODE_OFF;
-static uint8_t UserButton_Read(void)
-{
-    /* кнопка активна по LOW */
-    return (HAL_GPIO_ReadPin(USER_BUTTON_GPIO_Port, USER_BUTTON_Pin) == GPIO_PIN_RESET);
-}
-
-uint8_t AuxButton_Read(void)
-{
-
-	return 0;
-}
 /* USER CODE END 0 */
 
 /**
@@ -92,7 +113,7 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
-
+  Boot_Mark(BOOT_LIBC);
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -101,60 +122,62 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
-
+  Boot_Mark(BOOT_HAL);
   /* USER CODE END Init */
 
   /* Configure the system clock */
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
-
+  Boot_Mark(BOOT_CLOCK);
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
   MX_TIM2_Init();
+  MX_TIM3_Init();
+  MX_TIM4_Init();
   /* USER CODE BEGIN 2 */
+  Boot_Mark(BOOT_MX);
+  MX_PanelKeys_Init();
+  MX_CapButton_Init();
+  Log_Init();
+  RamMon_Init();
+  App_Init();
+#if BOOT_FAST_START
+  Boot_Defer(Main_IsrProfInit);
+  Boot_Defer(App_InitLate);
+#else
+  Main_IsrProfInit();
+  App_InitLate();
+#endif
+#if TICK_BENCH_ENABLE
+  Tick_BenchReport();
+#endif
+#if RAMFUNC_BENCH_ENABLE
+  RamFunc_BenchReport();
+#endif
   HAL_TIM_Base_Start_IT(&htim2);
-  Button_Init(&btn_user, UserButton_Read);
-  Button_Init(&btn_aux,  AuxButton_Read);
-  Led_Init();
+  Idle_Init();
+  ClkMgr_Init();
+  ClkMgr_Register(Main_OnClock);
+  Boot_Mark(BOOT_APP);
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-      Button_Process(&btn_user);
-      Button_Process(&btn_aux);
-      Led_Process();
-      switch (Button_GetEvent(&btn_user)) {
-          case BTN_EVENT_SHORT:
-        	  if (app_led_mode == LED_MODE_OFF)
-        	              {app_led_mode = LED_MODE_BLINK;}
-        	          else
-        	              {app_led_mode = LED_MODE_OFF;}
-        	  	  	  Led_SetMode(app_led_mode);
-        	          break;
-
-          case BTN_EVENT_LONG:
-        	  app_led_mode = LED_MODE_ON;
-        	  Led_SetMode(app_led_mode);
-              break;
-          default:
-              break;
-      }
-
-      switch (Button_GetEvent(&btn_aux)) {
-          case BTN_EVENT_SHORT:
-              // логика AUX кнопки
-              break;
-          default:
-              break;
-      	  }
-  	  }
-
+      App_Process();
+      Boot_Poll();
+      IsrProf_Poll();
+      Idle_Poll();
+      RamMon_Poll();
+      ClkMgr_Poll();
+      Idle_Run(App_NextDeadlineMs);
+  }
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -201,24 +224,6 @@ void SystemClock_Config(void)
 }
 
 /* USER CODE BEGIN 4 */
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
-{
-    if (htim->Instance == TIM2)
-    {
-    	//HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin); // DEBUG
-    	Button_OnTick(&btn_user);
-    	Button_OnTick(&btn_aux);
-    	Led_OnTick();
-    }
-}
-
-void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
-{
-    if (GPIO_Pin == USER_BUTTON_Pin) {
-        Button_OnExti(&btn_user);
-    }
-}
-
 
 /* USER CODE END 4 */
 
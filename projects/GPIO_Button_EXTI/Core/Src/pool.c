@@ -0,0 +1,167 @@
+/*
+ * Memory pool module
+ *
+ * Fixed-block size classes with allocation bitmaps, see pool.h.
+ *
+ * Responsibilities:
+ *  - static storage for every class of POOL_CLASSES
+ *  - hand out / take back blocks, spill to larger classes
+ *  - per-class usage, high-water and failure counters
+ *  - count the newlib heap requests that _sbrk refused
+ *
+ * Design principles:
+ *  - the bitmap is the only allocator state: no free list inside
+ *    the blocks, so a write after free cannot corrupt the pool and
+ *    a double free is seen (bit already clear)
+ *  - the search is bounded by the number of classes, never by the
+ *    number of blocks: constant time at any fill level
+ *  - PRIMASK is held only for the bitmap / counter update
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include <string.h>
+
+#include "pool.h"
+#include "main.h"
+
+typedef struct {
+    uint8_t *base;
+    uint16_t size;
+    uint16_t blocks;
+    uint32_t full;              /* bitmap with every block allocated */
+} PoolClass_t;
+
+#define POOL_CHECK_(size, blocks)                                           \
+    _Static_assert((blocks) >= 1U && (blocks) <= 32U && ((size) % 8U) == 0U, \
+                   "pool class " #size ": 1..32 blocks, size a multiple of 8");
+POOL_CLASSES(POOL_CHECK_)
+
+#define POOL_STORAGE_(size, blocks) \
+    static uint64_t pool_mem_##size[(size) * (blocks) / 8U];
+POOL_CLASSES(POOL_STORAGE_)
+
+#define POOL_CLASS_(size, blocks) \
+    { (uint8_t *)pool_mem_##size, (size), (blocks), (uint32_t)(0xFFFFFFFFULL >> (32U - (blocks))) },
+static const PoolClass_t pool_class[POOL_CLASS_COUNT] = { POOL_CLASSES(POOL_CLASS_) };
+
+static uint32_t    pool_used[POOL_CLASS_COUNT];     /* bit = block allocated */
+static PoolStats_t pool_stats[POOL_CLASS_COUNT];
+static uint32_t    pool_bad_frees;
+static uint32_t    pool_sbrk_refused;
+
+void Pool_Init(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    memset(pool_used, 0, sizeof(pool_used));
+    memset(pool_stats, 0, sizeof(pool_stats));
+    pool_bad_frees = 0;
+    pool_sbrk_refused = 0;
+    __set_PRIMASK(primask);
+}
+
+void *Pool_Alloc(size_t size)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t first = 0;
+
+    while (first < POOL_CLASS_COUNT - 1U && size > pool_class[first].size)
+        first++;
+
+    __disable_irq();
+    if (size <= pool_class[first].size) {
+        for (uint32_t c = first; c < POOL_CLASS_COUNT; c++) {
+            uint32_t free = ~pool_used[c] & pool_class[c].full;
+            PoolStats_t *st = &pool_stats[c];
+            uint32_t bit;
+
+            if (free == 0U)
+                continue;
+
+            bit = (uint32_t)__builtin_ctz(free);
+            pool_used[c] |= 1UL << bit;
+            st->allocs++;
+            if (c != first)
+                st->spills++;
+            if (++st->used > st->high_water)
+                st->high_water = st->used;
+            __set_PRIMASK(primask);
+            return pool_class[c].base + bit * pool_class[c].size;
+        }
+    }
+    pool_stats[first].fails++;
+    __set_PRIMASK(primask);
+    return NULL;
+}
+
+void Pool_Free(void *p)
+{
+    uint32_t primask = __get_PRIMASK();
+    uintptr_t addr = (uintptr_t)p;
+
+    if (p == NULL)
+        return;
+
+    __disable_irq();
+    for (uint32_t c = 0; c < POOL_CLASS_COUNT; c++) {
+        const PoolClass_t *pc = &pool_class[c];
+        uintptr_t off = addr - (uintptr_t)pc->base;
+        uint32_t bit;
+
+        if (addr < (uintptr_t)pc->base || off >= (uintptr_t)pc->size * pc->blocks)
+            continue;
+
+        bit = (uint32_t)(off / pc->size);
+        if (off % pc->size != 0U || (pool_used[c] & (1UL << bit)) == 0U)
+            break;                  /* inside a block / not allocated */
+
+        pool_used[c] &= ~(1UL << bit);
+        pool_stats[c].used--;
+        __set_PRIMASK(primask);
+        return;
+    }
+    pool_bad_frees++;
+    __set_PRIMASK(primask);
+}
+
+uint32_t Pool_ClassCount(void)
+{
+    return POOL_CLASS_COUNT;
+}
+
+void Pool_GetStats(uint32_t cls, PoolStats_t *out)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    if (cls >= POOL_CLASS_COUNT) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+
+    __disable_irq();
+    *out = pool_stats[cls];
+    __set_PRIMASK(primask);
+    out->size   = pool_class[cls].size;
+    out->blocks = pool_class[cls].blocks;
+}
+
+uint32_t Pool_BadFrees(void)
+{
+    return pool_bad_frees;
+}
+
+void Pool_OnSbrk(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    pool_sbrk_refused++;
+    __set_PRIMASK(primask);
+}
+
+uint32_t Pool_SbrkRefused(void)
+{
+    return pool_sbrk_refused;
+}
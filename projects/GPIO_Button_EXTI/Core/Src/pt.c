@@ -0,0 +1,194 @@
+/*
+ * Protothread module
+ *
+ * Cooperative scheduler and wait helpers for the stackless
+ * coroutines of pt.h.
+ *
+ * Responsibilities:
+ *  - keep the list of started tasks
+ *  - resume the tasks whose wait may be over, once per pass
+ *  - deliver signals, arm / test waits
+ *  - idle deadline over all timed and event waits
+ *
+ * Design principles:
+ *  - no stack per task: the continuation is the source line in
+ *    PtTask_t.lc, everything else lives in the task's own struct
+ *  - a task waiting for time or a signal is not called until the
+ *    time or the signal is there; only condition waits are polled
+ *  - signals are the one thing shared with ISRs: set and taken
+ *    inside short PRIMASK sections
+ *  - a pass in which some task moved on asks for another pass
+ *    (deadline 0): a condition that task made true is seen before
+ *    the core sleeps
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "pt.h"
+#include "main.h"
+#include "timebase.h"
+
+static PtTask_t *pt_tasks;
+static uint32_t pt_now;
+static uint8_t pt_progress;         /* last pass resumed a task past a wait */
+
+static uint8_t Pt_Listed(const PtTask_t *t)
+{
+    for (const PtTask_t *i = pt_tasks; i != NULL; i = i->next)
+        if (i == t)
+            return 1;
+    return 0;
+}
+
+void Pt_Init(void)
+{
+    pt_tasks = NULL;
+    pt_progress = 0;
+}
+
+void Pt_Start(PtTask_t *t, PtFn fn)
+{
+    t->fn       = fn;
+    t->lc       = 0;
+    t->wait     = PT_WAIT_YIELD;    /* first resume on the next pass */
+    t->events   = 0;
+    t->mask     = 0;
+    t->got      = 0;
+    t->deadline = 0;
+
+    if (!Pt_Listed(t)) {
+        t->next = pt_tasks;
+        pt_tasks = t;
+    }
+    pt_progress = 1;
+}
+
+void Pt_Stop(PtTask_t *t)
+{
+    t->lc = 0;
+    t->wait = PT_WAIT_DONE;
+}
+
+uint8_t Pt_Running(const PtTask_t *t)
+{
+    return t->wait != PT_WAIT_DONE && Pt_Listed(t);
+}
+
+void Pt_Signal(PtTask_t *t, uint8_t sig)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    if (sig >= 16U)
+        return;
+
+    __disable_irq();
+    t->events |= (uint16_t)(1U << sig);
+    __set_PRIMASK(primask);
+}
+
+void Pt_Clear(PtTask_t *t, uint16_t sigmask)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    t->events &= (uint16_t)~sigmask;
+    __set_PRIMASK(primask);
+}
+
+uint32_t Pt_NowMs(void)
+{
+    return pt_now;
+}
+
+void Pt_Arm(PtTask_t *t, uint8_t wait, uint16_t sigmask, uint32_t at_ms)
+{
+    t->wait     = wait;
+    t->mask     = sigmask;
+    t->deadline = at_ms;
+    t->got      = 0;
+}
+
+uint8_t Pt_Due(const PtTask_t *t)
+{
+    return (int32_t)(pt_now - t->deadline) >= 0;
+}
+
+uint8_t Pt_Take(PtTask_t *t)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    t->got = t->events & t->mask;
+    t->events &= (uint16_t)~t->got;
+    __set_PRIMASK(primask);
+    return t->got != 0U;
+}
+
+/* a timed or event wait is over: the resume is progress for sure */
+static uint8_t Pt_Over(const PtTask_t *t)
+{
+    uint8_t w = t->wait;
+
+    if (w == PT_WAIT_NONE || (w & PT_WAIT_YIELD))
+        return 1;
+    if ((w & PT_WAIT_EVENT) && (t->events & t->mask) != 0U)
+        return 1;
+    return (w & PT_WAIT_TIME) && Pt_Due(t);
+}
+
+void Pt_RunAt(uint32_t now_ms)
+{
+    pt_now = now_ms;
+    pt_progress = 0;
+
+    for (PtTask_t *t = pt_tasks; t != NULL; t = t->next) {
+        uint8_t over;
+        uint16_t lc;
+
+        if (t->wait == PT_WAIT_DONE)
+            continue;
+        over = Pt_Over(t);
+        if (!over && !(t->wait & PT_WAIT_COND))
+            continue;               /* not due, nothing to poll */
+        if (t->wait == PT_WAIT_YIELD)
+            t->wait = PT_WAIT_NONE;
+
+        /* a polled condition counts when the task got past it */
+        lc = t->lc;
+        if (t->fn(t) == PT_DONE || over || t->lc != lc)
+            pt_progress = 1;
+    }
+}
+
+void Pt_Run(void)
+{
+    Pt_RunAt(Timebase_NowMs());
+}
+
+uint32_t Pt_NextDeadlineMs(void)
+{
+    uint32_t next = PT_NO_DEADLINE;
+    uint32_t now = Timebase_NowMs();
+
+    if (pt_progress)
+        return 0;
+
+    for (const PtTask_t *t = pt_tasks; t != NULL; t = t->next) {
+        uint8_t w = t->wait;
+        int32_t left;
+
+        if (w == PT_WAIT_DONE)
+            continue;
+        if ((w & PT_WAIT_YIELD) || w == PT_WAIT_NONE ||
+            ((w & PT_WAIT_EVENT) && (t->events & t->mask) != 0U))
+            return 0;
+        if (w & PT_WAIT_TIME) {
+            left = (int32_t)(t->deadline - now);
+            if (left <= 0)
+                return 0;
+            if ((uint32_t)left < next)
+                next = (uint32_t)left;
+        }
+    }
+    return next;
+}
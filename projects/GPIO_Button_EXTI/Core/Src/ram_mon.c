@@ -0,0 +1,132 @@
+/*
+ * RAM monitor module
+ *
+ * Stack painting readout, guard checks and the RAM / pool summary,
+ * see ram_mon.h.
+ *
+ * Responsibilities:
+ *  - high-water marks of the main (PSP) and exception (MSP) stacks
+ *  - overflow detection on the guard word of each stack
+ *  - static / free RAM from the linker symbols, pool and heap use
+ *  - periodic USART2 report
+ *
+ * Design principles:
+ *  - the paint is laid by Reset_Handler before any C code runs, so
+ *    the marks include the startup and HAL init frames
+ *  - a scan starts at the bottom of a stack and stops at the first
+ *    used word or at the previous mark: the marks only move down,
+ *    painted holes inside used frames do not matter
+ *  - scans read words another context may be writing: a stale read
+ *    only makes a mark one call late, never wrong
+ *
+ * Platform: STM32 (Cortex-M3) + HAL
+ */
+
+#include "ram_mon.h"
+#include "main.h"
+#include "pool.h"
+#include "uart_log.h"
+
+/* linker script symbols */
+extern uint32_t _sdata, _edata, _sramfunc, _eramfunc, _sbss, _ebss, _end;
+extern uint32_t _sstack, _estack_main, _estack;
+
+static const uint32_t *ram_main_mark;       /* lowest used word so far */
+static const uint32_t *ram_isr_mark;
+static uint8_t  ram_overflow;               /* RAM_MON_OVF_* reported */
+static uint32_t ram_last_report_ms;
+
+static const uint32_t *RamMon_Scan(const uint32_t *lo, const uint32_t *mark)
+{
+    const uint32_t *p = lo;
+
+    while (p < mark && *p == RAM_MON_PAINT)
+        p++;
+    return p;
+}
+
+void RamMon_Init(void)
+{
+    ram_main_mark = &_estack_main;
+    ram_isr_mark  = &_estack;
+    ram_overflow  = 0;
+    ram_last_report_ms = HAL_GetTick();
+
+    /* Reset_Handler put thread mode on PSP; without it both marks
+       would describe the MSP */
+    if ((__get_CONTROL() & CONTROL_SPSEL_Msk) == 0U)
+        (void)Log_Printf("ram: main thread on MSP, stack marks invalid\r\n");
+}
+
+uint8_t RamMon_Overflow(void)
+{
+    uint8_t ovf = 0;
+
+    if (_sstack != RAM_MON_PAINT)
+        ovf |= RAM_MON_OVF_MAIN;
+    if (_estack_main != RAM_MON_PAINT)
+        ovf |= RAM_MON_OVF_ISR;
+    return ovf;
+}
+
+void RamMon_GetStats(RamMonStats_t *out)
+{
+    ram_main_mark = RamMon_Scan(&_sstack, ram_main_mark);
+    ram_isr_mark  = RamMon_Scan(&_estack_main, ram_isr_mark);
+
+    out->main_size  = (uint32_t)((uintptr_t)&_estack_main - (uintptr_t)&_sstack);
+    out->main_used  = (uint32_t)((uintptr_t)&_estack_main - (uintptr_t)ram_main_mark);
+    out->isr_size   = (uint32_t)((uintptr_t)&_estack - (uintptr_t)&_estack_main);
+    out->isr_used   = (uint32_t)((uintptr_t)&_estack - (uintptr_t)ram_isr_mark);
+    out->static_ram = (uint32_t)(((uintptr_t)&_edata - (uintptr_t)&_sdata) +
+                                 ((uintptr_t)&_eramfunc - (uintptr_t)&_sramfunc) +
+                                 ((uintptr_t)&_ebss - (uintptr_t)&_sbss));
+    out->free_ram   = (uint32_t)((uintptr_t)&_sstack - (uintptr_t)&_end);
+
+    out->pool_size = 0;
+    out->pool_used = 0;
+    out->pool_high_water = 0;
+    for (uint32_t c = 0; c < Pool_ClassCount(); c++) {
+        PoolStats_t ps;
+
+        Pool_GetStats(c, &ps);
+        out->pool_size       += (uint32_t)ps.size * ps.blocks;
+        out->pool_used       += (uint32_t)ps.size * ps.used;
+        out->pool_high_water += (uint32_t)ps.size * ps.high_water;
+    }
+    out->sbrk_refused = Pool_SbrkRefused();
+    out->overflow     = RamMon_Overflow();
+}
+
+void RamMon_Poll(void)
+{
+    uint8_t ovf = RamMon_Overflow();
+
+    if ((ovf & ~ram_overflow) != 0U) {
+        (void)Log_Printf("ram: stack overflow%s%s\r\n",
+                         (ovf & RAM_MON_OVF_MAIN) ? " main" : "",
+                         (ovf & RAM_MON_OVF_ISR) ? " isr" : "");
+        ram_overflow |= ovf;
+    }
+
+#if RAM_MON_REPORT_PERIOD_MS
+    {
+        RamMonStats_t st;
+        uint32_t now = HAL_GetTick();
+
+        if ((now - ram_last_report_ms) < RAM_MON_REPORT_PERIOD_MS)
+            return;
+        ram_last_report_ms = now;
+
+        RamMon_GetStats(&st);
+        (void)Log_Printf("ram: stack main %lu/%lu isr %lu/%lu B, static %lu free %lu B, "
+                         "pool %lu/%lu hw %lu B, sbrk %lu\r\n",
+                         (unsigned long)st.main_used, (unsigned long)st.main_size,
+                         (unsigned long)st.isr_used, (unsigned long)st.isr_size,
+                         (unsigned long)st.static_ram, (unsigned long)st.free_ram,
+                         (unsigned long)st.pool_used, (unsigned long)st.pool_size,
+                         (unsigned long)st.pool_high_water,
+                         (unsigned long)st.sbrk_refused);
+    }
+#endif
+}
@@ -0,0 +1,108 @@
+/*
+ * RAM-executed functions module
+ *
+ * Per-function cycle bench of the RAMFUNC candidates, see ramfunc.h.
+ *
+ * Responsibilities:
+ *  - call each hot-path function RAMFUNC_BENCH_ROUNDS times under
+ *    DWT->CYCCNT, min / mean / max per function
+ *  - report where each one runs from, so two captures (flash build,
+ *    RAM build) can be compared line by line
+ *
+ * Design principles:
+ *  - the functions are called through pointers: no veneer in the
+ *    measurement, only the body and its own calls
+ *  - the same boot-time conditions as Tick_BenchReport: TIM2 IRQ
+ *    masked, timer not started, consumers really called
+ *  - nothing that queues application events (EXTI is benched with
+ *    no line pending, the queue pair on a private queue)
+ *
+ * Platform: STM32 (Cortex-M3) + HAL
+ */
+
+#include "ramfunc.h"
+#include "main.h"
+
+#if RAMFUNC_BENCH_ENABLE
+
+#include "evq.h"
+#include "stm32f1xx_it.h"
+#include "tick.h"
+#include "tim.h"
+#include "uart_log.h"
+
+typedef struct {
+    const char *name;
+    void      (*fn)(void);
+    const void *where;              /* the function that is placed */
+    uint8_t     set_uif;            /* TIM2 update pending before each call */
+} RamFuncBench_t;
+
+static Event_t    ramfunc_evq_buf[4];
+static EvQueue_t  ramfunc_evq;
+
+static void RamFunc_BenchNop(void)
+{
+}
+
+static void RamFunc_BenchEvQ(void)
+{
+    Event_t e;
+
+    (void)EvQ_Post(&ramfunc_evq, 0, 0);
+    (void)EvQ_Get(&ramfunc_evq, &e);
+}
+
+static const RamFuncBench_t ramfunc_bench[] = {
+    { "probe",                RamFunc_BenchNop,     (const void *)RamFunc_BenchNop,     0 },
+    { "TIM2_IRQHandler",      TIM2_IRQHandler,      (const void *)TIM2_IRQHandler,      1 },
+    { "Tick_Dispatch",        Tick_Dispatch,        (const void *)Tick_Dispatch,        0 },
+    { "EXTI15_10_IRQHandler", EXTI15_10_IRQHandler, (const void *)EXTI15_10_IRQHandler, 0 },
+    { "EvQ_Post+EvQ_Get",     RamFunc_BenchEvQ,     (const void *)EvQ_Post,             0 },
+};
+
+static const char *RamFunc_Where(const void *fn)
+{
+    return (((uintptr_t)fn & 0xF0000000U) == SRAM_BASE) ? "ram" : "flash";
+}
+
+void RamFunc_BenchReport(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    (void)EvQ_Init(&ramfunc_evq, ramfunc_evq_buf, 4U);
+    HAL_NVIC_DisableIRQ(TIM2_IRQn);
+    __HAL_TIM_ENABLE_IT(&htim2, TIM_IT_UPDATE);
+
+    (void)Log_Printf("ramfunc bench (%lu rounds, RAMFUNC_ENABLE %u, cycles min/mean/max)\r\n",
+                     (unsigned long)RAMFUNC_BENCH_ROUNDS, (unsigned)RAMFUNC_ENABLE);
+
+    for (uint32_t b = 0; b < sizeof(ramfunc_bench) / sizeof(ramfunc_bench[0]); b++) {
+        const RamFuncBench_t *rb = &ramfunc_bench[b];
+        uint32_t min = UINT32_MAX, max = 0, sum = 0;
+
+        for (uint32_t i = 0; i < RAMFUNC_BENCH_ROUNDS; i++) {
+            if (rb->set_uif)
+                TIM2->EGR = TIM_EGR_UG;   /* software update event -> UIF */
+
+            uint32_t t0 = DWT->CYCCNT;
+            rb->fn();
+            uint32_t dt = DWT->CYCCNT - t0;
+
+            if (dt < min) min = dt;
+            if (dt > max) max = dt;
+            sum += dt;
+        }
+        (void)Log_Printf("ramfunc: %-22s %-5s %5lu %5lu %5lu\r\n", rb->name,
+                         RamFunc_Where(rb->where), (unsigned long)min,
+                         (unsigned long)(sum / RAMFUNC_BENCH_ROUNDS), (unsigned long)max);
+    }
+
+    __HAL_TIM_DISABLE_IT(&htim2, TIM_IT_UPDATE);
+    __HAL_TIM_CLEAR_IT(&htim2, TIM_IT_UPDATE);
+    HAL_NVIC_ClearPendingIRQ(TIM2_IRQn);
+    HAL_NVIC_EnableIRQ(TIM2_IRQn);
+}
+
+#endif /* RAMFUNC_BENCH_ENABLE */
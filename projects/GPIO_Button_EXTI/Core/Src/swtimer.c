@@ -0,0 +1,251 @@
+/*
+ * Software timer module
+ *
+ * Hierarchical timing wheel, see swtimer.h for the layout.
+ *
+ * Responsibilities:
+ *  - static node pool (free list)
+ *  - O(1) insert / remove into wheel slots
+ *  - per-tick expiry and cascading of upper levels
+ *
+ * Design principles:
+ *  - the ISR only increments a pending-tick counter
+ *  - callbacks run in SwTimer_Process(), may start / stop any
+ *    timer including their own
+ *  - expiry is exact to the tick: a timer started with delay
+ *    d ticks fires on the d-th processed tick
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include <string.h>
+
+#include "swtimer.h"
+#include "main.h"
+#include "ramfunc.h"
+#include "tick.h"
+
+#define SWTIMER_SLOT_MASK   (SWTIMER_SLOTS - 1U)
+#define SWTIMER_RANGE       (1UL << (SWTIMER_LEVELS * SWTIMER_SLOT_BITS))
+
+static SwTimer_t  tmr_pool[SWTIMER_POOL_SIZE];
+static SwTimer_t *tmr_free;
+static SwTimer_t *tmr_wheel[SWTIMER_LEVELS][SWTIMER_SLOTS];
+static uint64_t   tmr_occupied[SWTIMER_LEVELS];
+static uint32_t   tmr_now;          /* last processed wheel tick */
+static uint32_t   tmr_active;
+static volatile uint32_t tmr_pending;
+
+static uint32_t SwTimer_MsToTicks(uint32_t ms)
+{
+    uint32_t ticks = (ms + TICK_PERIOD_MS - 1U) / TICK_PERIOD_MS;
+    return (ticks == 0U) ? 1U : ticks;
+}
+
+static void SwTimer_Link(SwTimer_t *tmr)
+{
+    uint32_t delta = tmr->expires - tmr_now;
+    uint32_t level = 0;
+    uint32_t slot;
+
+    if (delta >= SWTIMER_RANGE)
+        delta = SWTIMER_RANGE - 1U;     /* parked, re-cascaded later */
+
+    while (level < SWTIMER_LEVELS - 1U &&
+           delta >= (1UL << ((level + 1U) * SWTIMER_SLOT_BITS)))
+        level++;
+
+    if (level == SWTIMER_LEVELS - 1U && (tmr->expires - tmr_now) >= SWTIMER_RANGE)
+        slot = ((tmr_now + delta) >> (level * SWTIMER_SLOT_BITS)) & SWTIMER_SLOT_MASK;
+    else
+        slot = (tmr->expires >> (level * SWTIMER_SLOT_BITS)) & SWTIMER_SLOT_MASK;
+
+    tmr->level = (uint8_t)level;
+    tmr->slot  = (uint8_t)slot;
+    tmr->prev  = NULL;
+    tmr->next  = tmr_wheel[level][slot];
+    if (tmr->next != NULL)
+        tmr->next->prev = tmr;
+    tmr_wheel[level][slot] = tmr;
+    tmr_occupied[level] |= 1ULL << slot;
+}
+
+static void SwTimer_Unlink(SwTimer_t *tmr)
+{
+    if (tmr->prev != NULL)
+        tmr->prev->next = tmr->next;
+    else
+        tmr_wheel[tmr->level][tmr->slot] = tmr->next;
+
+    if (tmr->next != NULL)
+        tmr->next->prev = tmr->prev;
+
+    if (tmr_wheel[tmr->level][tmr->slot] == NULL)
+        tmr_occupied[tmr->level] &= ~(1ULL << tmr->slot);
+
+    tmr->next = NULL;
+    tmr->prev = NULL;
+}
+
+/* move one upper-level slot down, nodes land on lower levels */
+static void SwTimer_Cascade(uint32_t level)
+{
+    uint32_t slot = (tmr_now >> (level * SWTIMER_SLOT_BITS)) & SWTIMER_SLOT_MASK;
+    SwTimer_t *tmr;
+
+    while ((tmr = tmr_wheel[level][slot]) != NULL) {
+        SwTimer_Unlink(tmr);
+        SwTimer_Link(tmr);
+    }
+}
+
+static void SwTimer_Advance(void)
+{
+    uint32_t slot;
+    SwTimer_t *tmr;
+
+    tmr_now++;
+
+    /* level 0 wrapped: pull the next slot of each upper level down */
+    for (uint32_t level = 1; level < SWTIMER_LEVELS; level++) {
+        if ((tmr_now & ((1UL << (level * SWTIMER_SLOT_BITS)) - 1U)) != 0U)
+            break;
+        SwTimer_Cascade(level);
+    }
+
+    slot = tmr_now & SWTIMER_SLOT_MASK;
+    while ((tmr = tmr_wheel[0][slot]) != NULL) {
+        SwTimer_Unlink(tmr);
+
+        /* parked long timeout that is not due yet */
+        if (tmr->expires != tmr_now) {
+            SwTimer_Link(tmr);
+            continue;
+        }
+
+        if (tmr->period != 0U) {
+            tmr->expires += tmr->period;
+            SwTimer_Link(tmr);
+        } else {
+            tmr->active = 0;
+            tmr_active--;
+        }
+        tmr->fn(tmr->arg);
+    }
+}
+
+void SwTimer_Init(void)
+{
+    memset(tmr_pool, 0, sizeof(tmr_pool));
+    memset(tmr_wheel, 0, sizeof(tmr_wheel));
+    memset(tmr_occupied, 0, sizeof(tmr_occupied));
+    tmr_now     = 0;
+    tmr_active  = 0;
+    tmr_pending = 0;
+
+    tmr_free = NULL;
+    for (uint32_t i = SWTIMER_POOL_SIZE; i > 0U; i--) {
+        tmr_pool[i - 1U].next = tmr_free;
+        tmr_free = &tmr_pool[i - 1U];
+    }
+}
+
+SwTimer_t *SwTimer_Alloc(SwTimerFn fn, void *arg)
+{
+    SwTimer_t *tmr = tmr_free;
+
+    if (tmr == NULL || fn == NULL)
+        return NULL;
+
+    tmr_free = tmr->next;
+    memset(tmr, 0, sizeof(*tmr));
+    tmr->fn     = fn;
+    tmr->arg    = arg;
+    tmr->in_use = 1;
+    return tmr;
+}
+
+void SwTimer_Free(SwTimer_t *tmr)
+{
+    if (tmr == NULL || !tmr->in_use)
+        return;
+
+    SwTimer_Stop(tmr);
+    tmr->in_use = 0;
+    tmr->next   = tmr_free;
+    tmr_free    = tmr;
+}
+
+void SwTimer_Start(SwTimer_t *tmr, uint32_t delay_ms, uint32_t period_ms)
+{
+    SwTimer_Stop(tmr);
+
+    /* ticks already counted by the ISR are not yet in tmr_now */
+    tmr->expires = tmr_now + tmr_pending + SwTimer_MsToTicks(delay_ms);
+    tmr->period  = (period_ms != 0U) ? SwTimer_MsToTicks(period_ms) : 0U;
+    tmr->active  = 1;
+    tmr_active++;
+    SwTimer_Link(tmr);
+}
+
+void SwTimer_Stop(SwTimer_t *tmr)
+{
+    if (!tmr->active)
+        return;
+
+    SwTimer_Unlink(tmr);
+    tmr->active = 0;
+    tmr_active--;
+}
+
+uint8_t SwTimer_IsActive(const SwTimer_t *tmr)
+{
+    return tmr->active;
+}
+
+RAMFUNC void SwTimer_OnTick(void)
+{
+    tmr_pending++;
+}
+
+void SwTimer_Process(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t ticks;
+
+    __disable_irq();
+    ticks = tmr_pending;
+    tmr_pending = 0;
+    __set_PRIMASK(primask);
+
+    while (ticks-- != 0U)
+        SwTimer_Advance();
+}
+
+uint32_t SwTimer_NextDeadlineMs(void)
+{
+    uint32_t from, ticks;
+    uint64_t ahead;
+
+    if (tmr_active == 0U)
+        return SWTIMER_NO_DEADLINE;
+    if (tmr_pending != 0U)
+        return 0;
+
+    /* level-0 slots from the next tick on, rotated to bit 0 */
+    from  = (tmr_now + 1U) & SWTIMER_SLOT_MASK;
+    ahead = (from == 0U) ? tmr_occupied[0]
+                         : (tmr_occupied[0] >> from) | (tmr_occupied[0] << (SWTIMER_SLOTS - from));
+
+    if (ahead != 0U)
+        ticks = (uint32_t)__builtin_ctzll(ahead) + 1U;
+    else
+        ticks = SWTIMER_SLOTS - (tmr_now & SWTIMER_SLOT_MASK);    /* next cascade */
+
+    return ticks * TICK_PERIOD_MS;
+}
+
+uint32_t SwTimer_ActiveCount(void)
+{
+    return tmr_active;
+}
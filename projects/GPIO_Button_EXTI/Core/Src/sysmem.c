@@ -24,6 +24,16 @@
 #include <errno.h>
 #include <stdint.h>
 
+#include "pool.h"
+
+/* 0: no newlib heap, every _sbrk fails with ENOMEM (malloc returns
+   NULL) and is counted by Pool_OnSbrk; dynamic memory comes from
+   the fixed-block pool (pool.h). 1: CubeMX heap, then restore
+   _Min_Heap_Size in the linker script. */
+#ifndef SYSMEM_HEAP_ENABLE
+#define SYSMEM_HEAP_ENABLE  0
+#endif
+
 /**
  * Pointer to the current high watermark of the heap usage
  */
@@ -52,10 +62,16 @@ static uint8_t *__sbrk_heap_end = NULL;
  */
 void *_sbrk(ptrdiff_t incr)
 {
+#if !SYSMEM_HEAP_ENABLE
+  (void)incr;
+  (void)__sbrk_heap_end;
+  Pool_OnSbrk();
+  errno = ENOMEM;
+  return (void *)-1;
+#else
   extern uint8_t _end; /* Symbol defined in the linker script */
-  extern uint8_t _estack; /* Symbol defined in the linker script */
-  extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
-  const uint32_t stack_limit = (uint32_t)&_estack - (uint32_t)&_Min_Stack_Size;
+  extern uint8_t _sstack; /* Symbol defined in the linker script: both stacks above */
+  const uint32_t stack_limit = (uint32_t)&_sstack;
   const uint8_t *max_heap = (uint8_t *)stack_limit;
   uint8_t *prev_heap_end;
 
@@ -65,7 +81,7 @@ void *_sbrk(ptrdiff_t incr)
     __sbrk_heap_end = &_end;
   }
 
-  /* Protect heap from growing into the reserved MSP stack */
+  /* Protect heap from growing into the reserved stacks */
   if (__sbrk_heap_end + incr > max_heap)
   {
     errno = ENOMEM;
@@ -76,4 +92,5 @@ void *_sbrk(ptrdiff_t incr)
   __sbrk_heap_end += incr;
 
   return (void *)prev_heap_end;
+#endif
 }
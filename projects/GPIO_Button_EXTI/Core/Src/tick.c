@@ -0,0 +1,153 @@
+/*
+ * System tick module
+ *
+ * Lean TIM2 update dispatch to a fixed table of tick consumers.
+ *
+ * Responsibilities:
+ *  - keep the registered consumer list (registration at init)
+ *  - fast-path TIM2 IRQ: check / clear UIF only, no HAL handle
+ *  - optional boot-time benchmark against HAL_TIM_IRQHandler
+ *
+ * Design principles:
+ *  - consumer table is a plain array, dispatch is a linear walk
+ *  - registration publishes the entry before the new count,
+ *    so a concurrent ISR never calls an empty slot
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "tick.h"
+#include "main.h"
+#include "ramfunc.h"
+
+#if TICK_BENCH_ENABLE
+#include <stdio.h>
+#include "tim.h"
+#include "uart_log.h"
+#endif
+
+static TickFn tick_consumers[TICK_MAX_CONSUMERS];
+static volatile uint32_t tick_consumer_count = 0;
+
+void Tick_Init(void)
+{
+    tick_consumer_count = 0;
+}
+
+uint8_t Tick_Register(TickFn fn)
+{
+    uint32_t n = tick_consumer_count;
+
+    if (fn == NULL || n >= TICK_MAX_CONSUMERS)
+        return 0;
+
+    tick_consumers[n] = fn;
+    __asm volatile ("" ::: "memory");  /* slot visible before count */
+    tick_consumer_count = n + 1U;
+    return 1;
+}
+
+RAMFUNC void Tick_Dispatch(void)
+{
+    uint32_t n = tick_consumer_count;
+
+    for (uint32_t i = 0; i < n; i++)
+        tick_consumers[i]();
+}
+
+RAMFUNC void Tick_IRQHandler(void)
+{
+    /* TIM2 only enables the update interrupt, so UIF is the only source */
+    if (TIM2->SR & TIM_SR_UIF) {
+        TIM2->SR = ~(uint32_t)TIM_SR_UIF;   /* rc_w0: other flags untouched */
+        Tick_Dispatch();
+    }
+}
+
+#if TICK_BENCH_ENABLE
+
+#define TICK_BENCH_ROUNDS  1000U
+
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;
+} TickBenchStat_t;
+
+static void Tick_BenchNop(void)
+{
+}
+
+static void Tick_BenchHalPath(void)
+{
+    HAL_TIM_IRQHandler(&htim2);
+}
+
+static void Tick_BenchRun(void (*path)(void), uint8_t set_uif, TickBenchStat_t *st)
+{
+    st->min = UINT32_MAX;
+    st->max = 0;
+    st->sum = 0;
+
+    for (uint32_t i = 0; i < TICK_BENCH_ROUNDS; i++) {
+        if (set_uif)
+            TIM2->EGR = TIM_EGR_UG;   /* software update event -> UIF */
+
+        uint32_t t0 = DWT->CYCCNT;
+        path();
+        uint32_t dt = DWT->CYCCNT - t0;
+
+        if (dt < st->min) st->min = dt;
+        if (dt > st->max) st->max = dt;
+        st->sum += dt;
+    }
+}
+
+/*
+ * Runs with the TIM2 IRQ masked and the timer stopped; consumers
+ * are really called, so run it before the application starts
+ * reacting to ticks (right after App_Init).
+ */
+void Tick_BenchReport(void)
+{
+    TickBenchStat_t empty, consumers, hal, fast;
+    char line[160];
+    int len;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    HAL_NVIC_DisableIRQ(TIM2_IRQn);
+    __HAL_TIM_ENABLE_IT(&htim2, TIM_IT_UPDATE);
+
+    Tick_BenchRun(Tick_BenchNop,     0, &empty);
+    Tick_BenchRun(Tick_Dispatch,     0, &consumers);
+    Tick_BenchRun(Tick_BenchHalPath, 1, &hal);
+    Tick_BenchRun(Tick_IRQHandler,   1, &fast);
+
+    __HAL_TIM_DISABLE_IT(&htim2, TIM_IT_UPDATE);
+    __HAL_TIM_CLEAR_IT(&htim2, TIM_IT_UPDATE);
+    HAL_NVIC_ClearPendingIRQ(TIM2_IRQn);
+    HAL_NVIC_EnableIRQ(TIM2_IRQn);
+
+    len = snprintf(line, sizeof(line),
+                   "tick bench (%lu rounds, %lu consumers, cycles min/mean/max)\r\n",
+                   (unsigned long)TICK_BENCH_ROUNDS, (unsigned long)tick_consumer_count);
+    Log_Write(line, (uint32_t)len);
+
+    const struct { const char *name; const TickBenchStat_t *st; } rows[] = {
+        { "probe     ", &empty },
+        { "consumers ", &consumers },
+        { "HAL path  ", &hal },
+        { "fast path ", &fast },
+    };
+    for (uint32_t i = 0; i < sizeof(rows) / sizeof(rows[0]); i++) {
+        len = snprintf(line, sizeof(line), "  %s %5lu %5lu %5lu\r\n", rows[i].name,
+                       (unsigned long)rows[i].st->min,
+                       (unsigned long)(rows[i].st->sum / TICK_BENCH_ROUNDS),
+                       (unsigned long)rows[i].st->max);
+        Log_Write(line, (uint32_t)len);
+    }
+}
+
+#endif /* TICK_BENCH_ENABLE */
@@ -0,0 +1,87 @@
+/*
+ * Timebase module
+ *
+ * 64-bit monotonic time from SysTick, see timebase.h.
+ *
+ * Responsibilities:
+ *  - own the HAL millisecond tick (HAL_IncTick / HAL_GetTick)
+ *  - provide microsecond timestamps without extra interrupts
+ *
+ * Design principles:
+ *  - exactly one counter is incremented per SysTick interrupt
+ *  - a reload that is pending but not yet serviced (ISR masked
+ *    or preempted) is detected via ICSR.PENDSTSET and counted
+ *  - time readers never depend on the number of FSM instances
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "timebase.h"
+#include "main.h"
+
+static volatile uint64_t tb_ms;
+static uint32_t tb_cycles_per_us = 1U;
+
+/* SysTick ISR (HAL weak override) */
+void HAL_IncTick(void)
+{
+    tb_ms += (uint32_t)uwTickFreq;
+}
+
+/* HAL weak override: HAL_Delay and HAL timeouts share the same clock */
+uint32_t HAL_GetTick(void)
+{
+    return (uint32_t)tb_ms;
+}
+
+void Timebase_Init(void)
+{
+    /* call after SystemClock_Config() and after every SYSCLK switch
+       (clk_mgr.c); the ms counter is not reset */
+    tb_cycles_per_us = SystemCoreClock / 1000000U;
+    if (tb_cycles_per_us == 0U)
+        tb_cycles_per_us = 1U;
+}
+
+uint64_t Timebase_NowMs64(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint64_t ms;
+
+    __disable_irq();
+    ms = tb_ms;
+    __set_PRIMASK(primask);
+    return ms;
+}
+
+uint32_t Timebase_NowMs(void)
+{
+    /* 32-bit load is atomic on Cortex-M3 */
+    return (uint32_t)tb_ms;
+}
+
+void Timebase_SkipTicks(uint32_t ticks)
+{
+    tb_ms += (uint64_t)ticks * (uint32_t)uwTickFreq;
+}
+
+uint64_t Timebase_NowUs(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t load, val;
+    uint64_t ms;
+
+    __disable_irq();
+    ms   = tb_ms;
+    load = SysTick->LOAD;
+    val  = SysTick->VAL;
+
+    /* reload already happened but SysTick_Handler is held off */
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        val = SysTick->VAL;
+        ms += (uint32_t)uwTickFreq;
+    }
+    __set_PRIMASK(primask);
+
+    return ms * 1000U + (load - val) / tb_cycles_per_us;
+}
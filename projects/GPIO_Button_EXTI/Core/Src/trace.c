@@ -0,0 +1,28 @@
+/*
+ * Binary trace module
+ *
+ * Backend of the TRACE() macro, see trace.h for the record layout.
+ *
+ * Responsibilities:
+ *  - hand finished records to the USART2 log ring
+ *
+ * Design principles:
+ *  - no formatting on the target: the macro builds the record
+ *    on the stack, this function only queues it
+ *  - a record is queued whole or dropped whole (uart_log rule),
+ *    so the host decoder never sees a torn record
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include "trace.h"
+#include "uart_log.h"
+
+#if TRACE_ENABLE
+
+void Trace_Emit(const uint32_t *words, uint32_t nwords)
+{
+    (void)Log_Write(words, nwords * sizeof(uint32_t));
+}
+
+#endif /* TRACE_ENABLE */
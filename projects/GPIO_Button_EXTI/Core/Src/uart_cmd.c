@@ -0,0 +1,262 @@
+/*
+ * UART command receiver module
+ *
+ * Circular DMA reception and line dispatch for USART2,
+ * see uart_cmd.h.
+ *
+ * Responsibilities:
+ *  - keep ReceiveToIdle DMA running on the circular buffer
+ *  - turn HAL reception events into a free-running byte count
+ *  - find complete lines and hand them to the command table
+ *
+ * Design principles:
+ *  - rx_total (ISR) and scan / line (main loop) are free-running
+ *    byte counts; buffer index = count & CMD_RX_MASK
+ *  - the ISR never touches data, the main loop never touches
+ *    the DMA: the only shared state is rx_total
+ *  - HAL reports positions at half / full buffer, so rx_total is
+ *    exact as long as the ISR runs once per half buffer
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include <string.h>
+
+#include "uart_cmd.h"
+#include "main.h"
+#include "usart.h"
+#include "uart_log.h"
+#include "pool.h"
+
+#define CMD_RX_MASK     (CMD_RX_BUF_SIZE - 1U)
+
+_Static_assert((CMD_RX_BUF_SIZE & CMD_RX_MASK) == 0U && CMD_RX_BUF_SIZE <= 32768U,
+               "CMD_RX_BUF_SIZE must be a power of two that fits the DMA counter");
+
+static uint8_t cmd_rx_buf[CMD_RX_BUF_SIZE];
+
+/* ISR side */
+static volatile uint32_t cmd_rx_total;      /* bytes written by the DMA */
+static volatile uint32_t cmd_resync_at;     /* rx_total after a restart */
+static volatile uint32_t cmd_resyncs;
+static uint32_t cmd_dma_pos;                /* last reported buffer index */
+
+/* main-loop side */
+static uint32_t cmd_scan;                   /* bytes searched for '\n' */
+static uint32_t cmd_line;                   /* start of the current line */
+static uint32_t cmd_resyncs_seen;
+static uint8_t  cmd_skip;                   /* drop bytes up to the next '\n' */
+
+static const CmdEntry_t *cmd_table;
+static uint32_t cmd_count;
+static CmdStats_t cmd_stats;
+
+static void Cmd_StartRx(void)
+{
+    if (HAL_UARTEx_ReceiveToIdle_DMA(&huart2, cmd_rx_buf, CMD_RX_BUF_SIZE) != HAL_OK)
+        cmd_stats.uart_errors++;
+}
+
+void Cmd_Init(const CmdEntry_t *table, uint32_t count)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    cmd_rx_total  = 0;
+    cmd_resync_at = 0;
+    cmd_resyncs   = 0;
+    cmd_dma_pos   = 0;
+    __set_PRIMASK(primask);
+
+    cmd_scan  = 0;
+    cmd_line  = 0;
+    cmd_skip  = 0;
+    cmd_resyncs_seen = 0;
+    cmd_table = table;
+    cmd_count = count;
+    memset(&cmd_stats, 0, sizeof(cmd_stats));
+
+    Cmd_StartRx();
+}
+
+static void Cmd_Help(void)
+{
+    for (uint32_t i = 0; i < cmd_count; i++)
+        (void)Log_Printf("%-8s %s\r\n", cmd_table[i].name, cmd_table[i].help);
+}
+
+/* one line, contiguous: split name / args, call the handler */
+static void Cmd_Exec(const char *line, uint32_t len)
+{
+    uint32_t name_len = 0;
+
+    if (len != 0U && line[len - 1U] == '\r')
+        len--;
+    if (len == 0U)
+        return;
+    cmd_stats.frames++;
+
+    while (name_len < len && line[name_len] != ' ')
+        name_len++;
+
+    const char *args = line + name_len;
+    uint32_t args_len = len - name_len;
+
+    while (args_len != 0U && *args == ' ') {
+        args++;
+        args_len--;
+    }
+
+    for (uint32_t i = 0; i < cmd_count; i++) {
+        if (strncmp(cmd_table[i].name, line, name_len) == 0 &&
+            cmd_table[i].name[name_len] == '\0') {
+            cmd_table[i].fn(args, args_len);
+            return;
+        }
+    }
+
+    if (name_len == 4U && memcmp(line, "help", 4) == 0) {
+        Cmd_Help();
+        return;
+    }
+
+    cmd_stats.unknown++;
+    (void)Log_Printf("ERR unknown '%.*s'\r\n", (int)name_len, line);
+}
+
+/* one complete line without '\n', start = free-running offset */
+static void Cmd_Dispatch(uint32_t start, uint32_t len)
+{
+    uint32_t idx = start & CMD_RX_MASK;
+    uint32_t first = CMD_RX_BUF_SIZE - idx;
+    char *copy;
+
+    if (len > CMD_LINE_MAX) {
+        cmd_stats.too_long++;
+        return;
+    }
+
+    if (len <= first) {
+        Cmd_Exec((const char *)&cmd_rx_buf[idx], len);
+        return;
+    }
+
+    /* a line across the buffer end: scratch copy from the pool */
+    copy = Pool_Alloc(len);
+    if (copy == NULL) {
+        cmd_stats.no_memory++;
+        return;
+    }
+    memcpy(copy, &cmd_rx_buf[idx], first);
+    memcpy(&copy[first], cmd_rx_buf, len - first);
+    cmd_stats.wrap_copies++;
+    Cmd_Exec(copy, len);
+    Pool_Free(copy);
+}
+
+void Cmd_Process(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t total, resync_at, resyncs;
+
+    __disable_irq();
+    total     = cmd_rx_total;
+    resync_at = cmd_resync_at;
+    resyncs   = cmd_resyncs;
+    __set_PRIMASK(primask);
+
+    /* reception restarted at buffer index 0: the open line is gone */
+    if (resyncs != cmd_resyncs_seen) {
+        cmd_resyncs_seen = resyncs;
+        cmd_scan = resync_at;
+        cmd_line = resync_at;
+        cmd_skip = 1;
+    }
+
+    /* DMA lapped the oldest byte still needed: resume in the newer half */
+    if (total - cmd_line > CMD_RX_BUF_SIZE) {
+        cmd_stats.overflows++;
+        cmd_scan = total - CMD_RX_BUF_SIZE / 2U;
+        cmd_line = cmd_scan;
+        cmd_skip = 1;
+    }
+
+    while (cmd_scan != total) {
+        uint32_t idx = cmd_scan & CMD_RX_MASK;
+        uint32_t run = CMD_RX_BUF_SIZE - idx;
+        const uint8_t *nl;
+
+        if (run > total - cmd_scan)
+            run = total - cmd_scan;
+
+        nl = memchr(&cmd_rx_buf[idx], '\n', run);
+        if (nl == NULL) {
+            cmd_scan += run;
+            continue;
+        }
+
+        cmd_scan += (uint32_t)(nl - &cmd_rx_buf[idx]) + 1U;
+        if (!cmd_skip) {
+            Cmd_Dispatch(cmd_line, cmd_scan - 1U - cmd_line);
+
+            /* the view was overwritten while the handler used it */
+            if (cmd_rx_total - cmd_line > CMD_RX_BUF_SIZE)
+                cmd_stats.overflows++;
+        }
+        cmd_skip = 0;
+        cmd_line = cmd_scan;
+    }
+
+    /* partial line: keep it unless it can no longer be a command */
+    if (cmd_skip) {
+        cmd_line = cmd_scan;
+    } else if (cmd_scan - cmd_line > CMD_LINE_MAX) {
+        cmd_stats.too_long++;
+        cmd_skip = 1;
+        cmd_line = cmd_scan;
+    }
+}
+
+uint8_t Cmd_Pending(void)
+{
+    return (cmd_rx_total != cmd_scan) || (cmd_resyncs != cmd_resyncs_seen);
+}
+
+void Cmd_GetStats(CmdStats_t *out)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *out = cmd_stats;
+    out->rx_bytes = cmd_rx_total;
+    __set_PRIMASK(primask);
+}
+
+/*
+ * pos = bytes the DMA has written since the start of the buffer
+ * (RxXferSize / 2 on half transfer, RxXferSize on transfer complete,
+ * anything in between on IDLE).
+ */
+void Cmd_OnRxEvent(uint16_t pos)
+{
+    uint32_t delta = (pos >= cmd_dma_pos) ? (pos - cmd_dma_pos)
+                                          : (pos + CMD_RX_BUF_SIZE - cmd_dma_pos);
+
+    cmd_rx_total += delta;
+    cmd_dma_pos = pos & CMD_RX_MASK;
+}
+
+/* HAL aborted the reception (ORE / FE / NE / DMA): restart at index 0 */
+void Cmd_OnUartError(void)
+{
+    if (huart2.RxState != HAL_UART_STATE_READY)
+        return;     /* TX-side error, reception still running */
+
+    cmd_stats.uart_errors++;
+    cmd_rx_total  = (cmd_rx_total + CMD_RX_MASK) & ~CMD_RX_MASK;
+    cmd_resync_at = cmd_rx_total;
+    cmd_resyncs++;
+    cmd_dma_pos   = 0;
+
+    Cmd_StartRx();
+}
@@ -0,0 +1,170 @@
+/*
+ * UART log module
+ *
+ * Ring buffer + DMA drain for USART2, see uart_log.h.
+ *
+ * Responsibilities:
+ *  - copy log messages into the ring buffer
+ *  - keep exactly one DMA transfer in flight while data is queued
+ *  - count dropped messages and the fill high-water mark
+ *
+ * Design principles:
+ *  - head (write) and tail (released) are free-running byte counts
+ *  - bytes between tail and tail + log_dma_len belong to the DMA
+ *    and are never overwritten
+ *  - the next transfer is started from the TX-complete ISR, the
+ *    main loop does not poll the UART
+ *
+ * Platform: STM32 + HAL
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "uart_log.h"
+#include "main.h"
+#include "usart.h"
+#include "pool.h"
+
+#define LOG_BUF_MASK    (LOG_BUF_SIZE - 1U)
+
+static uint8_t log_buf[LOG_BUF_SIZE];
+static volatile uint32_t log_head;
+static volatile uint32_t log_tail;
+static volatile uint32_t log_dma_len;   /* 0 = DMA idle */
+static LogStats_t log_stats;
+
+/* start the next contiguous chunk; call with interrupts masked */
+static void Log_Kick(void)
+{
+    uint32_t used, start, len;
+
+    if (log_dma_len != 0U)
+        return;
+
+    used = log_head - log_tail;
+    if (used == 0U)
+        return;
+
+    start = log_tail & LOG_BUF_MASK;
+    len   = LOG_BUF_SIZE - start;
+    if (len > used)
+        len = used;
+
+    log_dma_len = len;
+    if (HAL_UART_Transmit_DMA(&huart2, &log_buf[start], (uint16_t)len) != HAL_OK) {
+        log_dma_len = 0;
+        log_stats.dma_errors++;
+        return;
+    }
+    log_stats.dma_chunks++;
+}
+
+void Log_Init(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    log_head    = 0;
+    log_tail    = 0;
+    log_dma_len = 0;
+    memset(&log_stats, 0, sizeof(log_stats));
+    __set_PRIMASK(primask);
+}
+
+uint8_t Log_Write(const void *data, uint32_t len)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t start, first, used;
+
+    if (len == 0U)
+        return 1;
+
+    __disable_irq();
+
+    used = log_head - log_tail;
+    if (len > LOG_BUF_SIZE - used) {
+        log_stats.msgs_dropped++;
+        log_stats.bytes_dropped += len;
+        __set_PRIMASK(primask);
+        return 0;
+    }
+
+    start = log_head & LOG_BUF_MASK;
+    first = LOG_BUF_SIZE - start;
+    if (first > len)
+        first = len;
+    memcpy(&log_buf[start], data, first);
+    memcpy(log_buf, (const uint8_t *)data + first, len - first);
+
+    log_head += len;
+    log_stats.bytes_written += len;
+    if (used + len > log_stats.high_water)
+        log_stats.high_water = used + len;
+
+    Log_Kick();
+    __set_PRIMASK(primask);
+    return 1;
+}
+
+int Log_Printf(const char *fmt, ...)
+{
+    char *line = Pool_Alloc(LOG_LINE_MAX);
+    va_list ap;
+    int len;
+
+    /* format buffer from the pool: no 128 B on the caller's stack */
+    if (line == NULL) {
+        uint32_t primask = __get_PRIMASK();
+
+        __disable_irq();
+        log_stats.msgs_dropped++;
+        __set_PRIMASK(primask);
+        return -1;
+    }
+
+    va_start(ap, fmt);
+    len = vsnprintf(line, LOG_LINE_MAX, fmt, ap);
+    va_end(ap);
+
+    if (len >= 0) {
+        if ((uint32_t)len >= LOG_LINE_MAX)
+            len = (int)LOG_LINE_MAX - 1;    /* truncated line */
+        if (!Log_Write(line, (uint32_t)len))
+            len = -1;
+    }
+    Pool_Free(line);
+    return len;
+}
+
+uint32_t Log_Pending(void)
+{
+    return log_head - log_tail;
+}
+
+void Log_GetStats(LogStats_t *out)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *out = log_stats;
+    __set_PRIMASK(primask);
+}
+
+void Log_OnTxComplete(void)
+{
+    log_tail += log_dma_len;
+    log_dma_len = 0;
+    Log_Kick();
+}
+
+#if LOG_RETARGET_STDIO
+/* newlib stdout / stderr, overrides the weak _write in syscalls.c */
+int _write(int file, char *ptr, int len)
+{
+    (void)file;
+    (void)Log_Write(ptr, (uint32_t)len);
+    return len;
+}
+#endif
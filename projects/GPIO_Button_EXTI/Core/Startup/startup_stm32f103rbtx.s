@@ -44,6 +44,17 @@ defined in linker script */
 .word _sbss
 /* end address for the .bss section. defined in linker script */
 .word _ebss
+/* start address for the initialization values of the .ramfunc section */
+.word _siramfunc
+/* start / end address of the RAM-executed code. defined in linker script */
+.word _sramfunc
+.word _eramfunc
+/* stack reservation: main thread (PSP) below, exceptions (MSP) on top */
+.word _sstack
+.word _estack_main
+
+/* fill word of unused stack, must match RAM_MON_PAINT (ram_mon.h) */
+.equ  StackPaint, 0xA5A5A5A5
 
 .equ  BootRAM, 0xF108F85F
 /**
@@ -60,39 +71,73 @@ defined in linker script */
   .type Reset_Handler, %function
 Reset_Handler:
 
+/* Cycle counter from the first instruction: boot profile (boot.h),
+   ISR profiler, benches. r7 = &DWT->CYCCNT, r8-r11 = phase stamps,
+   all callee-saved across the C calls below */
+  ldr r0, =0xE000EDFC           /* CoreDebug->DEMCR */
+  ldr r1, [r0]
+  orr r1, r1, #0x01000000       /* TRCENA */
+  str r1, [r0]
+  ldr r0, =0xE0001000           /* DWT->CTRL */
+  movs r1, #0
+  str r1, [r0, #4]              /* DWT->CYCCNT */
+  ldr r1, [r0]
+  orr r1, r1, #1                /* CYCCNTENA */
+  str r1, [r0]
+  adds r7, r0, #4
+
 /* Call the clock system initialization function.*/
     bl  SystemInit
+/* HSE + PLL on, the PLL locks during the RAM init (BOOT_FAST_START) */
+    bl  Boot_ClockStart
+  ldr r8, [r7]
 
-/* Copy the data segment initializers from flash to SRAM */
+/* Copy the data segment initializers and the RAM-executed code
+   from flash to SRAM */
   ldr r0, =_sdata
   ldr r1, =_edata
   ldr r2, =_sidata
-  movs r3, #0
-  b LoopCopyDataInit
-
-CopyDataInit:
-  ldr r4, [r2, r3]
-  str r4, [r0, r3]
-  adds r3, r3, #4
-
-LoopCopyDataInit:
-  adds r4, r0, r3
-  cmp r4, r1
-  bcc CopyDataInit
-  
+  bl CopyWords
+  ldr r0, =_sramfunc
+  ldr r1, =_eramfunc
+  ldr r2, =_siramfunc
+  bl CopyWords
+  ldr r9, [r7]
+
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
-  ldr r4, =_ebss
+  ldr r1, =_ebss
   movs r3, #0
-  b LoopFillZerobss
-
-FillZerobss:
-  str  r3, [r2]
-  adds r2, r2, #4
-
-LoopFillZerobss:
-  cmp r2, r4
-  bcc FillZerobss
+  movs r4, #0
+  movs r5, #0
+  movs r6, #0
+  bl FillWords
+
+/* Paint both stacks up to the current SP, for the high-water marks */
+  ldr r2, =_sstack
+  mov r1, sp
+  ldr r3, =StackPaint
+  mov r4, r3
+  mov r5, r3
+  mov r6, r3
+  bl FillWords
+  ldr r10, [r7]
+
+/* Thread mode on PSP (main stack), exceptions stay on MSP */
+  ldr r0, =_estack_main
+  msr psp, r0
+  movs r0, #2
+  msr control, r0
+  isb
+
+/* SYSCLK to the PLL once locked, then hand the stamps over */
+    bl  Boot_ClockSwitch
+  ldr r11, [r7]
+  mov r0, r8
+  mov r1, r9
+  mov r2, r10
+  mov r3, r11
+    bl  Boot_ResetStamps
 
 /* Call static constructors */
     bl __libc_init_array
@@ -101,6 +146,60 @@ LoopFillZerobss:
   bx lr
 .size Reset_Handler, .-Reset_Handler
 
+/* Copy [r0, r1) from r2: four words per transfer, then the
+   remaining words. Word aligned; clobbers r0-r6 */
+  .section .text.CopyWords,"ax",%progbits
+  .type CopyWords, %function
+CopyWords:
+  subs r1, r1, #16
+  b LoopCopyWords4
+
+CopyWords4:
+  ldmia r2!, {r3, r4, r5, r6}
+  stmia r0!, {r3, r4, r5, r6}
+
+LoopCopyWords4:
+  cmp r0, r1
+  bls CopyWords4
+  adds r1, r1, #16
+  b LoopCopyWords
+
+CopyWord:
+  ldr r3, [r2], #4
+  str r3, [r0], #4
+
+LoopCopyWords:
+  cmp r0, r1
+  bcc CopyWord
+  bx lr
+.size CopyWords, .-CopyWords
+
+/* Fill [r2, r1) with r3: r3-r6 hold the pattern, four words per
+   store, then the remaining words. Word aligned; clobbers r1, r2 */
+  .section .text.FillWords,"ax",%progbits
+  .type FillWords, %function
+FillWords:
+  subs r1, r1, #16
+  b LoopFillWords4
+
+FillWords4:
+  stmia r2!, {r3, r4, r5, r6}
+
+LoopFillWords4:
+  cmp r2, r1
+  bls FillWords4
+  adds r1, r1, #16
+  b LoopFillWords
+
+FillWord:
+  str r3, [r2], #4
+
+LoopFillWords:
+  cmp r2, r1
+  bcc FillWord
+  bx lr
+.size FillWords, .-FillWords
+
 /**
  * @brief  This is the code that gets called when the processor receives an
  *         unexpected interrupt.  This simply enters an infinite loop, preserving
@@ -0,0 +1,414 @@
+/*
+ * Host simulation stand-in for Core/Inc/main.h
+ *
+ * Shadows the CubeMX main.h when the application is built
+ * for Linux (Sim/ is searched before Core/Inc). It provides
+ * the small subset of HAL / CMSIS types, register layouts and
+ * pin definitions used by the portable modules, backed by
+ * plain RAM structures in sim_hal.c.
+ *
+ * Pin names and numbers must stay in sync with Core/Inc/main.h.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* ===== CMSIS-style qualifiers ===== */
+#define __IO volatile
+
+/* ===== HAL status ===== */
+typedef enum {
+    HAL_OK = 0,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+/* ===== GPIO ===== */
+typedef struct {
+    __IO uint32_t CRL;
+    __IO uint32_t CRH;
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+    __IO uint32_t BSRR;
+    __IO uint32_t BRR;
+    __IO uint32_t LCKR;
+} GPIO_TypeDef;
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+#define GPIO_PIN_0   ((uint16_t)0x0001)
+#define GPIO_PIN_1   ((uint16_t)0x0002)
+#define GPIO_PIN_2   ((uint16_t)0x0004)
+#define GPIO_PIN_3   ((uint16_t)0x0008)
+#define GPIO_PIN_4   ((uint16_t)0x0010)
+#define GPIO_PIN_5   ((uint16_t)0x0020)
+#define GPIO_PIN_6   ((uint16_t)0x0040)
+#define GPIO_PIN_7   ((uint16_t)0x0080)
+#define GPIO_PIN_8   ((uint16_t)0x0100)
+#define GPIO_PIN_9   ((uint16_t)0x0200)
+#define GPIO_PIN_10  ((uint16_t)0x0400)
+#define GPIO_PIN_11  ((uint16_t)0x0800)
+#define GPIO_PIN_12  ((uint16_t)0x1000)
+#define GPIO_PIN_13  ((uint16_t)0x2000)
+#define GPIO_PIN_14  ((uint16_t)0x4000)
+#define GPIO_PIN_15  ((uint16_t)0x8000)
+#define GPIO_PIN_All ((uint16_t)0xFFFF)
+
+extern GPIO_TypeDef sim_gpioa, sim_gpiob, sim_gpioc, sim_gpiod;
+#define GPIOA (&sim_gpioa)
+#define GPIOB (&sim_gpiob)
+#define GPIOC (&sim_gpioc)
+#define GPIOD (&sim_gpiod)
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+/* ===== EXTI (mask register honored by the edge emulation) ===== */
+typedef struct {
+    __IO uint32_t IMR;
+    __IO uint32_t EMR;
+    __IO uint32_t RTSR;
+    __IO uint32_t FTSR;
+    __IO uint32_t SWIER;
+    __IO uint32_t PR;
+} EXTI_TypeDef;
+
+extern EXTI_TypeDef sim_exti;
+#define EXTI (&sim_exti)
+
+#define __HAL_GPIO_EXTI_CLEAR_IT(pin)  (EXTI->PR = (pin))
+
+/* ===== TIM ===== */
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SMCR;
+    __IO uint32_t DIER;
+    __IO uint32_t SR;
+    __IO uint32_t EGR;
+    __IO uint32_t CCMR1;
+    __IO uint32_t CCMR2;
+    __IO uint32_t CCER;
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t RCR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+    __IO uint32_t CCR3;
+    __IO uint32_t CCR4;
+} TIM_TypeDef;
+
+#define TIM_CR1_CEN   (1UL << 0)
+#define TIM_CR1_URS   (1UL << 2)
+#define TIM_DIER_UIE  (1UL << 0)
+#define TIM_DIER_CC1DE (1UL << 9)
+#define TIM_DIER_CC2DE (1UL << 10)
+#define TIM_DIER_CC3DE (1UL << 11)
+#define TIM_SR_UIF    (1UL << 0)
+#define TIM_EGR_UG    (1UL << 0)
+#define TIM_CCER_CC1E (1UL << 0)
+#define TIM_CCER_CC2E (1UL << 4)
+#define TIM_CCER_CC3E (1UL << 8)
+
+#define TIM_CHANNEL_1     0x00000000U
+#define TIM_CHANNEL_2     0x00000004U
+#define TIM_CHANNEL_3     0x00000008U
+#define TIM_DMA_ID_CC1    ((uint16_t)0x0001)
+#define TIM_DMA_ID_CC2    ((uint16_t)0x0002)
+#define TIM_DMA_ID_CC3    ((uint16_t)0x0003)
+
+/* ===== DMA (channels used by TIM3_CH3, TIM4_CH1 / CH2, see sim_hal.c) ===== */
+#define DMA_NORMAL        0x00000000U
+#define DMA_CIRCULAR      0x00000020U
+#define DMA_IT_TC         0x00000002U
+#define DMA_IT_HT         0x00000004U
+
+typedef struct {
+    uint32_t Mode;
+} DMA_InitTypeDef;
+
+typedef struct {
+    DMA_InitTypeDef Init;
+    __IO uint32_t CNDTR;        /* transfers left, like the channel register */
+    __IO uint32_t IT;           /* enabled TC / HT interrupts */
+} DMA_HandleTypeDef;
+
+#define __HAL_DMA_DISABLE_IT(h, it)  ((h)->IT &= ~(uint32_t)(it))
+#define __HAL_DMA_GET_COUNTER(h)     ((h)->CNDTR)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+
+typedef struct {
+    uint32_t Prescaler;
+    uint32_t Period;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+    TIM_TypeDef *Instance;
+    TIM_Base_InitTypeDef Init;
+    DMA_HandleTypeDef *hdma[7];
+} TIM_HandleTypeDef;
+
+extern TIM_TypeDef sim_tim2, sim_tim3, sim_tim4;
+#define TIM2 (&sim_tim2)
+#define TIM3 (&sim_tim3)
+#define TIM4 (&sim_tim4)
+
+/* TIM4 counts with the virtual clock, the others hold CNT */
+uint32_t Sim_Tim_GetCounter(TIM_HandleTypeDef *htim);
+#define __HAL_TIM_GET_COUNTER(h)         Sim_Tim_GetCounter(h)
+
+/* CPU writes to CCRx are counted, DMA writes are not */
+void Sim_Tim_SetCompare(TIM_HandleTypeDef *htim, uint32_t channel, uint32_t value);
+#define __HAL_TIM_SET_COMPARE(h, ch, v)  Sim_Tim_SetCompare((h), (ch), (v))
+#define __HAL_TIM_GET_COMPARE(h, ch)     ((&(h)->Instance->CCR1)[(ch) >> 2])
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Start_DMA(TIM_HandleTypeDef *htim, uint32_t Channel,
+                                        const uint32_t *pData, uint16_t Length);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop_DMA(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_IC_Start_DMA(TIM_HandleTypeDef *htim, uint32_t Channel,
+                                       uint32_t *pData, uint16_t Length);
+
+/* ===== USART (TX DMA, circular ReceiveToIdle DMA) ===== */
+typedef struct {
+    __IO uint32_t SR;
+    __IO uint32_t DR;
+    __IO uint32_t BRR;
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t CR3;
+    __IO uint32_t GTPR;
+} USART_TypeDef;
+
+typedef struct {
+    uint32_t BaudRate;
+} UART_InitTypeDef;
+
+#define USART_SR_TC   (1UL << 6)
+
+#define HAL_UART_STATE_READY    0x20U
+#define HAL_UART_STATE_BUSY_TX  0x21U
+#define HAL_UART_STATE_BUSY_RX  0x22U
+
+typedef struct {
+    USART_TypeDef   *Instance;
+    UART_InitTypeDef Init;
+    volatile uint32_t gState;
+    volatile uint32_t RxState;
+} UART_HandleTypeDef;
+
+/* BRR for 16x oversampling, as in stm32f1xx_hal_uart.h */
+#define UART_DIV_SAMPLING16(_PCLK_, _BAUD_)     (((_PCLK_) * 25U) / (4U * (_BAUD_)))
+#define UART_DIVMANT_SAMPLING16(_PCLK_, _BAUD_) (UART_DIV_SAMPLING16((_PCLK_), (_BAUD_)) / 100U)
+#define UART_DIVFRAQ_SAMPLING16(_PCLK_, _BAUD_) \
+    ((((UART_DIV_SAMPLING16((_PCLK_), (_BAUD_)) - \
+        (UART_DIVMANT_SAMPLING16((_PCLK_), (_BAUD_)) * 100U)) * 16U) + 50U) / 100U)
+#define UART_BRR_SAMPLING16(_PCLK_, _BAUD_) \
+    (((UART_DIVMANT_SAMPLING16((_PCLK_), (_BAUD_)) << 4U) + \
+      (UART_DIVFRAQ_SAMPLING16((_PCLK_), (_BAUD_)) & 0xF0U)) + \
+     (UART_DIVFRAQ_SAMPLING16((_PCLK_), (_BAUD_)) & 0x0FU))
+
+extern USART_TypeDef sim_usart2;
+#define USART2 (&sim_usart2)
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+
+/* ===== Flash (emulated, see sim_flash.c) ===== */
+#define FLASH_TYPEPROGRAM_HALFWORD  0x01U
+#define FLASH_TYPEERASE_PAGES       0x00U
+#define FLASH_PAGE_SIZE             0x400U
+
+typedef struct {
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t PageAddress;
+    uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+
+/* ===== RCC / FLASH ACR (SYSCLK switch, see sim_hal.c) ===== */
+typedef struct {
+    __IO uint32_t CR;
+    __IO uint32_t CFGR;
+} RCC_TypeDef;
+
+typedef struct {
+    __IO uint32_t ACR;
+} FLASH_TypeDef;
+
+#define RCC_CFGR_SW         0x00000003UL
+#define RCC_CFGR_SW_HSI     0x00000000UL
+#define RCC_CFGR_SW_PLL     0x00000002UL
+#define RCC_CFGR_SWS        0x0000000CUL
+#define RCC_CFGR_SWS_HSI    0x00000000UL
+#define RCC_CFGR_SWS_PLL    0x00000008UL
+#define RCC_CFGR_HPRE       0x000000F0UL
+#define RCC_CFGR_HPRE_DIV1  0x00000000UL
+#define RCC_CFGR_PPRE1      0x00000700UL
+#define RCC_CFGR_PPRE1_DIV1 0x00000000UL
+#define RCC_CFGR_PPRE1_DIV2 0x00000400UL
+#define RCC_CFGR_PPRE2      0x00003800UL
+#define RCC_CFGR_PPRE2_DIV1 0x00000000UL
+
+#define FLASH_ACR_LATENCY   0x00000007UL
+#define FLASH_LATENCY_0     0x00000000UL
+#define FLASH_LATENCY_2     0x00000002UL
+
+#define HSI_VALUE           8000000UL
+
+extern RCC_TypeDef   sim_rcc;
+extern FLASH_TypeDef sim_flash_acr;
+#define RCC   (&sim_rcc)
+#define FLASH (&sim_flash_acr)
+
+/* SW is followed by SWS at once: the switch never times out here */
+void Sim_ModifyReg(volatile uint32_t *reg, uint32_t clear, uint32_t set);
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) Sim_ModifyReg(&(REG), (CLEARMASK), (SETMASK))
+
+/* enum constants, not macros: the boot scenario in sim_main.c
+   compares boot.h with the .ioc by these names */
+enum { RCC_OSCILLATORTYPE_NONE = 0x0U, RCC_OSCILLATORTYPE_HSE = 0x1U };
+enum { RCC_HSE_BYPASS = 0x50000U };
+enum { RCC_HSE_PREDIV_DIV2 = 0x20000U };
+enum { RCC_HSI_ON = 0x1U };
+enum { RCC_PLL_OFF = 0x1U, RCC_PLL_ON = 0x2U };
+enum { RCC_PLLSOURCE_HSE = 0x10000U };
+enum { RCC_PLL_MUL16 = 0x380000U };
+
+typedef struct {
+    uint32_t PLLState;
+    uint32_t PLLSource;
+    uint32_t PLLMUL;
+} RCC_PLLInitTypeDef;
+
+typedef struct {
+    uint32_t OscillatorType;
+    uint32_t HSEState;
+    uint32_t HSEPredivValue;
+    uint32_t HSIState;
+    RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct);
+uint32_t HAL_RCC_GetHCLKFreq(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+void SystemCoreClockUpdate(void);
+
+/* ===== Core intrinsics (single-threaded host: no-ops) ===== */
+static inline void __disable_irq(void) { }
+static inline void __enable_irq(void)  { }
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+#define __DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* ===== SysTick / SCB (time-derived registers, see sim_hal.c) ===== */
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+    __IO uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+    __IO uint32_t CPUID;
+    __IO uint32_t ICSR;
+} SCB_Type;
+
+#define SysTick_CTRL_ENABLE_Msk     (1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk    (1UL << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk  (1UL << 2)
+#define SysTick_LOAD_RELOAD_Msk     0xFFFFFFUL
+
+#define SCB_ICSR_PENDSTSET_Msk  (1UL << 26)
+#define SCB_ICSR_PENDSVSET_Msk  (1UL << 28)
+
+extern SysTick_Type sim_systick;
+extern SCB_Type     sim_scb;
+#define SysTick (&sim_systick)
+#define SCB     (&sim_scb)
+
+uint32_t SysTick_Config(uint32_t ticks);
+
+/* ===== NVIC (priorities have no effect on the host) ===== */
+typedef enum {
+    SysTick_IRQn = -1
+} IRQn_Type;
+
+static inline void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority,
+                                        uint32_t SubPriority)
+{
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+/* ===== PWR: WFI runs the virtual clock to the wakeup (sim_hal.c) ===== */
+#define PWR_MAINREGULATOR_ON    0x00000000U
+#define PWR_SLEEPENTRY_WFI      ((uint8_t)0x01)
+
+void HAL_PWR_EnterSLEEPMode(uint32_t Regulator, uint8_t SLEEPEntry);
+
+/* ===== Core / HAL tick ===== */
+typedef enum {
+    HAL_TICK_FREQ_1KHZ = 1U
+} HAL_TickFreqTypeDef;
+
+extern uint32_t SystemCoreClock;
+extern HAL_TickFreqTypeDef uwTickFreq;
+extern uint32_t uwTickPrio;
+
+uint32_t HAL_GetTick(void);
+void HAL_IncTick(void);
+
+void Error_Handler(void);
+
+/* ===== Board pins (mirror of Core/Inc/main.h) ===== */
+#define USER_BUTTON_Pin GPIO_PIN_13
+#define USER_BUTTON_GPIO_Port GPIOC
+#define USART_TX_Pin GPIO_PIN_2
+#define USART_TX_GPIO_Port GPIOA
+#define USART_RX_Pin GPIO_PIN_3
+#define USART_RX_GPIO_Port GPIOA
+#define LED_Pin GPIO_PIN_5
+#define LED_GPIO_Port GPIOA
+#define LED_PWM_Pin GPIO_PIN_0
+#define LED_PWM_GPIO_Port GPIOB
+#define CAP_BUTTON_Pin GPIO_PIN_6
+#define CAP_BUTTON_GPIO_Port GPIOB
+#define PANEL_KEYS_GPIO_Port GPIOB
+#ifndef PANEL_KEYS_Pins
+#define PANEL_KEYS_Pins 0U
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAIN_H */
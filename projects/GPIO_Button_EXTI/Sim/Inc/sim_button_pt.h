@@ -0,0 +1,33 @@
+/*
+ * Coroutine button (host only)
+ *
+ * Button_OnEdgeAt / Button_ProcessAt rewritten as one protothread
+ * (pt.h), to validate the coroutine layer against the table FSM:
+ * the same gestures come out of straight-line code with no state
+ * enum, the continuation is the only state.
+ *
+ * Works on an ordinary ButtonCtx_t for the profile, the timestamps,
+ * the click count and the event queue; btn->state is not used.
+ * The task runs under the pt.h scheduler: signal an edge, set the
+ * level, then Pt_RunAt(now).
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#ifndef SIM_BUTTON_PT_H_
+#define SIM_BUTTON_PT_H_
+
+#include "button_fsm.h"
+#include "pt.h"
+
+typedef struct {
+    PtTask_t     task;              /* first: the task is the button */
+    ButtonCtx_t *btn;
+    uint32_t     edge_ms;           /* time of the last edge signal */
+    uint8_t      level;             /* input level for the next pass */
+} SimPtButton_t;
+
+void SimPt_ButtonStart(SimPtButton_t *b, ButtonCtx_t *btn);
+void SimPt_ButtonEdge(SimPtButton_t *b, uint32_t t_ms);
+
+#endif /* SIM_BUTTON_PT_H_ */
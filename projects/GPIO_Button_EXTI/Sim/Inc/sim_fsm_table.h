@@ -0,0 +1,24 @@
+/*
+ * Table-driven button FSM (host only)
+ *
+ * The button FSM on the table engine (fsm.h): the same transitions
+ * as the switch in Core/Src/button_fsm.c, as const rows with entry
+ * actions and guards. Held back from the target until it is at
+ * least as fast as the switch; until then it is the candidate of
+ * the equivalence scenario and of the dispatch benchmark.
+ *
+ * Works on an ordinary ButtonCtx_t (Button_Init, profile and
+ * event queue as usual), only the transitions are its own.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#ifndef SIM_FSM_TABLE_H_
+#define SIM_FSM_TABLE_H_
+
+#include "button_fsm.h"
+
+void SimTab_OnEdgeAt(ButtonCtx_t *btn, uint32_t t_ms);
+void SimTab_ProcessAt(ButtonCtx_t *btn, uint32_t now, uint8_t level);
+
+#endif /* SIM_FSM_TABLE_H_ */
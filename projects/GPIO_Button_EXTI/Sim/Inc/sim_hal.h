@@ -0,0 +1,107 @@
+/*
+ * Host simulation control interface
+ *
+ * Drives the HAL shim declared in Sim/Inc/main.h:
+ *  - a deterministic virtual clock (nanosecond resolution)
+ *  - SysTick and TIM2 counters derived from it, driven by their
+ *    registers (LOAD / CTRL, PSC / ARR / CNT / DIER)
+ *  - RCC SYSCLK switch HSI <-> PLL: SystemCoreClock, SysTick and
+ *    the timer clocks follow RCC->CFGR
+ *  - WFI: HAL_PWR_EnterSLEEPMode runs the clock to the next event
+ *    with an enabled interrupt
+ *  - GPIO input injection with EXTI edge emulation
+ *  - PendSV: a pend set during an emulated ISR runs Defer_Run as
+ *    soon as that ISR returns, like the lowest-priority exception
+ *    tail-chaining on the target; the main loop does not run
+ *  - output observation (pin level, toggle counters)
+ *  - USART2 TX DMA: one transfer in flight, completed after
+ *    10 bit times per byte, bytes captured for inspection
+ *  - USART2 RX: the remote end of the wire, bytes injected here
+ *    stream into the circular ReceiveToIdle DMA at the baud rate
+ *  - TIM3_CH3 PWM: DMA1 Channel 2 copies one waveform byte into
+ *    CCR3 per PWM period; CPU writes to CCR3 and DMA interrupts
+ *    that would fire are counted
+ *  - TIM4_CH1 / CH2 input capture on PB6: every edge stamped with
+ *    the 1 MHz counter and stored by the circular capture DMA
+ *  - flash: the settings pages mapped at their target address,
+ *    with NOR program / erase rules, wear counters and
+ *    power-loss injection (sim_flash.c)
+ *
+ * Nothing here depends on wall-clock time, so a given input
+ * script always produces the same event sequence.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#ifndef SIM_HAL_H_
+#define SIM_HAL_H_
+
+#include "main.h"
+
+/* ISR entry stub, replaceable to test alternative IRQ handlers */
+typedef void (*SimIrqFn)(void);
+
+/* ===== Lifecycle ===== */
+void Sim_Reset(void);
+
+/* ===== Virtual clock ===== */
+uint64_t Sim_Clock_NowNs(void);
+uint64_t Sim_Clock_NextEventNs(void);
+void     Sim_Clock_Step(void);               /* jump to next timer event and fire it */
+void     Sim_Clock_AdvanceTo(uint64_t t_ns); /* fire every event up to t_ns */
+void     Sim_Clock_SleepUntil(uint64_t t_ns); /* WFI wakes here at the latest */
+
+/* ===== Interrupt emulation ===== */
+void Sim_SetTim2Irq(SimIrqFn fn);             /* NULL restores HAL-style dispatch */
+void Sim_Exti_Config(GPIO_TypeDef *port, uint16_t pins, uint8_t rising, uint8_t falling);
+
+/* ===== GPIO ===== */
+void          Sim_Gpio_Input(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState level);
+GPIO_PinState Sim_Gpio_Output(GPIO_TypeDef *port, uint16_t pin);
+uint32_t      Sim_Gpio_Toggles(GPIO_TypeDef *port, uint16_t pin);
+
+/* ===== USART2 ===== */
+uint32_t Sim_Uart_Take(uint8_t *out, uint32_t max);    /* captured TX bytes, oldest first */
+uint8_t  Sim_Uart_Busy(void);
+uint32_t Sim_Uart_Rx(const uint8_t *data, uint32_t len);  /* queue bytes on the RX wire */
+uint32_t Sim_Uart_RxQueued(void);                          /* bytes not yet received */
+void     Sim_Uart_RxError(void);                           /* abort reception like ORE */
+
+/* ===== TIM3 PWM LED ===== */
+uint8_t Sim_Pwm_Level(void);                          /* CCR3 */
+
+/* ===== Flash ===== */
+#include <setjmp.h>
+
+#define SIM_FLASH_BASE   0x0801F000UL    /* KVSTORE region of the target */
+#define SIM_FLASH_PAGES  4U
+
+void     Sim_Flash_Blank(void);                      /* factory state, wear counters kept */
+uint32_t Sim_Flash_Erases(uint32_t page);
+uint32_t Sim_Flash_Ops(void);                        /* program + erase operations so far */
+uint32_t Sim_Flash_ProgramErrors(void);              /* programs over non-erased halfwords */
+/* power fails during the n-th next operation (torn), then longjmp(env, 1) */
+void     Sim_Flash_PowerLossAfter(uint32_t n, jmp_buf *env);
+
+/* ===== Statistics ===== */
+typedef struct {
+    uint64_t tim2_updates;
+    uint64_t systicks;
+    uint64_t exti_events;
+    uint64_t uart_dma_chunks;
+    uint64_t uart_tx_bytes;
+    uint64_t uart_rx_bytes;
+    uint64_t uart_rx_events;    /* HT / TC / IDLE callbacks */
+    uint64_t uart_rx_lost;      /* arrived while reception was stopped */
+    uint64_t pwm_dma_steps;     /* CCR3 samples written by DMA */
+    uint64_t pwm_dma_irqs;      /* HT / TC interrupts left enabled */
+    uint64_t pwm_cpu_writes;    /* CCR writes by the CPU */
+    uint64_t cap_dma_edges;     /* TIM4 captures stored by DMA */
+    uint64_t cap_dma_irqs;      /* HT / TC interrupts left enabled */
+    uint64_t pendsv;            /* PendSV exceptions taken */
+    uint64_t sleeps;            /* WFI entries */
+} SimStats_t;
+
+const SimStats_t *Sim_GetStats(void);
+
+#endif /* SIM_HAL_H_ */
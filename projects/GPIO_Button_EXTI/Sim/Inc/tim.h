@@ -0,0 +1,19 @@
+/*
+ * Host simulation stand-in for Core/Inc/tim.h
+ *
+ * Exposes the simulated TIM2, TIM3 and TIM4 handles. The timers
+ * are advanced by the virtual clock in sim_hal.c.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#ifndef __TIM_H__
+#define __TIM_H__
+
+#include "main.h"
+
+extern TIM_HandleTypeDef htim2;
+extern TIM_HandleTypeDef htim3;
+extern TIM_HandleTypeDef htim4;
+
+#endif /* __TIM_H__ */
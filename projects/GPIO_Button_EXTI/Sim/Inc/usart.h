@@ -0,0 +1,18 @@
+/*
+ * Host simulation stand-in for Core/Inc/usart.h
+ *
+ * Exposes the simulated USART2 handle. DMA transmissions are
+ * completed by the virtual clock in sim_hal.c at the configured
+ * baud rate.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#ifndef __USART_H__
+#define __USART_H__
+
+#include "main.h"
+
+extern UART_HandleTypeDef huart2;
+
+#endif /* __USART_H__ */
@@ -0,0 +1,119 @@
+/*
+ * Coroutine button (host only)
+ *
+ * One protothread per button, see sim_button_pt.h. Where the FSM
+ * has a state the coroutine has a wait:
+ *
+ *   IDLE        PT_AWAIT_EVENT        edge
+ *   DEBOUNCE    PT_AWAIT_UNTIL        edge + debounce
+ *   PRESSED     PT_AWAIT_COND_UNTIL   release or press + long
+ *   LONG        PT_AWAIT_COND_UNTIL   release or next repeat
+ *   CLICK_WAIT  PT_AWAIT_EVENT_UNTIL  edge or release + multi
+ *
+ * Edges that the FSM ignores (during debounce or a press) are
+ * cleared before each edge wait. Button_ProcessAt fires at most
+ * one transition per call; the two places where straight-line
+ * code would run ahead of it (overdue repeats, a click window
+ * that closed during a failed debounce) yield once instead.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#include "sim_button_pt.h"
+
+#define SIM_PT_SIG_EDGE     0U
+#define SIM_PT_EDGE         (1U << SIM_PT_SIG_EDGE)
+
+static const ButtonEvent_t sim_pt_click_events[] = {
+    BTN_EVENT_NONE, BTN_EVENT_SHORT, BTN_EVENT_DOUBLE, BTN_EVENT_TRIPLE
+};
+
+static void SimPt_Post(ButtonCtx_t *btn, ButtonEvent_t evt)
+{
+    (void)EvQ_Post(&btn->events, (uint16_t)evt, 0);
+}
+
+static void SimPt_PostClicks(ButtonCtx_t *btn)
+{
+    if (btn->clicks != 0U)
+        SimPt_Post(btn, sim_pt_click_events[btn->clicks]);
+    btn->clicks = 0;
+}
+
+static uint8_t SimPt_ButtonTask(PtTask_t *t)
+{
+    SimPtButton_t *b = (SimPtButton_t *)t;
+    ButtonCtx_t *btn = b->btn;
+    const ButtonProfile_t *p = btn->profile;
+
+    PT_BEGIN(t);
+    for (;;) {
+        Pt_Clear(t, SIM_PT_EDGE);
+        PT_AWAIT_EVENT(t, SIM_PT_EDGE);
+
+        /* one click per round, the next edge inside the window loops */
+        do {
+            btn->debounce_start_ms = b->edge_ms;
+            PT_AWAIT_UNTIL(t, btn->debounce_start_ms + p->debounce_ms);
+
+            if (b->level) {
+                if (btn->clicks != 0U &&
+                    (btn->debounce_start_ms - btn->release_ms) >= p->multi_ms)
+                    SimPt_PostClicks(btn);
+                btn->press_start_ms = Pt_NowMs();
+                PT_AWAIT_COND_UNTIL(t, !b->level, btn->press_start_ms + p->long_ms);
+
+                if (b->level) {
+                    SimPt_PostClicks(btn);
+                    SimPt_Post(btn, BTN_EVENT_LONG);
+                    btn->repeat_ms = Pt_NowMs();
+                    for (;;) {
+                        if (p->repeat_ms != 0U)
+                            PT_AWAIT_COND_UNTIL(t, !b->level, btn->repeat_ms + p->repeat_ms);
+                        else
+                            PT_AWAIT_COND(t, !b->level);
+                        if (!b->level)
+                            break;
+                        SimPt_Post(btn, BTN_EVENT_HOLD_REPEAT);
+                        btn->repeat_ms += p->repeat_ms;
+                        PT_YIELD(t);
+                    }
+                    SimPt_Post(btn, BTN_EVENT_RELEASE);
+                    break;
+                }
+
+                btn->clicks++;
+                if (p->multi_ms == 0U || btn->clicks >= 3U)
+                    break;
+                btn->release_ms = Pt_NowMs();
+                Pt_Clear(t, SIM_PT_EDGE);
+            } else if (btn->clicks == 0U) {
+                break;
+            } else {
+                Pt_Clear(t, SIM_PT_EDGE);
+                PT_YIELD(t);
+            }
+
+            PT_AWAIT_EVENT_UNTIL(t, SIM_PT_EDGE, btn->release_ms + p->multi_ms);
+        } while (t->got != 0U);
+
+        SimPt_PostClicks(btn);
+    }
+    PT_END(t);
+}
+
+void SimPt_ButtonStart(SimPtButton_t *b, ButtonCtx_t *btn)
+{
+    b->btn = btn;
+    b->edge_ms = 0;
+    b->level = 0;
+    Pt_Start(&b->task, SimPt_ButtonTask);
+}
+
+/* the first edge counts, as in the FSM: later ones only bounce */
+void SimPt_ButtonEdge(SimPtButton_t *b, uint32_t t_ms)
+{
+    if ((b->task.events & SIM_PT_EDGE) == 0U)
+        b->edge_ms = t_ms;
+    Pt_Signal(&b->task, SIM_PT_SIG_EDGE);
+}
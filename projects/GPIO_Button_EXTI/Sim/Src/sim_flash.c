@@ -0,0 +1,180 @@
+/*
+ * Host flash emulator
+ *
+ * Stand-in for the HAL FLASH driver on the KVSTORE pages.
+ *
+ * The pages are mapped at their target address (SIM_FLASH_BASE),
+ * so Core/Src/kv_store.c reads them through plain pointers,
+ * exactly as on the STM32.
+ *
+ * NOR rules of the STM32F1 flash:
+ *  - erase sets a whole 1 KB page to 0xFF
+ *  - a halfword can only be programmed while it reads 0xFFFF,
+ *    except that 0x0000 may always be written (PGERR otherwise)
+ *  - programming requires HAL_FLASH_Unlock()
+ *
+ * Power-loss injection: Sim_Flash_PowerLossAfter(n) tears the
+ * n-th following operation (a program clears only some of its
+ * bits, an erase stops after a part of the page) and then
+ * longjmp()s back to the test, like a reset would.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "sim_hal.h"
+
+#define SIM_FLASH_SIZE  (SIM_FLASH_PAGES * FLASH_PAGE_SIZE)
+
+static uint8_t *sim_flash;
+static uint8_t  sim_flash_unlocked;
+static uint32_t sim_flash_erases[SIM_FLASH_PAGES];
+static uint32_t sim_flash_ops;
+static uint32_t sim_flash_pgerr;
+
+static uint32_t sim_flash_fail_in;      /* 0 = no power loss armed */
+static jmp_buf *sim_flash_fail_env;
+static uint32_t sim_flash_rng = 1U;
+
+static uint8_t *Sim_FlashMem(void)
+{
+    if (sim_flash == NULL) {
+        void *p = mmap((void *)SIM_FLASH_BASE, SIM_FLASH_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+        if (p != (void *)SIM_FLASH_BASE) {
+            fprintf(stderr, "sim_flash: cannot map 0x%08lx\n", (unsigned long)SIM_FLASH_BASE);
+            exit(EXIT_FAILURE);
+        }
+        sim_flash = p;
+        memset(sim_flash, 0xFF, SIM_FLASH_SIZE);
+    }
+    return sim_flash;
+}
+
+static uint32_t Sim_FlashRand(void)
+{
+    sim_flash_rng = sim_flash_rng * 1103515245U + 12345U;
+    return sim_flash_rng >> 8;
+}
+
+/* 1 = this operation is the one interrupted by the power loss */
+static uint8_t Sim_FlashOp(void)
+{
+    sim_flash_ops++;
+    if (sim_flash_fail_in == 0U)
+        return 0;
+    return --sim_flash_fail_in == 0U;
+}
+
+static void Sim_FlashPowerLoss(void)
+{
+    jmp_buf *env = sim_flash_fail_env;
+
+    sim_flash_fail_env = NULL;
+    sim_flash_unlocked = 0;
+    longjmp(*env, 1);
+}
+
+/* ===== HAL shim ===== */
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    (void)Sim_FlashMem();       /* first flash access maps the pages */
+    sim_flash_unlocked = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    sim_flash_unlocked = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    uint8_t *mem = Sim_FlashMem();
+    uint32_t off = Address - SIM_FLASH_BASE;
+    uint16_t cur, val = (uint16_t)Data;
+
+    if (!sim_flash_unlocked || TypeProgram != FLASH_TYPEPROGRAM_HALFWORD ||
+        Address < SIM_FLASH_BASE || off >= SIM_FLASH_SIZE || (off & 1U) != 0U)
+        return HAL_ERROR;
+
+    memcpy(&cur, &mem[off], sizeof(cur));
+    if (cur != 0xFFFFU && val != 0x0000U) {
+        sim_flash_pgerr++;
+        return HAL_ERROR;
+    }
+
+    if (Sim_FlashOp()) {
+        val |= (uint16_t)Sim_FlashRand();    /* only some bits reach 0 */
+        cur &= val;
+        memcpy(&mem[off], &cur, sizeof(cur));
+        Sim_FlashPowerLoss();
+    }
+
+    cur &= val;
+    memcpy(&mem[off], &cur, sizeof(cur));
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError)
+{
+    uint8_t *mem = Sim_FlashMem();
+    uint32_t off = pEraseInit->PageAddress - SIM_FLASH_BASE;
+
+    *PageError = 0xFFFFFFFFU;
+    if (!sim_flash_unlocked || pEraseInit->TypeErase != FLASH_TYPEERASE_PAGES ||
+        pEraseInit->PageAddress < SIM_FLASH_BASE ||
+        off + pEraseInit->NbPages * FLASH_PAGE_SIZE > SIM_FLASH_SIZE ||
+        (off % FLASH_PAGE_SIZE) != 0U)
+        return HAL_ERROR;
+
+    for (uint32_t i = 0; i < pEraseInit->NbPages; i++, off += FLASH_PAGE_SIZE) {
+        sim_flash_erases[off / FLASH_PAGE_SIZE]++;
+
+        if (Sim_FlashOp()) {
+            memset(&mem[off], 0xFF, Sim_FlashRand() % FLASH_PAGE_SIZE);
+            Sim_FlashPowerLoss();
+        }
+        memset(&mem[off], 0xFF, FLASH_PAGE_SIZE);
+    }
+    return HAL_OK;
+}
+
+/* ===== Control ===== */
+
+void Sim_Flash_Blank(void)
+{
+    memset(Sim_FlashMem(), 0xFF, SIM_FLASH_SIZE);
+    sim_flash_unlocked = 0;
+    sim_flash_fail_in  = 0;
+    sim_flash_fail_env = NULL;
+}
+
+uint32_t Sim_Flash_Erases(uint32_t page)
+{
+    return (page < SIM_FLASH_PAGES) ? sim_flash_erases[page] : 0U;
+}
+
+uint32_t Sim_Flash_Ops(void)
+{
+    return sim_flash_ops;
+}
+
+uint32_t Sim_Flash_ProgramErrors(void)
+{
+    return sim_flash_pgerr;
+}
+
+void Sim_Flash_PowerLossAfter(uint32_t n, jmp_buf *env)
+{
+    sim_flash_fail_in  = n;
+    sim_flash_fail_env = (n != 0U) ? env : NULL;
+}
@@ -0,0 +1,193 @@
+/*
+ * Table-driven button FSM (host only)
+ *
+ * The button transitions of Core/Src/button_fsm.c written as a
+ * const table for the fsm.h engine, see sim_fsm_table.h. It is the
+ * candidate for button_fsm.c: `make run` holds it equal to the
+ * switch, `make bench` times it against it.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#include <stddef.h>
+
+#include "sim_fsm_table.h"
+#include "fsm.h"
+
+/* trace tag, FSM_TRACE_ENABLE */
+#define TAB_FSM_ID      1U
+
+/* click count -> gesture */
+static const ButtonEvent_t tab_click_events[] = {
+    BTN_EVENT_NONE, BTN_EVENT_SHORT, BTN_EVENT_DOUBLE, BTN_EVENT_TRIPLE
+};
+
+#define TAB_MAX_CLICKS  3U
+
+/* ===== Signals ===== */
+enum {
+    BTN_SIG_EDGE = 0,       /* EXTI / captured edge */
+    BTN_SIG_HELD,           /* timer due (Button_DueAt), input pressed */
+    BTN_SIG_FREE            /* timer due (Button_DueAt), input released */
+};
+
+/* guard / action context of one dispatch */
+typedef struct {
+    ButtonCtx_t *btn;
+    uint32_t now;
+} BtnFsmIn_t;
+
+static void SimTab_Post(ButtonCtx_t *btn, ButtonEvent_t evt)
+{
+    (void)EvQ_Post(&btn->events, (uint16_t)evt, 0);
+}
+
+/* the click sequence is over: one event for all of it */
+static void SimTab_PostClicks(ButtonCtx_t *btn)
+{
+    if (btn->clicks != 0U)
+        SimTab_Post(btn, tab_click_events[btn->clicks]);
+    btn->clicks = 0;
+}
+
+/* ===== Guards (time is checked before dispatch) ===== */
+
+static uint8_t Btn_InGesture(void *ctx)
+{
+    return ((BtnFsmIn_t *)ctx)->btn->clicks != 0U;
+}
+
+/* this release completes the gesture: no window or no more clicks */
+static uint8_t Btn_LastClick(void *ctx)
+{
+    const BtnFsmIn_t *in = ctx;
+
+    return in->btn->profile->multi_ms == 0U || (in->btn->clicks + 1U) >= TAB_MAX_CLICKS;
+}
+
+/* ===== Entry / transition actions ===== */
+
+static void Btn_EnterDebounce(void *ctx)
+{
+    BtnFsmIn_t *in = ctx;
+
+    in->btn->debounce_start_ms = in->now;
+}
+
+static void Btn_EnterPressed(void *ctx)
+{
+    BtnFsmIn_t *in = ctx;
+    ButtonCtx_t *btn = in->btn;
+
+    /* press edge after the click window: a new gesture */
+    if (btn->clicks != 0U &&
+        (btn->debounce_start_ms - btn->release_ms) >= btn->profile->multi_ms)
+        SimTab_PostClicks(btn);
+    btn->press_start_ms = in->now;
+}
+
+static void Btn_EnterLong(void *ctx)
+{
+    BtnFsmIn_t *in = ctx;
+
+    SimTab_PostClicks(in->btn);
+    SimTab_Post(in->btn, BTN_EVENT_LONG);
+    in->btn->repeat_ms = in->now;
+}
+
+static void Btn_ClickLast(void *ctx)
+{
+    BtnFsmIn_t *in = ctx;
+
+    in->btn->clicks++;
+    SimTab_PostClicks(in->btn);
+}
+
+static void Btn_Click(void *ctx)
+{
+    BtnFsmIn_t *in = ctx;
+
+    in->btn->clicks++;
+    in->btn->release_ms = in->now;
+}
+
+static void Btn_HoldRelease(void *ctx)
+{
+    SimTab_Post(((BtnFsmIn_t *)ctx)->btn, BTN_EVENT_RELEASE);
+}
+
+static void Btn_HoldRepeat(void *ctx)
+{
+    BtnFsmIn_t *in = ctx;
+
+    SimTab_Post(in->btn, BTN_EVENT_HOLD_REPEAT);
+    in->btn->repeat_ms += in->btn->profile->repeat_ms;
+}
+
+static void Btn_GestureEnd(void *ctx)
+{
+    SimTab_PostClicks(((BtnFsmIn_t *)ctx)->btn);
+}
+
+/* ===== Tables ===== */
+
+static const FsmRow_t btn_rows_idle[] = {
+    { BTN_SIG_EDGE, BTN_STATE_DEBOUNCE,   NULL,          NULL            },
+};
+
+static const FsmRow_t btn_rows_debounce[] = {
+    { BTN_SIG_HELD, BTN_STATE_PRESSED,    NULL,          NULL            },
+    { BTN_SIG_FREE, BTN_STATE_CLICK_WAIT, Btn_InGesture, NULL            },
+    { BTN_SIG_FREE, BTN_STATE_IDLE,       NULL,          NULL            },
+};
+
+static const FsmRow_t btn_rows_pressed[] = {
+    { BTN_SIG_HELD, BTN_STATE_LONG,       NULL,          NULL            },
+    { BTN_SIG_FREE, BTN_STATE_IDLE,       Btn_LastClick, Btn_ClickLast   },
+    { BTN_SIG_FREE, BTN_STATE_CLICK_WAIT, NULL,          Btn_Click       },
+};
+
+static const FsmRow_t btn_rows_long[] = {
+    { BTN_SIG_FREE, BTN_STATE_IDLE,       NULL,          Btn_HoldRelease },
+    { BTN_SIG_HELD, FSM_SAME,             NULL,          Btn_HoldRepeat  },
+};
+
+static const FsmRow_t btn_rows_click_wait[] = {
+    { BTN_SIG_EDGE, BTN_STATE_DEBOUNCE,   NULL,          NULL            },
+    { BTN_SIG_HELD, BTN_STATE_IDLE,       NULL,          Btn_GestureEnd  },
+    { BTN_SIG_FREE, BTN_STATE_IDLE,       NULL,          Btn_GestureEnd  },
+};
+
+/* indexed by ButtonState_t */
+static const FsmState_t btn_states[] = {
+    [BTN_STATE_IDLE]       = FSM_STATE(btn_rows_idle,       NULL,              NULL),
+    [BTN_STATE_DEBOUNCE]   = FSM_STATE(btn_rows_debounce,   Btn_EnterDebounce, NULL),
+    [BTN_STATE_PRESSED]    = FSM_STATE(btn_rows_pressed,    Btn_EnterPressed,  NULL),
+    [BTN_STATE_LONG]       = FSM_STATE(btn_rows_long,       Btn_EnterLong,     NULL),
+    [BTN_STATE_CLICK_WAIT] = FSM_STATE(btn_rows_click_wait, NULL,              NULL),
+};
+
+static const FsmDef_t btn_fsm = FSM_DEF(btn_states, TAB_FSM_ID);
+
+static void SimTab_Dispatch(ButtonCtx_t *btn, uint32_t now, uint8_t sig)
+{
+    BtnFsmIn_t in = { btn, now };
+
+    btn->state = (ButtonState_t)Fsm_Dispatch(&btn_fsm, (uint8_t)btn->state, sig, &in);
+}
+
+void SimTab_OnEdgeAt(ButtonCtx_t *btn, uint32_t t_ms)
+{
+    SimTab_Dispatch(btn, t_ms, BTN_SIG_EDGE);
+}
+
+void SimTab_ProcessAt(ButtonCtx_t *btn, uint32_t now, uint8_t level)
+{
+    uint32_t due;
+
+    /* the usual poll: nothing due, no dispatch at all */
+    if (!Button_DueAt(btn, level, &due) || (int32_t)(now - due) < 0)
+        return;
+
+    SimTab_Dispatch(btn, now, level ? BTN_SIG_HELD : BTN_SIG_FREE);
+}
@@ -0,0 +1,1066 @@
+/*
+ * Host HAL shim and virtual clock
+ *
+ * Minimal stand-in for the STM32F1 HAL pieces used by the
+ * application: GPIO read/write/toggle, EXTI callbacks,
+ * TIM2 period-elapsed dispatch and the HAL millisecond tick.
+ *
+ * Timing model:
+ *  - virtual time is a 64-bit nanosecond counter
+ *  - SysTick counts down from LOAD at SystemCoreClock, VAL follows
+ *    the virtual clock; a reload takes the LOAD of that moment and
+ *    pends SysTick_Handler (HAL_IncTick), which runs at once unless
+ *    WFI is waiting (see below); CTRL.ENABLE stops / resumes the
+ *    count, SysTick_Config restarts it now, a VAL write clears the
+ *    count and reloads without pending the handler
+ *  - TIM2 CNT counts every PSC+1 timer clocks while CEN is set, an
+ *    update when it passes ARR (no preload: a new ARR or CNT counts
+ *    from the next count, the prescaler phase is kept); the IRQ
+ *    only with DIER.UIE; EGR.UG restarts a counter from 0 with UIF
+ *    unless CR1.URS is set
+ *  - timer clocks follow RCC->CFGR: SYSCLK on the PLL is 64 MHz,
+ *    on HSI 8 MHz, APB1 timers doubled while PPRE1 divides; the
+ *    switch itself is instant (SWS mirrors SW)
+ *  - WFI (HAL_PWR_EnterSLEEPMode) is entered with PRIMASK set: the
+ *    clock runs to the first event with an enabled interrupt, or to
+ *    the limit of Sim_Clock_SleepUntil, and stops before it; events
+ *    without an interrupt on the way still happen
+ *  - a USART2 DMA transfer completes 10 bit times per byte after
+ *    it was started; the bytes are sampled at completion, so a
+ *    writer that overwrites an in-flight buffer is caught; gState
+ *    is BUSY_TX and SR.TC clear meanwhile
+ *  - USART2 RX: injected bytes arrive back-to-back, 10 bit times
+ *    each; the circular DMA raises the HAL reception event at half
+ *    buffer, full buffer and one idle frame after the last byte
+ *  - TIM3_CH3 DMA: one byte into CCR3 every (PSC+1)*(ARR+1)
+ *    timer clocks while the request is enabled; HT / TC
+ *    interrupts still enabled at those points are counted
+ *  - TIM4 counts from the virtual clock; an edge on PB6 (TIM4_CH1)
+ *    is captured at once, rising into CH1, falling into CH2
+ *    (indirect), and DMA1 Channel 1 / 4 store the 16-bit stamp;
+ *    the capture comes before the EXTI callback of the same edge
+ *  - EXTI callbacks only for lines unmasked in EXTI->IMR
+ *  - events are fired in timestamp order, never in parallel
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#include <string.h>
+
+#include "sim_hal.h"
+#include "defer.h"
+#include "tim.h"
+#include "usart.h"
+
+#define SIM_PORT_COUNT   4U
+#define SIM_UART_CAPTURE 65536U
+#define SIM_UART_WIRE    65536U
+#define SIM_NO_EVENT     UINT64_MAX
+
+/* ===== Simulated peripherals ===== */
+GPIO_TypeDef sim_gpioa, sim_gpiob, sim_gpioc, sim_gpiod;
+TIM_TypeDef  sim_tim2, sim_tim3, sim_tim4;
+EXTI_TypeDef sim_exti;
+SysTick_Type sim_systick;
+SCB_Type     sim_scb;
+USART_TypeDef sim_usart2;
+RCC_TypeDef   sim_rcc;
+FLASH_TypeDef sim_flash_acr;
+
+DMA_HandleTypeDef hdma_tim3_ch3;
+DMA_HandleTypeDef hdma_tim4_ch1;
+DMA_HandleTypeDef hdma_tim4_ch2;
+
+TIM_HandleTypeDef htim2 = { .Instance = TIM2 };
+TIM_HandleTypeDef htim3 = { .Instance = TIM3, .hdma = { [TIM_DMA_ID_CC3] = &hdma_tim3_ch3 } };
+TIM_HandleTypeDef htim4 = { .Instance = TIM4, .hdma = { [TIM_DMA_ID_CC1] = &hdma_tim4_ch1,
+                                                        [TIM_DMA_ID_CC2] = &hdma_tim4_ch2 } };
+UART_HandleTypeDef huart2 = { .Instance = USART2, .Init = { .BaudRate = 115200U } };
+uint32_t SystemCoreClock = 64000000UL;
+HAL_TickFreqTypeDef uwTickFreq = HAL_TICK_FREQ_1KHZ;
+uint32_t uwTickPrio = 0U;
+
+static GPIO_TypeDef *const sim_ports[SIM_PORT_COUNT] = {
+    &sim_gpioa, &sim_gpiob, &sim_gpioc, &sim_gpiod
+};
+
+/* ===== Internal state ===== */
+static uint64_t sim_now_ns;
+static uint32_t sim_uw_tick;
+static uint64_t sim_sleep_until_ns;
+
+/* SysTick: reloaded at sim_st_start_ns for sim_st_period cycles */
+static uint64_t sim_st_start_ns;
+static uint32_t sim_st_period;
+static uint8_t  sim_st_enabled;
+static uint32_t sim_st_val_shown;   /* VAL as last set here, else written */
+
+/* TIM2: CNT was sim_tim2_base_cnt at sim_tim2_base_ns, a count edge */
+static uint64_t sim_tim2_base_ns;
+static uint32_t sim_tim2_base_cnt;
+static uint32_t sim_tim2_cnt_shown;
+
+static SimIrqFn sim_tim2_irq;
+
+static uint16_t sim_exti_rising[SIM_PORT_COUNT];
+static uint16_t sim_exti_falling[SIM_PORT_COUNT];
+static uint32_t sim_toggles[SIM_PORT_COUNT][16];
+
+static SimStats_t sim_stats;
+
+static const uint8_t *sim_uart_dma_src;
+static uint16_t sim_uart_dma_len;
+static uint64_t sim_uart_done_ns = SIM_NO_EVENT;
+static uint8_t  sim_uart_capture[SIM_UART_CAPTURE];
+static uint32_t sim_uart_cap_head, sim_uart_cap_tail;
+
+/* RX: bytes on the wire, not yet received */
+static uint8_t  sim_rx_wire[SIM_UART_WIRE];
+static uint32_t sim_rx_wire_head, sim_rx_wire_tail;
+static uint64_t sim_rx_next_ns;     /* arrival of the oldest byte on the wire */
+static uint64_t sim_rx_last_ns;     /* arrival of the last received byte */
+static uint8_t  sim_rx_idle_armed;
+static uint8_t *sim_rx_dst;         /* NULL = reception not running */
+static uint16_t sim_rx_size;
+static uint16_t sim_rx_pos;         /* DMA write index */
+
+/* TIM3_CH3 PWM + DMA1 Channel 2 */
+static const uint8_t *sim_pwm_src;
+static uint16_t sim_pwm_len;
+static uint8_t  sim_pwm_busy;       /* HAL channel state BUSY */
+static uint64_t sim_pwm_next_ns;    /* next CC3 DMA request */
+
+/* TIM4_CH1 / CH2 capture + DMA1 Channel 1 / 4 */
+#define SIM_CAP_PIN      GPIO_PIN_6     /* PB6 = TIM4_CH1 */
+static uint16_t *sim_cap_dst[2];
+static uint16_t  sim_cap_len[2];
+static uint64_t  sim_tim4_start_ns; /* virtual time of CNT = 0 */
+
+static int Sim_PortIndex(const GPIO_TypeDef *port)
+{
+    for (unsigned i = 0; i < SIM_PORT_COUNT; i++) {
+        if (sim_ports[i] == port)
+            return (int)i;
+    }
+    return -1;
+}
+
+static unsigned Sim_PinIndex(uint16_t pin)
+{
+    unsigned idx = 0;
+    while (pin > 1U) {
+        pin >>= 1;
+        idx++;
+    }
+    return idx;
+}
+
+/* APB1 timer kernel clock: PCLK1, doubled while APB1 is divided */
+static uint32_t Sim_TimClockHz(void)
+{
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+
+    return ((RCC->CFGR & RCC_CFGR_PPRE1) == RCC_CFGR_PPRE1_DIV1) ? pclk1 : 2U * pclk1;
+}
+
+static uint64_t Sim_TimPeriodNs(const TIM_TypeDef *tim)
+{
+    uint64_t clocks = (uint64_t)(tim->PSC + 1U) * (uint64_t)(tim->ARR + 1U);
+    return (clocks * 1000000000ULL) / Sim_TimClockHz();
+}
+
+static uint64_t Sim_TimCountNs(const TIM_TypeDef *tim)
+{
+    return ((uint64_t)(tim->PSC + 1U) * 1000000000ULL) / Sim_TimClockHz();
+}
+
+static uint64_t Sim_CyclesToNs(uint64_t cycles)
+{
+    return (cycles * 1000000000ULL) / SystemCoreClock;
+}
+
+static uint64_t Sim_NsToCycles(uint64_t ns)
+{
+    return (ns * SystemCoreClock) / 1000000000ULL;
+}
+
+static uint64_t Sim_MinNs(uint64_t a, uint64_t b)
+{
+    return (b < a) ? b : a;
+}
+
+/* ===== SysTick / TIM2 counters ===== */
+
+static uint64_t Sim_SysTickNextNs(void)
+{
+    if (!sim_st_enabled)
+        return SIM_NO_EVENT;
+    return sim_st_start_ns + Sim_CyclesToNs(sim_st_period);
+}
+
+/* counted down to 0: reload from LOAD, pend SysTick_Handler */
+static void Sim_SysTickReload(uint64_t t_ns)
+{
+    sim_st_start_ns = t_ns;
+    sim_st_period   = SysTick->LOAD + 1U;
+    SysTick->VAL    = SysTick->LOAD;
+    sim_st_val_shown = SysTick->VAL;
+    if (SysTick->CTRL & SysTick_CTRL_TICKINT_Msk)
+        sim_scb.ICSR |= SCB_ICSR_PENDSTSET_Msk;
+}
+
+static uint64_t Sim_Tim2NextNs(void)
+{
+    uint32_t left;
+
+    if (!(TIM2->CR1 & TIM_CR1_CEN))
+        return SIM_NO_EVENT;
+
+    /* a counter beyond a lowered ARR runs to 0xFFFF first */
+    left = (sim_tim2_base_cnt <= TIM2->ARR) ? TIM2->ARR + 1U - sim_tim2_base_cnt
+                                            : 0x10000U - sim_tim2_base_cnt;
+    return sim_tim2_base_ns + (uint64_t)left * Sim_TimCountNs(TIM2);
+}
+
+/* CNT passed ARR: update event, UIF set */
+static void Sim_Tim2Update(uint64_t t_ns)
+{
+    sim_tim2_base_ns   = t_ns;
+    sim_tim2_base_cnt  = 0;
+    sim_tim2_cnt_shown = 0;
+    sim_stats.tim2_updates++;
+    TIM2->CNT = 0;
+    TIM2->SR |= TIM_SR_UIF;
+}
+
+static uint8_t Sim_Tim2IrqPending(void)
+{
+    return (TIM2->SR & TIM_SR_UIF) && (TIM2->DIER & TIM_DIER_UIE);
+}
+
+/* registers the firmware wrote since the last look: a stopped SysTick
+   holds VAL, a resumed one counts on from it, a written VAL reloads
+   now; a written TIM2 CNT counts on from the next count edge, UG
+   restarts TIM2 / TIM3 / TIM4 from 0 */
+static void Sim_SyncCounters(void)
+{
+    uint8_t en = (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) != 0U;
+
+    if (en && !sim_st_enabled) {
+        uint32_t val = (SysTick->VAL < sim_st_period) ? SysTick->VAL : sim_st_period - 1U;
+
+        sim_st_start_ns = sim_now_ns - Sim_CyclesToNs(sim_st_period - 1U - val);
+    } else if (en && SysTick->VAL != sim_st_val_shown) {
+        sim_st_start_ns = sim_now_ns;
+        sim_st_period   = SysTick->LOAD + 1U;
+        SysTick->VAL    = SysTick->LOAD;
+    }
+    sim_st_enabled   = en;
+    sim_st_val_shown = SysTick->VAL;
+
+    if (TIM2->EGR & TIM_EGR_UG) {
+        TIM2->EGR = 0;
+        TIM2->CNT = 0;
+        sim_tim2_base_ns   = sim_now_ns;
+        sim_tim2_base_cnt  = 0;
+        sim_tim2_cnt_shown = 0;
+        if (!(TIM2->CR1 & TIM_CR1_URS))
+            TIM2->SR |= TIM_SR_UIF;
+    }
+    if (TIM3->EGR & TIM_EGR_UG) {
+        TIM3->EGR = 0;
+        sim_pwm_next_ns = sim_now_ns + Sim_TimPeriodNs(TIM3);
+    }
+    if (TIM4->EGR & TIM_EGR_UG) {
+        TIM4->EGR = 0;
+        sim_tim4_start_ns = sim_now_ns;
+    }
+
+    if (TIM2->CNT != sim_tim2_cnt_shown) {
+        uint64_t cnt_ns = Sim_TimCountNs(TIM2);
+
+        sim_tim2_base_ns += ((sim_now_ns - sim_tim2_base_ns) / cnt_ns) * cnt_ns;
+        sim_tim2_base_cnt = TIM2->CNT;
+        sim_tim2_cnt_shown = TIM2->CNT;
+    }
+}
+
+/* moves the virtual clock, SysTick->VAL and TIM2->CNT follow it */
+static void Sim_SetNow(uint64_t t_ns)
+{
+    sim_now_ns = t_ns;
+
+    if (sim_st_enabled) {
+        uint64_t gone = Sim_NsToCycles(t_ns - sim_st_start_ns);
+
+        SysTick->VAL = (gone < sim_st_period) ? sim_st_period - 1U - (uint32_t)gone : 0U;
+        sim_st_val_shown = SysTick->VAL;
+    }
+    if (TIM2->CR1 & TIM_CR1_CEN) {
+        uint64_t cnt = sim_tim2_base_cnt + (t_ns - sim_tim2_base_ns) / Sim_TimCountNs(TIM2);
+
+        if (sim_tim2_base_cnt <= TIM2->ARR)
+            cnt %= TIM2->ARR + 1U;
+        TIM2->CNT = (uint32_t)(cnt & 0xFFFFU);
+        sim_tim2_cnt_shown = TIM2->CNT;
+    }
+}
+
+/* HAL_TIM_IRQHandler equivalent for the update flag only */
+static void Sim_Tim2HalIrq(void)
+{
+    if ((TIM2->SR & TIM_SR_UIF) && (TIM2->DIER & TIM_DIER_UIE)) {
+        TIM2->SR &= ~TIM_SR_UIF;
+        HAL_TIM_PeriodElapsedCallback(&htim2);
+    }
+}
+
+static void Sim_OutputChanged(GPIO_TypeDef *port, uint32_t old_odr)
+{
+    int p = Sim_PortIndex(port);
+    uint32_t diff = (old_odr ^ port->ODR) & 0xFFFFU;
+
+    if (p < 0)
+        return;
+
+    for (unsigned i = 0; diff != 0U; i++, diff >>= 1) {
+        if (diff & 1U)
+            sim_toggles[p][i]++;
+    }
+}
+
+/* ===== Lifecycle ===== */
+
+void Sim_Reset(void)
+{
+    for (unsigned i = 0; i < SIM_PORT_COUNT; i++)
+        memset((void *)sim_ports[i], 0, sizeof(GPIO_TypeDef));
+
+    memset((void *)&sim_tim2, 0, sizeof(sim_tim2));
+    memset((void *)&sim_tim3, 0, sizeof(sim_tim3));
+    memset((void *)&sim_tim4, 0, sizeof(sim_tim4));
+    memset((void *)&hdma_tim3_ch3, 0, sizeof(hdma_tim3_ch3));
+    memset((void *)&hdma_tim4_ch1, 0, sizeof(hdma_tim4_ch1));
+    memset((void *)&hdma_tim4_ch2, 0, sizeof(hdma_tim4_ch2));
+    memset((void *)&sim_exti, 0, sizeof(sim_exti));
+    memset((void *)&sim_scb, 0, sizeof(sim_scb));
+
+    /* SystemClock_Config equivalent: SYSCLK on the 64 MHz PLL, APB1 / 2 */
+    RCC->CFGR = RCC_CFGR_SW_PLL | RCC_CFGR_SWS_PLL | RCC_CFGR_PPRE1_DIV2;
+    FLASH->ACR = FLASH_LATENCY_2;
+    SystemCoreClockUpdate();
+
+    /* HAL_InitTick equivalent: 1 ms reload at HCLK */
+    SysTick->LOAD = SystemCoreClock / 1000U - 1U;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk |
+                    SysTick_CTRL_ENABLE_Msk;
+    sim_st_start_ns = 0;
+    sim_st_period   = SysTick->LOAD + 1U;
+    sim_st_enabled  = 1;
+    sim_st_val_shown = SysTick->VAL;
+    memset(sim_exti_rising, 0, sizeof(sim_exti_rising));
+    memset(sim_exti_falling, 0, sizeof(sim_exti_falling));
+    memset(sim_toggles, 0, sizeof(sim_toggles));
+    memset(&sim_stats, 0, sizeof(sim_stats));
+
+    sim_uart_dma_src  = NULL;
+    sim_uart_dma_len  = 0;
+    sim_uart_done_ns  = SIM_NO_EVENT;
+    sim_uart_cap_head = 0;
+    sim_uart_cap_tail = 0;
+
+    sim_rx_wire_head  = 0;
+    sim_rx_wire_tail  = 0;
+    sim_rx_next_ns    = SIM_NO_EVENT;
+    sim_rx_last_ns    = 0;
+    sim_rx_idle_armed = 0;
+    sim_rx_dst        = NULL;
+    sim_rx_pos        = 0;
+    huart2.RxState    = HAL_UART_STATE_READY;
+    huart2.gState     = HAL_UART_STATE_READY;
+    USART2->SR        = USART_SR_TC;
+    /* MX_USART2_UART_Init equivalent */
+    USART2->BRR       = UART_BRR_SAMPLING16(HAL_RCC_GetPCLK1Freq(), huart2.Init.BaudRate);
+
+    /* MX_TIM3_Init equivalent: 500 Hz, 8-bit PWM, channel stopped */
+    TIM3->PSC = 500U - 1U;
+    TIM3->ARR = 256U - 1U;
+    htim3.Init.Prescaler = TIM3->PSC;
+    htim3.Init.Period    = TIM3->ARR;
+    sim_pwm_src  = NULL;
+    sim_pwm_len  = 0;
+    sim_pwm_busy = 0;
+
+    /* MX_TIM4_Init equivalent: 1 MHz free-running, circular capture DMA */
+    TIM4->PSC = 64U - 1U;
+    TIM4->ARR = 0xFFFFU;
+    htim4.Init.Prescaler = TIM4->PSC;
+    htim4.Init.Period    = TIM4->ARR;
+    hdma_tim4_ch1.Init.Mode = DMA_CIRCULAR;
+    hdma_tim4_ch2.Init.Mode = DMA_CIRCULAR;
+    sim_cap_dst[0] = NULL;
+    sim_cap_dst[1] = NULL;
+    sim_tim4_start_ns = 0;
+
+    /* MX_TIM2_Init + HAL_TIM_Base_Start_IT equivalent: 2 ms update */
+    TIM2->PSC  = 64000U - 1U;
+    TIM2->ARR  = 2U - 1U;
+    htim2.Init.Prescaler = TIM2->PSC;
+    htim2.Init.Period    = TIM2->ARR;
+    TIM2->DIER = TIM_DIER_UIE;
+    TIM2->CR1  = TIM_CR1_CEN;
+
+    sim_tim2_base_ns   = 0;
+    sim_tim2_base_cnt  = 0;
+    sim_tim2_cnt_shown = 0;
+
+    Sim_SetNow(0);
+    sim_uw_tick        = 0;
+    sim_sleep_until_ns = SIM_NO_EVENT;
+    sim_tim2_irq       = Sim_Tim2HalIrq;
+}
+
+/* ===== USART2 RX model ===== */
+
+static uint64_t Sim_UartByteNs(void)
+{
+    return (10U * 1000000000ULL) / huart2.Init.BaudRate;
+}
+
+/* bytes until the DMA raises half / full transfer, infinite if stopped */
+static uint32_t Sim_UartRxToBoundary(void)
+{
+    if (sim_rx_dst == NULL)
+        return UINT32_MAX;
+    return ((sim_rx_pos < sim_rx_size / 2U) ? sim_rx_size / 2U : sim_rx_size) - sim_rx_pos;
+}
+
+/* next RX event time; *idle = 1 for the IDLE line event */
+static uint64_t Sim_UartRxNextNs(uint8_t *idle)
+{
+    uint32_t pending = sim_rx_wire_head - sim_rx_wire_tail;
+    uint32_t b = Sim_UartRxToBoundary();
+
+    *idle = 1;
+    if (pending == 0U)
+        return sim_rx_idle_armed ? sim_rx_last_ns + Sim_UartByteNs() : SIM_NO_EVENT;
+
+    if (pending >= b) {
+        *idle = 0;
+        return sim_rx_next_ns + (uint64_t)(b - 1U) * Sim_UartByteNs();
+    }
+    return sim_rx_next_ns + (uint64_t)pending * Sim_UartByteNs();
+}
+
+/* move n bytes from the wire into the DMA buffer (or drop them) */
+static void Sim_UartRxDeliver(uint32_t n)
+{
+    const uint64_t byte_ns = Sim_UartByteNs();
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t c = sim_rx_wire[sim_rx_wire_tail++ % SIM_UART_WIRE];
+
+        if (sim_rx_dst != NULL) {
+            sim_rx_dst[sim_rx_pos] = c;
+            if (++sim_rx_pos == sim_rx_size)
+                sim_rx_pos = 0;
+            sim_stats.uart_rx_bytes++;
+        } else {
+            sim_stats.uart_rx_lost++;
+        }
+        sim_rx_last_ns  = sim_rx_next_ns;
+        sim_rx_next_ns += byte_ns;
+    }
+    if (n != 0U)
+        sim_rx_idle_armed = 1;
+}
+
+/* DMA HT / TC or USART IDLE -> HAL_UARTEx_RxEventCallback */
+static void Sim_UartRxEvent(uint8_t idle)
+{
+    uint32_t pending = sim_rx_wire_head - sim_rx_wire_tail;
+
+    if (!idle) {
+        Sim_UartRxDeliver(Sim_UartRxToBoundary());
+        sim_stats.uart_rx_events++;
+        HAL_UARTEx_RxEventCallback(&huart2, (sim_rx_pos == 0U) ? sim_rx_size : sim_rx_pos);
+        return;
+    }
+
+    Sim_UartRxDeliver(pending);
+    sim_rx_idle_armed = 0;
+
+    /* HAL: IDLE only reported with 0 < CNDTR < RxXferSize */
+    if (sim_rx_dst != NULL && sim_rx_pos != 0U) {
+        sim_stats.uart_rx_events++;
+        HAL_UARTEx_RxEventCallback(&huart2, sim_rx_pos);
+    }
+}
+
+/* ===== TIM3 PWM DMA model ===== */
+
+static uint64_t Sim_PwmNextNs(void)
+{
+    if ((TIM3->CR1 & TIM_CR1_CEN) && (TIM3->DIER & TIM_DIER_CC3DE) &&
+        hdma_tim3_ch3.CNDTR != 0U)
+        return sim_pwm_next_ns;
+    return SIM_NO_EVENT;
+}
+
+/* CC3 DMA request: next table byte -> CCR3 */
+static void Sim_PwmDmaStep(void)
+{
+    DMA_HandleTypeDef *h = &hdma_tim3_ch3;
+
+    TIM3->CCR3 = sim_pwm_src[sim_pwm_len - h->CNDTR];
+    h->CNDTR--;
+    sim_stats.pwm_dma_steps++;
+    sim_pwm_next_ns += Sim_TimPeriodNs(TIM3);
+
+    if (h->CNDTR == sim_pwm_len / 2U && (h->IT & DMA_IT_HT))
+        sim_stats.pwm_dma_irqs++;
+    if (h->CNDTR == 0U) {
+        if (h->IT & DMA_IT_TC)
+            sim_stats.pwm_dma_irqs++;
+        if (h->Init.Mode == DMA_CIRCULAR)
+            h->CNDTR = sim_pwm_len;
+    }
+}
+
+/* ===== TIM4 input capture model ===== */
+
+static uint32_t Sim_Tim4Count(void)
+{
+    uint64_t clk_ns = Sim_TimCountNs(TIM4);
+
+    if (!(TIM4->CR1 & TIM_CR1_CEN))
+        return TIM4->CNT;
+    return (uint32_t)(((sim_now_ns - sim_tim4_start_ns) / clk_ns) % (TIM4->ARR + 1U));
+}
+
+/* edge on TI1: CCRx <- CNT, DMA moves it when CCxDE is set */
+static void Sim_CapEdge(GPIO_PinState level)
+{
+    unsigned ch = (level == GPIO_PIN_SET) ? 0U : 1U;
+    DMA_HandleTypeDef *h = (ch == 0U) ? &hdma_tim4_ch1 : &hdma_tim4_ch2;
+    uint32_t cnt = Sim_Tim4Count();
+
+    if (!(TIM4->CR1 & TIM_CR1_CEN) || !(TIM4->CCER & (ch ? TIM_CCER_CC2E : TIM_CCER_CC1E)))
+        return;
+
+    (&TIM4->CCR1)[ch] = cnt;
+    if (!(TIM4->DIER & (ch ? TIM_DIER_CC2DE : TIM_DIER_CC1DE)) || h->CNDTR == 0U)
+        return;
+
+    sim_cap_dst[ch][sim_cap_len[ch] - h->CNDTR] = (uint16_t)cnt;
+    h->CNDTR--;
+    sim_stats.cap_dma_edges++;
+
+    if (h->CNDTR == sim_cap_len[ch] / 2U && (h->IT & DMA_IT_HT))
+        sim_stats.cap_dma_irqs++;
+    if (h->CNDTR == 0U) {
+        if (h->IT & DMA_IT_TC)
+            sim_stats.cap_dma_irqs++;
+        if (h->Init.Mode == DMA_CIRCULAR)
+            h->CNDTR = sim_cap_len[ch];
+    }
+}
+
+/* ===== Virtual clock ===== */
+
+uint64_t Sim_Clock_NowNs(void)
+{
+    return sim_now_ns;
+}
+
+uint64_t Sim_Clock_NextEventNs(void)
+{
+    uint64_t next;
+
+    Sim_SyncCounters();
+
+    /* SysTick / TIM2 raised while WFI was waiting */
+    if ((sim_scb.ICSR & SCB_ICSR_PENDSTSET_Msk) || Sim_Tim2IrqPending())
+        return sim_now_ns;
+
+    next = Sim_MinNs(Sim_SysTickNextNs(), Sim_Tim2NextNs());
+    if (sim_uart_done_ns < next)
+        next = sim_uart_done_ns;
+    if (Sim_PwmNextNs() < next)
+        next = Sim_PwmNextNs();
+
+    uint8_t idle;
+    uint64_t rx = Sim_UartRxNextNs(&idle);
+    if (rx < next)
+        next = rx;
+    return next;
+}
+
+/* lowest-priority exception, taken once no ISR is active: PendSV_Handler */
+static void Sim_PendSV(void)
+{
+    while (sim_scb.ICSR & SCB_ICSR_PENDSVSET_Msk) {
+        sim_scb.ICSR &= ~SCB_ICSR_PENDSVSET_Msk;
+        sim_stats.pendsv++;
+        Defer_Run();
+    }
+}
+
+/* DMA1 Channel 7 transfer complete -> USART2 TC -> TxCpltCallback */
+static void Sim_UartTxDone(void)
+{
+    for (uint16_t i = 0; i < sim_uart_dma_len; i++) {
+        if (sim_uart_cap_head - sim_uart_cap_tail < SIM_UART_CAPTURE)
+            sim_uart_capture[sim_uart_cap_head++ % SIM_UART_CAPTURE] = sim_uart_dma_src[i];
+    }
+    sim_stats.uart_dma_chunks++;
+    sim_stats.uart_tx_bytes += sim_uart_dma_len;
+
+    sim_uart_done_ns = SIM_NO_EVENT;
+    sim_uart_dma_len = 0;
+    huart2.gState = HAL_UART_STATE_READY;
+    USART2->SR |= USART_SR_TC;
+    HAL_UART_TxCpltCallback(&huart2);
+}
+
+void Sim_Clock_Step(void)
+{
+    uint64_t t = Sim_Clock_NextEventNs();
+
+    Sim_SetNow(t);
+
+    if (t == Sim_SysTickNextNs())
+        Sim_SysTickReload(t);
+    if (sim_scb.ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        sim_scb.ICSR &= ~SCB_ICSR_PENDSTSET_Msk;
+        sim_stats.systicks++;
+        HAL_IncTick();
+    }
+
+    if (t == Sim_Tim2NextNs())
+        Sim_Tim2Update(t);
+    if (Sim_Tim2IrqPending())
+        sim_tim2_irq();
+
+    if (t == sim_uart_done_ns)
+        Sim_UartTxDone();
+
+    if (t == Sim_PwmNextNs())
+        Sim_PwmDmaStep();
+
+    uint8_t idle;
+    if (t == Sim_UartRxNextNs(&idle))
+        Sim_UartRxEvent(idle);
+
+    Sim_PendSV();
+}
+
+void Sim_Clock_AdvanceTo(uint64_t t_ns)
+{
+    while (Sim_Clock_NextEventNs() <= t_ns)
+        Sim_Clock_Step();
+
+    Sim_SetNow(t_ns);
+}
+
+void Sim_Clock_SleepUntil(uint64_t t_ns)
+{
+    sim_sleep_until_ns = t_ns;
+}
+
+/* first event that raises an enabled interrupt, or the sleep limit */
+static uint64_t Sim_WakeNs(void)
+{
+    uint64_t wake = sim_sleep_until_ns;
+    uint8_t idle;
+
+    if ((sim_scb.ICSR & (SCB_ICSR_PENDSTSET_Msk | SCB_ICSR_PENDSVSET_Msk)) ||
+        Sim_Tim2IrqPending())
+        return sim_now_ns;
+
+    if (SysTick->CTRL & SysTick_CTRL_TICKINT_Msk)
+        wake = Sim_MinNs(wake, Sim_SysTickNextNs());
+    if (TIM2->DIER & TIM_DIER_UIE)
+        wake = Sim_MinNs(wake, Sim_Tim2NextNs());
+    wake = Sim_MinNs(wake, sim_uart_done_ns);
+    return Sim_MinNs(wake, Sim_UartRxNextNs(&idle));
+}
+
+/* ===== Interrupt emulation ===== */
+
+void Sim_SetTim2Irq(SimIrqFn fn)
+{
+    sim_tim2_irq = (fn != NULL) ? fn : Sim_Tim2HalIrq;
+}
+
+void Sim_Exti_Config(GPIO_TypeDef *port, uint16_t pins, uint8_t rising, uint8_t falling)
+{
+    int p = Sim_PortIndex(port);
+
+    if (p < 0)
+        return;
+
+    sim_exti_rising[p]  = rising  ? (sim_exti_rising[p]  | pins) : (sim_exti_rising[p]  & ~pins);
+    sim_exti_falling[p] = falling ? (sim_exti_falling[p] | pins) : (sim_exti_falling[p] & ~pins);
+
+    /* HAL_GPIO_Init in IT mode unmasks the line */
+    if (rising || falling)
+        EXTI->IMR |= pins;
+}
+
+/* ===== GPIO ===== */
+
+void Sim_Gpio_Input(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState level)
+{
+    int p = Sim_PortIndex(port);
+    uint32_t old = port->IDR;
+
+    if (level == GPIO_PIN_SET)
+        port->IDR = old | pin;
+    else
+        port->IDR = old & ~(uint32_t)pin;
+
+    if (p < 0 || ((old ^ port->IDR) & pin) == 0U)
+        return;
+
+    if (port == GPIOB && (pin & SIM_CAP_PIN))
+        Sim_CapEdge(level);
+
+    if ((EXTI->IMR & pin) &&
+        ((level == GPIO_PIN_SET   && (sim_exti_rising[p]  & pin)) ||
+         (level == GPIO_PIN_RESET && (sim_exti_falling[p] & pin)))) {
+        sim_stats.exti_events++;
+        HAL_GPIO_EXTI_Callback(pin);
+        Sim_PendSV();
+    }
+}
+
+GPIO_PinState Sim_Gpio_Output(GPIO_TypeDef *port, uint16_t pin)
+{
+    return (port->ODR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+uint32_t Sim_Gpio_Toggles(GPIO_TypeDef *port, uint16_t pin)
+{
+    int p = Sim_PortIndex(port);
+    return (p < 0) ? 0U : sim_toggles[p][Sim_PinIndex(pin)];
+}
+
+/* ===== USART2 ===== */
+
+uint32_t Sim_Uart_Take(uint8_t *out, uint32_t max)
+{
+    uint32_t n = 0;
+
+    while (n < max && sim_uart_cap_tail != sim_uart_cap_head)
+        out[n++] = sim_uart_capture[sim_uart_cap_tail++ % SIM_UART_CAPTURE];
+    return n;
+}
+
+uint8_t Sim_Uart_Busy(void)
+{
+    return sim_uart_done_ns != SIM_NO_EVENT;
+}
+
+uint32_t Sim_Uart_Rx(const uint8_t *data, uint32_t len)
+{
+    uint32_t n = 0;
+
+    /* line idle: the first new byte starts now */
+    if (sim_rx_wire_head == sim_rx_wire_tail) {
+        uint64_t start = (sim_now_ns > sim_rx_last_ns) ? sim_now_ns : sim_rx_last_ns;
+        sim_rx_next_ns = start + Sim_UartByteNs();
+    }
+
+    while (n < len && sim_rx_wire_head - sim_rx_wire_tail < SIM_UART_WIRE)
+        sim_rx_wire[sim_rx_wire_head++ % SIM_UART_WIRE] = data[n++];
+    return n;
+}
+
+uint32_t Sim_Uart_RxQueued(void)
+{
+    return sim_rx_wire_head - sim_rx_wire_tail;
+}
+
+/* overrun / framing error: HAL aborts the reception, then reports */
+void Sim_Uart_RxError(void)
+{
+    sim_rx_dst = NULL;
+    huart2.RxState = HAL_UART_STATE_READY;
+    HAL_UART_ErrorCallback(&huart2);
+}
+
+/* ===== TIM3 PWM LED ===== */
+
+uint8_t Sim_Pwm_Level(void)
+{
+    return (TIM3->CCER & TIM_CCER_CC3E) ? (uint8_t)TIM3->CCR3 : 0U;
+}
+
+/* ===== Statistics ===== */
+
+const SimStats_t *Sim_GetStats(void)
+{
+    return &sim_stats;
+}
+
+/* ===== HAL shim ===== */
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    uint32_t old = GPIOx->ODR;
+
+    if (PinState != GPIO_PIN_RESET)
+        GPIOx->ODR = old | GPIO_Pin;
+    else
+        GPIOx->ODR = old & ~(uint32_t)GPIO_Pin;
+
+    Sim_OutputChanged(GPIOx, old);
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    uint32_t old = GPIOx->ODR;
+
+    GPIOx->ODR = old ^ GPIO_Pin;
+    Sim_OutputChanged(GPIOx, old);
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    if (huart != &huart2 || pData == NULL || Size == 0U)
+        return HAL_ERROR;
+    if (sim_uart_done_ns != SIM_NO_EVENT)
+        return HAL_BUSY;
+
+    sim_uart_dma_src = pData;
+    sim_uart_dma_len = Size;
+    sim_uart_done_ns = sim_now_ns +
+                       ((uint64_t)Size * 10U * 1000000000ULL) / huart->Init.BaudRate;
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    huart->Instance->SR &= ~USART_SR_TC;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if (huart != &huart2 || pData == NULL || Size == 0U)
+        return HAL_ERROR;
+    if (huart->RxState != HAL_UART_STATE_READY)
+        return HAL_BUSY;
+
+    sim_rx_dst  = pData;
+    sim_rx_size = Size;
+    sim_rx_pos  = 0;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    return HAL_OK;
+}
+
+void Sim_Tim_SetCompare(TIM_HandleTypeDef *htim, uint32_t channel, uint32_t value)
+{
+    (&htim->Instance->CCR1)[channel >> 2] = value;
+    if (htim->Instance == TIM3)
+        sim_stats.pwm_cpu_writes++;
+}
+
+/* TIM3 channel 3 only, HAL channel-state rules */
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    if (htim != &htim3 || Channel != TIM_CHANNEL_3)
+        return HAL_ERROR;
+    if (sim_pwm_busy)
+        return HAL_BUSY;
+
+    sim_pwm_busy = 1;
+    TIM3->CCER |= TIM_CCER_CC3E;
+    TIM3->CR1  |= TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    if (htim != &htim3 || Channel != TIM_CHANNEL_3)
+        return HAL_ERROR;
+
+    sim_pwm_busy = 0;
+    TIM3->CCER &= ~TIM_CCER_CC3E;
+    TIM3->CR1  &= ~TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+/* HAL_DMA_Start_IT enables TC and HT, memory bytes -> CCR3 */
+HAL_StatusTypeDef HAL_TIM_PWM_Start_DMA(TIM_HandleTypeDef *htim, uint32_t Channel,
+                                        const uint32_t *pData, uint16_t Length)
+{
+    if (htim != &htim3 || Channel != TIM_CHANNEL_3)
+        return HAL_ERROR;
+    if (sim_pwm_busy)
+        return HAL_BUSY;
+    if (pData == NULL || Length == 0U)
+        return HAL_ERROR;
+
+    sim_pwm_src  = (const uint8_t *)pData;
+    sim_pwm_len  = Length;
+    sim_pwm_busy = 1;
+    hdma_tim3_ch3.CNDTR = Length;
+    hdma_tim3_ch3.IT    = DMA_IT_TC | DMA_IT_HT;
+    sim_pwm_next_ns     = sim_now_ns + Sim_TimPeriodNs(TIM3);
+
+    TIM3->DIER |= TIM_DIER_CC3DE;
+    TIM3->CCER |= TIM_CCER_CC3E;
+    TIM3->CR1  |= TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop_DMA(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    if (htim != &htim3 || Channel != TIM_CHANNEL_3)
+        return HAL_ERROR;
+
+    TIM3->DIER &= ~TIM_DIER_CC3DE;
+    hdma_tim3_ch3.IT = 0;
+    return HAL_TIM_PWM_Stop(htim, Channel);
+}
+
+uint32_t Sim_Tim_GetCounter(TIM_HandleTypeDef *htim)
+{
+    return (htim->Instance == TIM4) ? Sim_Tim4Count() : htim->Instance->CNT;
+}
+
+/* TIM4 channels 1 / 2, peripheral halfwords -> pData; HAL_DMA_Start_IT
+   enables TC and HT, the first start also starts the counter */
+HAL_StatusTypeDef HAL_TIM_IC_Start_DMA(TIM_HandleTypeDef *htim, uint32_t Channel,
+                                       uint32_t *pData, uint16_t Length)
+{
+    unsigned ch = (Channel == TIM_CHANNEL_2) ? 1U : 0U;
+    DMA_HandleTypeDef *h = htim->hdma[ch + 1U];
+
+    if (htim != &htim4 || (Channel != TIM_CHANNEL_1 && Channel != TIM_CHANNEL_2))
+        return HAL_ERROR;
+    if (pData == NULL || Length == 0U)
+        return HAL_ERROR;
+    if (sim_cap_dst[ch] != NULL)
+        return HAL_BUSY;
+
+    sim_cap_dst[ch] = (uint16_t *)(void *)pData;
+    sim_cap_len[ch] = Length;
+    h->CNDTR = Length;
+    h->IT    = DMA_IT_TC | DMA_IT_HT;
+
+    TIM4->DIER |= ch ? TIM_DIER_CC2DE : TIM_DIER_CC1DE;
+    TIM4->CCER |= ch ? TIM_CCER_CC2E : TIM_CCER_CC1E;
+    if (!(TIM4->CR1 & TIM_CR1_CEN)) {
+        sim_tim4_start_ns = sim_now_ns;
+        TIM4->CR1 |= TIM_CR1_CEN;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    return (hdma != NULL) ? HAL_OK : HAL_ERROR;
+}
+
+/* CMSIS: LOAD = ticks - 1, VAL cleared, counter and interrupt on;
+   the new period starts at the current virtual time */
+uint32_t SysTick_Config(uint32_t ticks)
+{
+    if ((ticks - 1U) > SysTick_LOAD_RELOAD_Msk)
+        return 1U;
+
+    SysTick->LOAD   = ticks - 1U;
+    SysTick->VAL    = ticks - 1U;
+    SysTick->CTRL   = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk |
+                      SysTick_CTRL_ENABLE_Msk;
+    sim_st_start_ns = sim_now_ns;
+    sim_st_period   = ticks;
+    sim_st_enabled  = 1;
+    sim_st_val_shown = SysTick->VAL;
+    return 0U;
+}
+
+/* ===== RCC: SYSCLK on HSI or the PLL, oscillators always ready ===== */
+
+void Sim_ModifyReg(volatile uint32_t *reg, uint32_t clear, uint32_t set)
+{
+    *reg = (*reg & ~clear) | set;
+    if (reg == &RCC->CFGR)
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SWS) | ((RCC->CFGR & RCC_CFGR_SW) << 2);
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+    return (RCC_OscInitStruct != NULL) ? HAL_OK : HAL_ERROR;
+}
+
+void SystemCoreClockUpdate(void)
+{
+    SystemCoreClock = ((RCC->CFGR & RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL) ? 64000000UL : HSI_VALUE;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void)
+{
+    return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return ((RCC->CFGR & RCC_CFGR_PPRE1) == RCC_CFGR_PPRE1_DIV2) ? SystemCoreClock / 2U
+                                                                  : SystemCoreClock;
+}
+
+/* back on the PLL, as after reset (ClkMgr_Restore) */
+void SystemClock_Config(void)
+{
+    MODIFY_REG(FLASH->ACR, FLASH_ACR_LATENCY, FLASH_LATENCY_2);
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_PPRE1 | RCC_CFGR_SW, RCC_CFGR_PPRE1_DIV2 | RCC_CFGR_SW_PLL);
+    SystemCoreClockUpdate();
+    SysTick->LOAD = SystemCoreClock / 1000U - 1U;
+    SysTick->VAL  = 0U;
+}
+
+/* WFI with PRIMASK set: a SysTick reload or TIM2 update that wakes
+   the core is done, so VAL / PENDSTSET and CNT / UIF read back as
+   on the target, its handler runs with the next Sim_Clock_Step;
+   other waking events fire there too */
+void HAL_PWR_EnterSLEEPMode(uint32_t Regulator, uint8_t SLEEPEntry)
+{
+    uint64_t wake;
+
+    (void)Regulator;
+    (void)SLEEPEntry;
+    sim_stats.sleeps++;
+
+    while (Sim_Clock_NextEventNs() < (wake = Sim_WakeNs()))
+        Sim_Clock_Step();
+
+    if (wake == SIM_NO_EVENT)
+        return;
+    Sim_SetNow(wake);
+    if (wake == Sim_SysTickNextNs())
+        Sim_SysTickReload(wake);
+    if (wake == Sim_Tim2NextNs())
+        Sim_Tim2Update(wake);
+}
+
+/* weak like the HAL originals: Core/Src/timebase.c overrides both */
+__attribute__((weak)) uint32_t HAL_GetTick(void)
+{
+    return sim_uw_tick;
+}
+
+__attribute__((weak)) void HAL_IncTick(void)
+{
+    sim_uw_tick++;
+}
+
+void Error_Handler(void)
+{
+    /* Target spins with IRQs disabled; on the host abort loudly */
+    __builtin_trap();
+}
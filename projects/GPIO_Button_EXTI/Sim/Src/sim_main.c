@@ -0,0 +1,2283 @@
+/*
+ * Host simulation runner
+ *
+ * Runs the unmodified application (app.c, fsm.c, button_fsm.c,
+ * button_bank.c, button_cap.c, led_fsm.c, led_seq.c) against the HAL
+ * shim and the virtual clock.
+ *
+ * Commands:
+ *  - run    : scripted button scenarios, checks LED behavior,
+ *             exit status != 0 if any scenario misbehaves
+ *  - bench  : tick-path and superloop throughput on the host
+ *  - trace  : scripted session, raw USART2 bytes (binary TRACE
+ *             records + log text) on stdout for Tools/trace_decode
+ *  - replay : recorded button edge traces (Sim/Traces) against
+ *             the button FSM, checks the gesture events
+ *
+ * Superloop model: App_Process() is called once after every
+ * virtual timer event, which is the worst case for the FSMs
+ * (they never observe more than one tick at a time).
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim_hal.h"
+#include "tim.h"
+#include "usart.h"
+#include "app.h"
+#include "ao.h"
+#include "boot.h"
+#include "clk_mgr.h"
+#include "defer.h"
+#include "tick.h"
+#include "button_bank.h"
+#include "button_cap.h"
+#include "sim_fsm_table.h"
+#include "sim_button_pt.h"
+#include "pt.h"
+#include "pool.h"
+#include "timebase.h"
+#include "idle.h"
+#include "swtimer.h"
+#include "uart_log.h"
+#include "uart_cmd.h"
+#include "kv_store.h"
+#include "trace.h"
+#include "led_fsm.h"
+#include "led_pwm.h"
+#include "led_seq.h"
+#include "led_wave.h"
+
+#define MS_NS(ms)   ((uint64_t)(ms) * 1000000ULL)
+
+typedef int (*SimScenarioFn)(void);
+
+/* superloop passes, and passes after which Idle_Run would sleep */
+static uint64_t sim_loops;
+static uint64_t sim_loops_idle;
+static uint64_t sim_loops_gated;   /* ... with nothing due, both ticks stopped */
+
+/* main loop blocked elsewhere: ISRs run, App_Process does not */
+static uint8_t sim_stalled;
+
+/* Idle_Run after every pass, as main.c does: WFI moves the clock */
+static uint8_t sim_idle;
+
+typedef struct {
+    const char   *name;
+    SimScenarioFn fn;
+} SimScenario_t;
+
+/* ===== Helpers ===== */
+
+static void Sim_RunMs(uint32_t ms)
+{
+    uint64_t end = Sim_Clock_NowNs() + MS_NS(ms);
+
+    while (Sim_Clock_NextEventNs() <= end) {
+        Sim_Clock_Step();
+        if (sim_stalled)
+            continue;
+        App_Process();
+        sim_loops++;
+        uint32_t next = App_NextDeadlineMs();
+        sim_loops_idle  += (next != 0U);
+        sim_loops_gated += (next == UINT32_MAX);
+        if (sim_idle) {
+            Sim_Clock_SleepUntil(end);
+            Idle_Run(App_NextDeadlineMs);
+        }
+    }
+    Sim_Clock_AdvanceTo(end);
+}
+
+static void Sim_Button(GPIO_PinState level)
+{
+    Sim_Gpio_Input(USER_BUTTON_GPIO_Port, USER_BUTTON_Pin, level);
+}
+
+/* capture-backed button on PB6, also active LOW */
+static void Sim_CapButton(GPIO_PinState level)
+{
+    Sim_Gpio_Input(CAP_BUTTON_GPIO_Port, CAP_BUTTON_Pin, level);
+}
+
+/* interrupts only: what a blocked main loop lets through */
+static void Sim_RunUs(uint32_t us)
+{
+    Sim_Clock_AdvanceTo(Sim_Clock_NowNs() + (uint64_t)us * 1000U);
+}
+
+/* USER button is active LOW with pull-up */
+static void Sim_Press(uint32_t hold_ms)
+{
+    Sim_Button(GPIO_PIN_RESET);
+    Sim_RunMs(hold_ms);
+    Sim_Button(GPIO_PIN_SET);
+}
+
+static uint32_t Sim_LedToggles(void)
+{
+    return Sim_Gpio_Toggles(LED_GPIO_Port, LED_Pin);
+}
+
+static GPIO_PinState Sim_Led(void)
+{
+    return Sim_Gpio_Output(LED_GPIO_Port, LED_Pin);
+}
+
+/* reset up to App_Init: App_InitLate not run yet, as the fast
+   start leaves it until after the first superloop pass */
+static void Sim_RestartEarly(void)
+{
+    Sim_Reset();
+    sim_stalled = 0;
+    sim_idle = 0;
+#if TICK_FAST_PATH
+    Sim_SetTim2Irq(Tick_IRQHandler);
+#endif
+    Sim_Exti_Config(USER_BUTTON_GPIO_Port, USER_BUTTON_Pin, 1, 1);
+    Sim_Exti_Config(CAP_BUTTON_GPIO_Port, CAP_BUTTON_Pin, 1, 1);
+    Sim_Button(GPIO_PIN_SET);
+    Sim_CapButton(GPIO_PIN_SET);
+    Log_Init();
+    App_Init();
+}
+
+/* reset without touching flash: settings survive */
+static void Sim_Restart(void)
+{
+    Sim_RestartEarly();
+    App_InitLate();
+}
+
+/* power-on with blank settings flash */
+static void Sim_Boot(void)
+{
+    Sim_Flash_Blank();
+    Sim_Restart();
+}
+
+static double Sim_WallSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* ===== Scenarios ===== */
+
+static int Scn_ShortPressBlinks(void)
+{
+    Sim_Boot();
+    Sim_Press(100);
+    Sim_RunMs(50);
+
+    uint32_t t0 = Sim_LedToggles();
+    Sim_RunMs(2000);
+
+    /* 500 ms blink period -> 4 toggles in 2 s */
+    return (Sim_LedToggles() - t0) == 4U;
+}
+
+static int Scn_SecondShortPressStops(void)
+{
+    Sim_Boot();
+    Sim_Press(100);
+    Sim_RunMs(1000);
+    Sim_Press(100);
+    Sim_RunMs(50 + BTN_MULTI_CLICK_MS);     /* SHORT once the double-click window closed */
+
+    uint32_t t0 = Sim_LedToggles();
+    Sim_RunMs(2000);
+
+    return (Sim_LedToggles() == t0) && (Sim_Led() == GPIO_PIN_RESET);
+}
+
+static int Scn_LongPressForcesOn(void)
+{
+    Sim_Boot();
+    Sim_Press(2500);
+    Sim_RunMs(50);
+
+    uint32_t t0 = Sim_LedToggles();
+    Sim_RunMs(1000);
+
+    return (Sim_LedToggles() == t0) && (Sim_Led() == GPIO_PIN_SET);
+}
+
+static int Scn_MultiClickGestures(void)
+{
+    int ok = 1;
+
+    /* double click -> breathing PWM LED, LD2 dark */
+    Sim_Boot();
+    Sim_Press(100);
+    Sim_RunMs(150);
+    Sim_Press(100);
+    Sim_RunMs(BTN_MULTI_CLICK_MS + 50U);
+    ok &= (Kv_GetU32(KV_KEY_LED_MODE, 99U) == LED_MODE_BREATHE) && LedPwm_Active();
+    ok &= (Sim_Led() == GPIO_PIN_RESET);
+
+    /* triple click -> heartbeat on LD2: 2 pulses per second */
+    Sim_Press(100);
+    Sim_RunMs(150);
+    Sim_Press(100);
+    Sim_RunMs(150);
+    Sim_Press(100);
+    Sim_RunMs(50);
+    uint32_t t0 = Sim_LedToggles();
+    Sim_RunMs(3000);
+    ok &= (Sim_LedToggles() - t0 == 12U) && !LedPwm_Active();
+    return ok;
+}
+
+static int Scn_GlitchIgnored(void)
+{
+    Sim_Boot();
+
+    /* contact bounce well below BTN_DEBOUNCE_MS */
+    for (int i = 0; i < 5; i++) {
+        Sim_Press(2);
+        Sim_RunMs(60);
+    }
+
+    return (Sim_LedToggles() == 0U) && (Sim_Led() == GPIO_PIN_RESET);
+}
+
+static int Scn_IdleDeadlines(void)
+{
+    int ok;
+
+    Sim_Boot();
+    Sim_RunMs(100);
+    ok = (App_NextDeadlineMs() == UINT32_MAX);
+
+    /* debounce and long-press wait need timer ticks */
+    Sim_Button(GPIO_PIN_RESET);
+    ok &= (App_NextDeadlineMs() != UINT32_MAX);
+    Sim_RunMs(500);
+    ok &= (App_NextDeadlineMs() != UINT32_MAX);
+
+    /* long press reached, LED on: waits for the release edge only */
+    Sim_RunMs(2000);
+    ok &= (App_NextDeadlineMs() == UINT32_MAX);
+    Sim_Button(GPIO_PIN_SET);
+    Sim_RunMs(100);
+    ok &= (App_NextDeadlineMs() == UINT32_MAX) && (Sim_Led() == GPIO_PIN_SET);
+
+    return ok;
+}
+
+/* idle run of 10 s: WFI wakeups / SysTick interrupts, timebase
+   error against the virtual clock in us */
+typedef struct {
+    uint64_t wakes;
+    uint64_t systicks;
+    int64_t  err_us;
+    uint32_t toggles;
+} SimIdleRun_t;
+
+static SimIdleRun_t Sim_IdleRun10s(void)
+{
+    SimIdleRun_t r;
+    uint64_t us0 = Timebase_NowUs();
+    uint64_t ns0 = Sim_Clock_NowNs();
+
+    r.wakes    = Sim_GetStats()->sleeps;
+    r.systicks = Sim_GetStats()->systicks;
+    r.toggles  = Sim_LedToggles();
+    Sim_RunMs(10000);
+    r.wakes    = Sim_GetStats()->sleeps - r.wakes;
+    r.systicks = Sim_GetStats()->systicks - r.systicks;
+    r.toggles  = Sim_LedToggles() - r.toggles;
+    r.err_us   = (int64_t)(Timebase_NowUs() - us0) - (int64_t)((Sim_Clock_NowNs() - ns0) / 1000U);
+    return r;
+}
+
+static int Scn_IdleTickless(void)
+{
+    SimIdleRun_t busy, blink, none, after;
+    int ok = 1;
+
+    /* 500 ms blink, the same 10 s spinning and with tickless idle */
+    Sim_Boot();
+    Sim_Press(100);
+    Sim_RunMs(50);
+    busy = Sim_IdleRun10s();
+
+    Sim_Boot();
+    sim_idle = 1;
+    Idle_Init();
+    Sim_Press(100);
+    Sim_RunMs(50);
+    blink = Sim_IdleRun10s();
+
+    ok &= (busy.toggles == 20U) && (blink.toggles == busy.toggles);
+    ok &= (blink.err_us >= -1) && (blink.err_us <= 1);   /* exact to 1 us */
+    ok &= (blink.wakes <= 10U * 10U) && (blink.systicks <= 10U * 10U);
+
+    /* press while a stretched SLEEP is cut short: blinking stops */
+    Sim_Press(100);
+    Sim_RunMs(50 + BTN_MULTI_CLICK_MS);
+    after = Sim_IdleRun10s();
+    ok &= (after.toggles == 0U) && (Sim_Led() == GPIO_PIN_RESET);
+
+    /* nothing due: SysTick stopped, one wakeup at the end of the run */
+    Sim_Boot();
+    sim_idle = 1;
+    Idle_Init();
+    Sim_RunMs(100);
+    none = Sim_IdleRun10s();
+
+    ok &= (none.wakes <= 10U) && (none.systicks <= 10U);
+    ok &= (none.err_us > -1000) && (none.err_us < 1000);
+
+    /* ... and the press out of it starts the 500 ms blink on time */
+    Sim_Press(100);
+    Sim_RunMs(50);
+    after = Sim_IdleRun10s();
+    ok &= (after.toggles == 20U);
+
+    printf("       wakeups per idle second: blinking %.1f (SysTick %.1f), nothing due %.1f "
+           "(SysTick %.1f), spinning SysTick %.1f\n",
+           blink.wakes / 10.0, blink.systicks / 10.0, none.wakes / 10.0,
+           none.systicks / 10.0, busy.systicks / 10.0);
+    return ok;
+}
+
+/* USART2 baud for BRR at PCLK1, in thousandths off the request */
+static uint32_t Sim_BaudErrPermil(uint32_t pclk1)
+{
+    uint32_t actual = pclk1 / USART2->BRR;
+    uint32_t baud = huart2.Init.BaudRate;
+    uint32_t diff = (actual > baud) ? actual - baud : baud - actual;
+
+    return (uint32_t)(((uint64_t)diff * 1000U) / baud);
+}
+
+/* LOW is HSI 8 MHz, PCLK1 8 MHz: 921600 needs BRR 8.7, refused */
+static int Scn_ClockLowBaud(void)
+{
+    ClkMgrStats_t cs;
+    uint32_t brr, toggles;
+    int ok = 1;
+
+    huart2.Init.BaudRate = 921600U;
+    Sim_Boot();
+    ClkMgr_Init();
+    brr = USART2->BRR;
+
+    ok &= (ClkMgr_Request(CLK_LEVEL_LOW) == 0U) && (ClkMgr_Request(CLK_LEVEL_LOW) == 0U);
+    ClkMgr_GetStats(&cs);
+    ok &= (cs.baud_refused == 2U) && (cs.downs == 0U) && (cs.deferred == 0U);
+    ok &= (ClkMgr_Level() == CLK_LEVEL_HIGH) && (SystemCoreClock == 64000000U);
+    ok &= (USART2->BRR == brr) && (Sim_BaudErrPermil(HAL_RCC_GetPCLK1Freq()) < 25U);
+
+    /* 115200 fits (BRR 69, 0.6 % fast): down and up, blink on time */
+    huart2.Init.BaudRate = 115200U;
+    Sim_Boot();
+    ClkMgr_Init();
+    brr = USART2->BRR;
+    Sim_Press(100);
+    Sim_RunMs(50);
+    while (ClkMgr_Request(CLK_LEVEL_LOW) == 0U)
+        Sim_RunMs(1);
+
+    ok &= (SystemCoreClock == HSI_VALUE) && (HAL_RCC_GetPCLK1Freq() == HSI_VALUE);
+    ok &= (USART2->BRR >= 16U) && (Sim_BaudErrPermil(HSI_VALUE) < 25U);
+    toggles = Sim_LedToggles();
+    Sim_RunMs(2000);
+    ok &= (Sim_LedToggles() - toggles == 4U);
+
+    while (ClkMgr_Request(CLK_LEVEL_HIGH) == 0U)
+        Sim_RunMs(1);
+    ClkMgr_GetStats(&cs);
+    ok &= (cs.baud_refused == 0U) && (cs.downs == 1U) && (cs.ups == 1U) && (cs.fails == 0U);
+    ok &= (SystemCoreClock == 64000000U) && (USART2->BRR == brr);
+    ok &= (TIM2->PSC == 64000U - 1U);
+    toggles = Sim_LedToggles();
+    Sim_RunMs(2000);
+    ok &= (Sim_LedToggles() - toggles == 4U);
+    return ok;
+}
+
+static int Scn_TimebaseMicroseconds(void)
+{
+    uint64_t us0, ns0;
+    int ok = 1;
+
+    Sim_Boot();
+    Sim_RunMs(10);
+    us0 = Timebase_NowUs();
+    ns0 = Sim_Clock_NowNs();
+
+    /* arbitrary sub-millisecond offsets, monotonic and exact to 1 us */
+    for (uint64_t step_ns = 1000; step_ns < MS_NS(50); step_ns = step_ns * 3U + 7000U) {
+        uint64_t prev = Timebase_NowUs();
+
+        Sim_Clock_AdvanceTo(Sim_Clock_NowNs() + step_ns);
+        ok &= (Timebase_NowUs() >= prev);
+        ok &= (Timebase_NowUs() - us0 == (Sim_Clock_NowNs() - ns0) / 1000U);
+    }
+
+    ok &= (Timebase_NowMs64() == Timebase_NowUs() / 1000U);
+    return ok;
+}
+
+/* ===== Software timer scenarios ===== */
+
+typedef struct {
+    uint32_t fired;
+    uint32_t last_ms;
+} SimTimerLog_t;
+
+static void Sim_TimerCb(void *arg)
+{
+    SimTimerLog_t *log = arg;
+
+    log->fired++;
+    log->last_ms = Timebase_NowMs();
+}
+
+static int Scn_SwTimerWheel(void)
+{
+    SimTimerLog_t once = {0}, every = {0}, stopped = {0}, far = {0};
+    SwTimer_t *t_once, *t_every, *t_stopped, *t_far;
+    uint32_t t0;
+    int ok = 1;
+
+    Sim_Boot();
+    t0 = Timebase_NowMs();
+
+    t_once    = SwTimer_Alloc(Sim_TimerCb, &once);
+    t_every   = SwTimer_Alloc(Sim_TimerCb, &every);
+    t_stopped = SwTimer_Alloc(Sim_TimerCb, &stopped);
+    t_far     = SwTimer_Alloc(Sim_TimerCb, &far);
+
+    SwTimer_Start(t_once, 100, 0);
+    SwTimer_Start(t_every, 30, 30);
+    SwTimer_Start(t_stopped, 50, 0);
+    SwTimer_Start(t_far, 600000, 0);    /* beyond the wheel range: parked */
+    SwTimer_Stop(t_stopped);
+
+    Sim_RunMs(1000);
+    ok &= (once.fired == 1U) && (once.last_ms - t0 == 100U);
+    ok &= (every.fired == 33U) && (stopped.fired == 0U);
+
+    SwTimer_Stop(t_every);
+    ok &= (SwTimer_ActiveCount() == 1U);
+
+    Sim_RunMs(600000U - 1000U + 10U);
+    ok &= (far.fired == 1U) && (far.last_ms - t0 == 600000U);
+    ok &= (SwTimer_ActiveCount() == 0U) && (App_NextDeadlineMs() == UINT32_MAX);
+
+    SwTimer_Free(t_once);
+    SwTimer_Free(t_every);
+    SwTimer_Free(t_stopped);
+    SwTimer_Free(t_far);
+    return ok;
+}
+
+static int Scn_LogDmaChain(void)
+{
+    static uint8_t expect[2048], got[2048];
+    uint8_t big[900];
+    uint32_t n = 0;
+    LogStats_t st;
+    int ok = 1;
+
+    Sim_Boot();
+
+    /* 540 bytes of lines, queued while the first chunk is on the wire */
+    for (int i = 0; i < 60; i++) {
+        ok &= (Log_Printf("line %03d\n", i) == 9);
+        n += (uint32_t)snprintf((char *)&expect[n], sizeof(expect) - n, "line %03d\n", i);
+    }
+
+    /* does not fit next to 540 queued bytes: dropped as a whole */
+    ok &= (Log_Write(big, 600) == 0U);
+
+    Sim_RunMs(100);
+    ok &= (Log_Pending() == 0U);
+
+    /* wraps the ring: two chained DMA chunks */
+    for (uint32_t i = 0; i < sizeof(big); i++)
+        big[i] = (uint8_t)(i * 7U + 1U);
+    ok &= (Log_Write(big, sizeof(big)) == 1U);
+    memcpy(&expect[n], big, sizeof(big));
+    n += sizeof(big);
+
+    Sim_RunMs(150);
+    Log_GetStats(&st);
+
+    ok &= (Sim_Uart_Take(got, sizeof(got)) == n) && (memcmp(got, expect, n) == 0);
+    ok &= (st.msgs_dropped == 1U) && (st.bytes_dropped == 600U);
+    ok &= (st.dma_chunks >= 3U) && (st.dma_errors == 0U) && !Sim_Uart_Busy();
+    return ok;
+}
+
+static int Scn_TraceRecords(void)
+{
+    uint8_t got[64];
+    uint32_t hdr, ts, btn, arg, n, t0;
+    int ok = 1;
+
+    Sim_Boot();
+    t0 = HAL_GetTick();
+    Sim_Press(100);
+    Sim_RunMs(50 + BTN_MULTI_CLICK_MS);
+
+    /* one record: header, timestamp, button tag, led mode */
+    n = Sim_Uart_Take(got, sizeof(got));
+    ok &= (n == 16U);
+    memcpy(&hdr, &got[0], sizeof(hdr));
+    memcpy(&ts,  &got[4], sizeof(ts));
+    memcpy(&btn, &got[8], sizeof(btn));
+    memcpy(&arg, &got[12], sizeof(arg));
+
+    ok &= ((hdr & 0xFFU) == TRACE_SYNC) && (((hdr >> 8) & 0xFFU) == 2U);
+    ok &= (strcmp(__start_trace_fmt + (hdr >> 16), "button %u short -> led mode %u\n") == 0);
+    ok &= (ts - t0 >= 100U + BTN_MULTI_CLICK_MS) && (ts - t0 <= 150U + BTN_MULTI_CLICK_MS) &&
+          (btn == 0U) && (arg == LED_MODE_BLINK);
+    return ok;
+}
+
+static void Sim_UartSend(const char *text)
+{
+    (void)Sim_Uart_Rx((const uint8_t *)text, (uint32_t)strlen(text));
+}
+
+/* 2000 echo commands back-to-back at 921600, main loop stalls 2 ms in 10 */
+static int Scn_CmdEcho921600(void)
+{
+    static char stream[32768], expect[16384], got[16384];
+    const uint32_t lines = 2000U;
+    uint32_t s = 0, e = 0, n;
+    CmdStats_t st;
+    int ok = 1;
+
+    huart2.Init.BaudRate = 921600U;
+    Sim_Boot();
+
+    for (uint32_t i = 0; i < lines; i++) {
+        s += (uint32_t)snprintf(&stream[s], sizeof(stream) - s, "echo %04u\n", i);
+        e += (uint32_t)snprintf(&expect[e], sizeof(expect) - e, "%04u\r\n", i);
+    }
+    ok &= (Sim_Uart_Rx((const uint8_t *)stream, s) == s);
+
+    while (Sim_Uart_RxQueued() != 0U || Cmd_Pending() || Log_Pending() != 0U) {
+        sim_stalled = 1;
+        Sim_RunMs(2);
+        sim_stalled = 0;
+        Sim_RunMs(8);
+    }
+
+    n = Sim_Uart_Take((uint8_t *)got, sizeof(got));
+    Cmd_GetStats(&st);
+    huart2.Init.BaudRate = 115200U;
+
+    ok &= (n == e) && (memcmp(got, expect, e) == 0);
+    ok &= (st.frames == lines) && (st.rx_bytes == s);
+    ok &= (st.overflows == 0U) && (st.too_long == 0U) && (st.wrap_copies != 0U);
+    ok &= (st.no_memory == 0U);
+    /* HT / TC / IDLE only: ~2 events per CMD_RX_BUF_SIZE bytes */
+    ok &= (Sim_GetStats()->uart_rx_events * 64U < s);
+    return ok;
+}
+
+static int Scn_CmdErrorsRecover(void)
+{
+    static char flood[4096], got[4096];
+    uint32_t n;
+    CmdStats_t st;
+    int ok = 1;
+
+    Sim_Boot();
+
+    Sim_UartSend("led on\r\nbogus\n");
+    Sim_RunMs(20);
+    ok &= (Sim_Led() == GPIO_PIN_SET);
+
+    /* receiver error in the middle of a line: line dropped, restart */
+    Sim_UartSend("led bl");
+    Sim_RunMs(2);
+    Sim_Uart_RxError();
+    Sim_UartSend("ink\nled blink\n");
+    Sim_RunMs(20);
+
+    /* main loop stalled while 2 KB arrive: overwrite detected */
+    memset(flood, 'x', sizeof(flood));
+    for (uint32_t i = 63; i < 2048U; i += 64U)
+        flood[i] = '\n';
+    sim_stalled = 1;
+    (void)Sim_Uart_Rx((const uint8_t *)flood, 2048U);
+    Sim_RunMs(200);
+    sim_stalled = 0;
+    Sim_UartSend("\nled off\n");
+    Sim_RunMs(100);
+
+    n = Sim_Uart_Take((uint8_t *)got, sizeof(got) - 1U);
+    got[n] = '\0';
+    Cmd_GetStats(&st);
+
+    ok &= (strncmp(got, "OK\r\nERR unknown 'bogus'\r\nOK\r\n", 29) == 0);
+    ok &= (st.uart_errors == 1U) && (st.overflows >= 1U);
+    ok &= (strstr(got, "ERR unknown 'xxx") != NULL) && (strcmp(&got[n - 4U], "OK\r\n") == 0);
+    ok &= (Sim_Led() == GPIO_PIN_RESET);
+    return ok;
+}
+
+static int Scn_KvSettingsSurviveReset(void)
+{
+    char got[256];
+    int ok = 1;
+
+    Sim_Boot();
+    Sim_Press(100);                         /* -> blink */
+    Sim_UartSend("cfg debounce 40\n");
+    Sim_RunMs(50 + BTN_MULTI_CLICK_MS);
+    ok &= (Sim_Uart_Take((uint8_t *)got, sizeof(got)) != 0U);
+
+    Sim_Restart();
+    uint32_t t0 = Sim_LedToggles();
+    Sim_RunMs(1000);
+
+    ok &= (Sim_LedToggles() - t0 >= 2U);    /* still blinking */
+    ok &= (Kv_GetU32(KV_KEY_DEBOUNCE_MS, 0) == 40U);
+    ok &= (Kv_GetU32(KV_KEY_LED_MODE, 0) == LED_MODE_BLINK);
+    return ok;
+}
+
+/* boot fast start: one superloop pass before the settings load */
+static int Scn_KvSettingsDeferredLoad(void)
+{
+    char got[256];
+    int ok = 1;
+
+    Sim_Boot();
+    Sim_UartSend("cfg debounce 40\n");
+    Sim_Press(100);                         /* -> blink */
+    Sim_RunMs(50 + BTN_MULTI_CLICK_MS);
+    ok &= (Sim_Uart_Take((uint8_t *)got, sizeof(got)) != 0U);
+
+    Sim_RestartEarly();
+    App_Process();
+    App_InitLate();
+
+    uint32_t t0 = Sim_LedToggles();
+    Sim_RunMs(1000);
+    ok &= (Sim_LedToggles() - t0 >= 2U);    /* blinking restored */
+
+    /* a short with the compiled-in 30 ms, a glitch with the stored 40 */
+    Sim_Press(35);
+    Sim_RunMs(50 + BTN_MULTI_CLICK_MS);
+    t0 = Sim_LedToggles();
+    Sim_RunMs(1000);
+    ok &= (Sim_LedToggles() - t0 >= 2U);
+    return ok;
+}
+
+#define KV_TEST_KEYS     8U
+#define KV_TEST_UPDATES  900U
+
+static uint32_t kv_committed[KV_TEST_KEYS + 1U];
+static uint32_t kv_inflight_key, kv_inflight_val;
+
+static void Sim_KvWorkload(void)
+{
+    for (uint32_t i = 0; i < KV_TEST_UPDATES; i++) {
+        /* keys 1..4 change often, 5..8 rarely: compaction has to move them */
+        uint32_t key = (i % 128U == 127U) ? 5U + (i / 128U) % 4U : 1U + i % 4U;
+
+        kv_inflight_key = key;
+        kv_inflight_val = key * 1000U + i;
+        (void)Kv_SetU32((uint16_t)key, kv_inflight_val);
+        kv_committed[key] = kv_inflight_val;
+    }
+    kv_inflight_key = 0;
+}
+
+static void Sim_KvBaseline(void)
+{
+    Sim_Flash_Blank();
+    Kv_Init();
+    for (uint32_t key = 1; key <= KV_TEST_KEYS; key++) {
+        kv_committed[key] = key * 1000U;
+        (void)Kv_SetU32((uint16_t)key, kv_committed[key]);
+    }
+}
+
+/* power fails at every flash operation of 600 updates (incl. compactions) */
+static int Scn_KvPowerLoss(void)
+{
+    static jmp_buf env;
+    uint32_t ops, pgerr0 = Sim_Flash_ProgramErrors();
+    KvStats_t st;
+    int ok = 1;
+
+    Sim_KvBaseline();
+    ops = Sim_Flash_Ops();
+    Sim_KvWorkload();
+    ops = Sim_Flash_Ops() - ops;
+    Kv_GetStats(&st);
+    ok &= (st.page_erases >= 3U) && (st.gc_copies != 0U);
+
+    for (uint32_t n = 1; n <= ops && ok; n++) {
+        Sim_KvBaseline();
+        if (setjmp(env) == 0) {
+            Sim_Flash_PowerLossAfter(n, &env);
+            Sim_KvWorkload();
+        }
+        Sim_Flash_PowerLossAfter(0, NULL);
+
+        /* reboot: every key holds its last committed or its in-flight value */
+        Kv_Init();
+        for (uint32_t key = 1; key <= KV_TEST_KEYS; key++) {
+            uint32_t v = Kv_GetU32((uint16_t)key, 0);
+
+            ok &= (v == kv_committed[key]) ||
+                  (key == kv_inflight_key && v == kv_inflight_val);
+        }
+
+        /* still writable, survives another boot */
+        ok &= Kv_SetU32(1, 0xC0FFEEU);
+        Kv_Init();
+        ok &= (Kv_GetU32(1, 0) == 0xC0FFEEU);
+    }
+
+    ok &= (Sim_Flash_ProgramErrors() == pgerr0);
+    return ok;
+}
+
+static int Scn_LedPwmWaveforms(void)
+{
+    char got[64];
+    SimStats_t s0;
+    uint8_t lo = 255U, hi = 0U;
+    int ok = 1;
+
+    Sim_Boot();
+    Sim_UartSend("led breathe\n");
+    Sim_RunMs(20);
+    s0 = *Sim_GetStats();
+
+    /* two full periods, sampled every PWM period */
+    for (uint32_t i = 0; i < 2U * LED_WAVE_BREATHE_LEN; i++) {
+        Sim_RunMs(LED_WAVE_STEP_MS);
+        if (Sim_Pwm_Level() < lo)
+            lo = Sim_Pwm_Level();
+        if (Sim_Pwm_Level() > hi)
+            hi = Sim_Pwm_Level();
+    }
+    ok &= (lo == 0U) && (hi == LED_PWM_MAX) && (Sim_Led() == GPIO_PIN_RESET);
+    ok &= (Sim_GetStats()->pwm_dma_steps - s0.pwm_dma_steps == 2U * LED_WAVE_BREATHE_LEN);
+    ok &= (Sim_GetStats()->pwm_cpu_writes == s0.pwm_cpu_writes);
+    ok &= (Sim_GetStats()->pwm_dma_irqs == 0U);
+    ok &= (App_NextDeadlineMs() == UINT32_MAX);     /* nothing to wake up for */
+
+    /* one-shot ramp stops on its last sample */
+    Sim_UartSend("led fade in\n");
+    Sim_RunMs(LED_WAVE_FADE_LEN * LED_WAVE_STEP_MS + 50U);
+    s0 = *Sim_GetStats();
+    Sim_RunMs(100);
+    ok &= (Sim_Pwm_Level() == LED_PWM_MAX) && LedPwm_Active();
+    ok &= (Sim_GetStats()->pwm_dma_steps == s0.pwm_dma_steps);
+
+    Sim_UartSend("led dim 50\n");
+    Sim_RunMs(20);
+    ok &= (Sim_Pwm_Level() == led_gamma[50]) && (Kv_GetU32(KV_KEY_LED_LEVEL, 0) == 50U);
+
+    Sim_UartSend("led fade out\n");
+    Sim_RunMs(LED_WAVE_FADE_LEN * LED_WAVE_STEP_MS + 50U);
+    ok &= (Sim_Pwm_Level() == 0U) && !LedPwm_Active();
+
+    ok &= (Sim_Uart_Take((uint8_t *)got, sizeof(got)) == 16U) &&
+          (memcmp(got, "OK\r\nOK\r\nOK\r\nOK\r\n", 16) == 0);
+    ok &= (Sim_GetStats()->pwm_dma_irqs == 0U);
+    return ok;
+}
+
+static int Scn_EventQueueBurst(void)
+{
+    const EvQueue_t *q;
+    uint32_t t0;
+
+    Sim_Boot();
+
+    /* 10 bounces = 20 EXTI edges while the main loop is stalled;
+       the buttons AO startup poll still holds one of the 16 slots */
+    sim_stalled = 1;
+    for (int i = 0; i < 10; i++) {
+        Sim_Button(GPIO_PIN_RESET);
+        Sim_RunMs(1);
+        Sim_Button(GPIO_PIN_SET);
+        Sim_RunMs(1);
+    }
+    Sim_Button(GPIO_PIN_RESET);
+    Sim_RunMs(10);
+    sim_stalled = 0;
+
+    /* the held press is still detected once the loop catches up */
+    Sim_RunMs(100);
+    Sim_Button(GPIO_PIN_SET);
+    Sim_RunMs(50);
+    t0 = Sim_LedToggles();
+    Sim_RunMs(1000);
+
+    q = App_EventQueue();
+    return (EvQ_HighWater(q) == 16U) && (EvQ_Overflows(q) == 6U) &&
+           (EvQ_Count(q) == 0U) && (Sim_LedToggles() - t0 == 2U);
+}
+
+/* gestures on the capture button while the main loop is blocked */
+static int Scn_CapButtonStalled(void)
+{
+    BtnCapStats_t cs;
+    int ok = 1;
+
+    Sim_Boot();
+    Sim_RunMs(10);
+    ok &= (BtnCap_NextDeadlineMs() == BTN_CAP_NO_DEADLINE);
+
+    /* double click, first press bouncing; nothing runs but ISRs */
+    sim_stalled = 1;
+    for (int i = 0; i < 3; i++) {
+        Sim_CapButton(GPIO_PIN_RESET);
+        Sim_RunUs(150);
+        Sim_CapButton(GPIO_PIN_SET);
+        Sim_RunUs(150);
+    }
+    Sim_CapButton(GPIO_PIN_RESET);
+    Sim_RunUs(80250);
+    Sim_CapButton(GPIO_PIN_SET);
+    Sim_RunUs(120000);
+    Sim_CapButton(GPIO_PIN_RESET);
+    Sim_RunUs(95125);
+    Sim_CapButton(GPIO_PIN_SET);
+    Sim_RunUs(BTN_MULTI_CLICK_MS * 1000U + 200000U);
+    sim_stalled = 0;
+    Sim_RunMs(10);
+
+    /* one wake-up, the edge stream replayed at its own times */
+    BtnCap_GetStats(&cs);
+    ok &= (Kv_GetU32(KV_KEY_LED_MODE, 99U) == LED_MODE_BREATHE);
+    ok &= (cs.edges == 10U) && (cs.wakes == 1U) && (cs.overflows == 0U) && (cs.resyncs == 0U);
+    ok &= (cs.last_press_us >= 95124U) && (cs.last_press_us <= 95126U);
+    ok &= (Sim_GetStats()->cap_dma_edges == 10U) && (Sim_GetStats()->cap_dma_irqs == 0U);
+    ok &= (BtnCap_NextDeadlineMs() == BTN_CAP_NO_DEADLINE);
+
+    /* same clicks on the EXTI / polled USER button: the queued edges
+       carry no time, the gesture is lost */
+    sim_stalled = 1;
+    Sim_Button(GPIO_PIN_RESET);
+    Sim_RunUs(80000);
+    Sim_Button(GPIO_PIN_SET);
+    Sim_RunUs(120000);
+    Sim_Button(GPIO_PIN_RESET);
+    Sim_RunUs(95000);
+    Sim_Button(GPIO_PIN_SET);
+    Sim_RunUs(BTN_MULTI_CLICK_MS * 1000U + 200000U);
+    sim_stalled = 0;
+    Sim_RunMs(10);
+    ok &= (Kv_GetU32(KV_KEY_LED_MODE, 99U) == LED_MODE_BREATHE);
+
+    /* a hold that ends inside the stall is still a hold */
+    sim_stalled = 1;
+    Sim_CapButton(GPIO_PIN_RESET);
+    Sim_RunUs(BTN_LONG_PRESS_MS * 1000U + 500000U);
+    Sim_CapButton(GPIO_PIN_SET);
+    Sim_RunUs(100000);
+    sim_stalled = 0;
+    Sim_RunMs(10);
+
+    BtnCap_GetStats(&cs);
+    ok &= (Kv_GetU32(KV_KEY_LED_MODE, 99U) == LED_MODE_ON) && (Sim_Led() == GPIO_PIN_SET);
+    ok &= (cs.last_press_us >= BTN_LONG_PRESS_MS * 1000U + 499999U) &&
+          (cs.last_press_us <= BTN_LONG_PRESS_MS * 1000U + 500001U);
+    ok &= (cs.wakes == 2U) && (BtnCap_NextDeadlineMs() == BTN_CAP_NO_DEADLINE);
+    return ok;
+}
+
+/* three test AOs above the application ones, dispatch order log */
+#define SIM_AO_LOG      16U
+
+enum { SIM_SIG_A = 1, SIM_SIG_B, SIM_SIG_C, SIM_SIG_PUB, SIM_SIG_HI, SIM_SIG_POLL };
+
+static Ao_t sim_ao_lo, sim_ao_mid, sim_ao_hi;
+static Event_t sim_ao_buf[3][4];
+static uint16_t sim_ao_log[SIM_AO_LOG];     /* prio << 8 | signal */
+static uint32_t sim_ao_n;
+
+static void Sim_AoHandler(Ao_t *me, const Event_t *evt)
+{
+    if (sim_ao_n < SIM_AO_LOG)
+        sim_ao_log[sim_ao_n++] = (uint16_t)((me->prio << 8) | evt->type);
+
+    /* posted while lower events are still queued: runs next */
+    if (me == &sim_ao_lo && evt->type == SIM_SIG_A)
+        (void)Ao_Post(&sim_ao_hi, SIM_SIG_HI, 0);
+}
+
+static const Ao_t *Sim_AoByName(const char *name)
+{
+    for (uint8_t prio = 1; prio <= AO_MAX_PRIO; prio++) {
+        const Ao_t *ao = Ao_Get(prio);
+
+        if (ao != NULL && strcmp(ao->name, name) == 0)
+            return ao;
+    }
+    return NULL;
+}
+
+static int Scn_ActiveObjects(void)
+{
+    static const uint16_t expect[] = {
+        (8 << 8) | SIM_SIG_PUB, (7 << 8) | SIM_SIG_C,  (6 << 8) | SIM_SIG_A,
+        (8 << 8) | SIM_SIG_HI,  (6 << 8) | SIM_SIG_B,  (6 << 8) | SIM_SIG_PUB,
+        (6 << 8) | SIM_SIG_POLL, (6 << 8) | SIM_SIG_POLL,
+    };
+    const Ao_t *buttons;
+    uint32_t ev0;
+    int ok = 1;
+
+    Sim_Boot();
+    Sim_RunMs(10);
+
+    /* idle application: the buttons AO is not called at all */
+    buttons = Sim_AoByName("buttons");
+    ok &= (buttons != NULL);
+    if (!ok)
+        return 0;
+    ev0 = buttons->events;
+    Sim_RunMs(10000);
+    ok &= (buttons->events == ev0);
+
+    /* a press wakes it for the gesture only, the LED follows */
+    Sim_Press(100);
+    Sim_RunMs(1000);
+    ok &= (buttons->events > ev0) && (Sim_LedToggles() > 0U);
+    ev0 = buttons->events;
+    Sim_RunMs(1000);
+    ok &= (buttons->events == ev0);
+
+    /* kernel: priority order, publish, coalesced notify */
+    sim_ao_n = 0;
+    ok &= Ao_Start(&sim_ao_lo,  "lo",  6, Sim_AoHandler, sim_ao_buf[0], 4);
+    ok &= Ao_Start(&sim_ao_mid, "mid", 7, Sim_AoHandler, sim_ao_buf[1], 4);
+    ok &= Ao_Start(&sim_ao_hi,  "hi",  8, Sim_AoHandler, sim_ao_buf[2], 4);
+    ok &= !Ao_Start(&sim_ao_hi, "dup", 8, Sim_AoHandler, sim_ao_buf[2], 4);
+    Ao_Subscribe(&sim_ao_lo, SIM_SIG_PUB);
+    Ao_Subscribe(&sim_ao_hi, SIM_SIG_PUB);
+
+    ok &= Ao_Post(&sim_ao_lo, SIM_SIG_A, 0) && Ao_Post(&sim_ao_lo, SIM_SIG_B, 0);
+    ok &= Ao_Post(&sim_ao_mid, SIM_SIG_C, 0);
+    ok &= (Ao_Publish(SIM_SIG_PUB, 0) == 2U);
+    for (int i = 0; i < 3; i++)
+        ok &= Ao_NotifyFromIsr(&sim_ao_lo, SIM_SIG_POLL);
+    ok &= (EvQ_Count(&sim_ao_lo.queue) == 4U) && Ao_Ready();
+    ok &= !Ao_Post(&sim_ao_lo, SIM_SIG_A, 0);      /* full: dropped, counted */
+    ok &= (EvQ_Overflows(&sim_ao_lo.queue) == 1U);
+
+    Ao_Run();
+    /* re-armed once handled */
+    ok &= Ao_Notify(&sim_ao_lo, SIM_SIG_POLL);
+    Ao_Run();
+
+    ok &= !Ao_Ready() && (sim_ao_n == sizeof(expect) / sizeof(expect[0]));
+    ok &= (memcmp(sim_ao_log, expect, sizeof(expect)) == 0);
+    return ok;
+}
+
+/* two test work items, run order log; B schedules itself once more */
+static char sim_defer_log[8];
+static uint32_t sim_defer_n;
+static DeferWork_t sim_defer_b;
+
+static void Sim_DeferWork(void *arg)
+{
+    char tag = *(const char *)arg;
+
+    if (sim_defer_n < sizeof(sim_defer_log))
+        sim_defer_log[sim_defer_n++] = tag;
+    if (tag == 'b' && sim_defer_n < 3U)
+        (void)Defer_Schedule(&sim_defer_b);
+}
+
+static int Scn_DeferredWork(void)
+{
+    static DeferWork_t sim_defer_a = DEFER_WORK_INIT(Sim_DeferWork, "a");
+    DeferStats_t ds;
+    uint64_t pendsv;
+    int ok = 1;
+
+    Sim_Boot();
+    Sim_RunMs(10);
+
+    /* armed capture button: the tick schedules nothing */
+    pendsv = Sim_GetStats()->pendsv;
+    Sim_RunMs(1000);
+    ok &= (Sim_GetStats()->pendsv == pendsv) && !Defer_Pending();
+
+    /* edges with the loop stalled: converted from PendSV anyway */
+    sim_stalled = 1;
+    Sim_CapButton(GPIO_PIN_RESET);
+    Sim_RunUs(100000);
+    Sim_CapButton(GPIO_PIN_SET);
+    Sim_RunUs(10000);
+    ok &= (Sim_GetStats()->pendsv > pendsv) && !Defer_Pending();
+    sim_stalled = 0;
+    Sim_RunMs(BTN_MULTI_CLICK_MS + 100U);
+    ok &= (Kv_GetU32(KV_KEY_LED_MODE, 99U) == LED_MODE_BLINK);
+    ok &= (BtnCap_NextDeadlineMs() == BTN_CAP_NO_DEADLINE);
+
+    /* coalescing and order: a, a, b -> "abb", one exception */
+    Defer_Init();
+    sim_defer_b = (DeferWork_t)DEFER_WORK_INIT(Sim_DeferWork, "b");
+    sim_defer_n = 0;
+    ok &= Defer_Schedule(&sim_defer_a);
+    ok &= !Defer_Schedule(&sim_defer_a);
+    ok &= Defer_Schedule(&sim_defer_b);
+    ok &= Defer_Pending() && (sim_defer_n == 0U);
+
+    /* scheduled from the main loop: taken at the next emulated ISR */
+    pendsv = Sim_GetStats()->pendsv;
+    Sim_RunUs(1000);
+    Defer_GetStats(&ds);
+    ok &= (sim_defer_n == 3U) && (memcmp(sim_defer_log, "abb", 3) == 0);
+    ok &= (ds.scheduled == 3U) && (ds.coalesced == 1U) && (ds.runs == 3U);
+    ok &= (Sim_GetStats()->pendsv - pendsv <= 2U) && !Defer_Pending();
+    return ok;
+}
+
+/* pool.c: size classes, spill, exhaustion, bad frees, log on the pool */
+static int Scn_MemoryPool(void)
+{
+    static void *held[64];
+    static char got[2048];
+    uint32_t n = 0, classes, fails;
+    uint32_t blocks = 0;
+    PoolStats_t ps;
+    LogStats_t ls;
+    void *p, *q;
+    int ok = 1;
+
+    Sim_Boot();
+    Sim_UartSend("stats\n");
+    Sim_RunMs(50);
+    got[Sim_Uart_Take((uint8_t *)got, sizeof(got) - 1U)] = '\0';
+    ok &= (strstr(got, "pool  16 B used 0/16") != NULL);
+    ok &= (strstr(got, "sbrk refused 0") != NULL);
+
+    /* the log formats in a 128 B block and gives it back */
+    classes = Pool_ClassCount();
+    for (uint32_t c = 0; c < classes; c++) {
+        Pool_GetStats(c, &ps);
+        ok &= (ps.used == 0U) && (ps.fails == 0U);
+        blocks += ps.blocks;
+        if (ps.size == LOG_LINE_MAX)
+            ok &= (ps.allocs != 0U) && (ps.high_water == 1U);
+    }
+
+    /* smallest class that fits, 8-byte aligned, then spill upwards */
+    Pool_GetStats(0, &ps);
+    for (uint32_t i = 0; i < ps.blocks; i++) {
+        held[n] = Pool_Alloc(1U + i % ps.size);
+        ok &= (held[n] != NULL) && (((uintptr_t)held[n] & 7U) == 0U);
+        n++;
+    }
+    ok &= (held[0] != held[1]);
+    held[n] = Pool_Alloc(1);
+    ok &= (held[n] != NULL);
+    n++;
+    Pool_GetStats(1, &ps);
+    ok &= (ps.used == 1U) && (ps.spills == 1U);
+
+    /* until nothing is left: every block once, then NULL */
+    while (n < sizeof(held) / sizeof(held[0]) && (held[n] = Pool_Alloc(1)) != NULL)
+        n++;
+    ok &= (n == blocks) && (Pool_Alloc(1) == NULL);
+    Pool_GetStats(0, &ps);
+    ok &= (ps.fails >= 1U) && (ps.used == ps.blocks);
+
+    /* no block: the log drops the message instead of using the stack */
+    ok &= (Log_Printf("lost %u\r\n", 1U) < 0);
+    Log_GetStats(&ls);
+    ok &= (ls.msgs_dropped == 1U);
+
+    /* too big for any class: NULL, counted with the largest */
+    Pool_GetStats(classes - 1U, &ps);
+    ok &= (Pool_Alloc(ps.size + 1U) == NULL);
+    fails = ps.fails;
+    Pool_GetStats(classes - 1U, &ps);
+    ok &= (ps.fails == fails + 1U);
+
+    /* foreign, interior and double frees are ignored and counted */
+    p = &ls;
+    q = held[1];
+    Pool_Free(p);
+    Pool_Free((uint8_t *)q + 4);
+    Pool_Free(q);
+    Pool_Free(q);
+    Pool_Free(NULL);
+    ok &= (Pool_BadFrees() == 3U);
+    ok &= (Pool_Alloc(1) == q);
+
+    for (uint32_t i = 0; i < n; i++)
+        Pool_Free(held[i]);
+    ok &= (Pool_BadFrees() == 3U);
+    for (uint32_t c = 0; c < classes; c++) {
+        Pool_GetStats(c, &ps);
+        ok &= (ps.used == 0U) && (ps.high_water == ps.blocks);
+    }
+
+    /* the newlib heap is not used by the application code */
+    ok &= (Pool_SbrkRefused() == 0U);
+    return ok;
+}
+
+/* random press / bounce / hold input, same sequence on every run */
+typedef struct {
+    uint16_t dt_ms;         /* time since the previous step */
+    uint8_t  level;         /* 1 = pressed */
+    uint8_t  edge;          /* level changed at this step */
+} SimFsmStep_t;
+
+#define SIM_FSM_STEPS   (1U << 18)
+
+/* app.c APP_DEMO_STEP_MS */
+#define APP_DEMO_STEP_MS_SIM    1500U
+
+static SimFsmStep_t sim_fsm_steps[SIM_FSM_STEPS];
+
+static void Sim_FsmSteps(void)
+{
+    uint32_t lcg = 12345U;
+    uint8_t level = 0;
+
+    for (uint32_t i = 0; i < SIM_FSM_STEPS; i++) {
+        uint32_t r;
+
+        lcg = lcg * 1664525U + 1013904223U;
+        r = lcg >> 8;
+        /* mostly bounce / click spacing, sometimes a hold or a pause */
+        sim_fsm_steps[i].dt_ms = (uint16_t)(1U + ((r & 7U) == 0U ? (r >> 3) % 900U : (r >> 3) % 40U));
+        sim_fsm_steps[i].edge = ((r >> 16) % 5U) == 0U;
+        level ^= sim_fsm_steps[i].edge;
+        sim_fsm_steps[i].level = level;
+    }
+}
+
+static const ButtonProfile_t sim_fsm_gestures = BTN_PROFILE_INIT(30U, 600U, 300U, 250U);
+
+static uint8_t Sim_FsmRead(void)
+{
+    return 0;
+}
+
+/* the table candidate (sim_fsm_table.c) against button_fsm.c, step by step */
+static int Scn_FsmTableMatchesSwitch(void)
+{
+    static const ButtonProfile_t *const profiles[] = { &btn_profile_default, &sim_fsm_gestures };
+    uint32_t seen = 0;
+    int ok = 1;
+
+    Sim_FsmSteps();
+
+    for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+        ButtonCtx_t tab, ref;
+        uint32_t now = 0;
+
+        Button_Init(&tab, Sim_FsmRead);
+        Button_Init(&ref, Sim_FsmRead);
+        Button_SetProfile(&tab, profiles[p]);
+        Button_SetProfile(&ref, profiles[p]);
+
+        for (uint32_t i = 0; i < SIM_FSM_STEPS && ok; i++) {
+            const SimFsmStep_t *st = &sim_fsm_steps[i];
+            ButtonEvent_t a, b;
+
+            now += st->dt_ms;
+            if (st->edge) {
+                SimTab_OnEdgeAt(&tab, now);
+                Button_OnEdgeAt(&ref, now);
+            }
+            SimTab_ProcessAt(&tab, now, st->level);
+            Button_ProcessAt(&ref, now, st->level);
+
+            do {
+                a = Button_GetEvent(&tab);
+                b = Button_GetEvent(&ref);
+                ok &= (a == b);
+                seen |= 1UL << a;
+            } while (a != BTN_EVENT_NONE && ok);
+
+            ok &= (tab.state == ref.state) && (tab.clicks == ref.clicks);
+        }
+    }
+
+    /* every gesture event was exercised */
+    return ok && (seen == 0x7FU);
+}
+
+/* button_fsm.c against the coroutine rewrite (sim_button_pt.c), step by step */
+static int Scn_PtButtonMatchesFsm(void)
+{
+    static const ButtonProfile_t *const profiles[] = { &btn_profile_default, &sim_fsm_gestures };
+    uint32_t seen = 0;
+    int ok = 1;
+
+    Sim_FsmSteps();
+
+    for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+        ButtonCtx_t tab, cor;
+        SimPtButton_t pb;
+        uint32_t now = 0;
+
+        Button_Init(&tab, Sim_FsmRead);
+        Button_Init(&cor, Sim_FsmRead);
+        Button_SetProfile(&tab, profiles[p]);
+        Button_SetProfile(&cor, profiles[p]);
+        Pt_Init();
+        SimPt_ButtonStart(&pb, &cor);
+        Pt_RunAt(now);              /* to its first edge wait */
+
+        for (uint32_t i = 0; i < SIM_FSM_STEPS && ok; i++) {
+            const SimFsmStep_t *st = &sim_fsm_steps[i];
+            ButtonEvent_t a, b;
+
+            now += st->dt_ms;
+            if (st->edge) {
+                Button_OnEdgeAt(&tab, now);
+                SimPt_ButtonEdge(&pb, now);
+            }
+            Button_ProcessAt(&tab, now, st->level);
+            pb.level = st->level;
+            Pt_RunAt(now);
+
+            do {
+                a = Button_GetEvent(&tab);
+                b = Button_GetEvent(&cor);
+                ok &= (a == b);
+                seen |= 1UL << a;
+            } while (a != BTN_EVENT_NONE && ok);
+
+            ok &= (tab.clicks == cor.clicks);
+        }
+    }
+
+    /* `led demo`: six modes on a coroutine, then the stored mode */
+    Sim_Boot();
+    Sim_UartSend("led demo\n");
+    Sim_RunMs(100);
+    ok &= (Sim_Led() == GPIO_PIN_SET) && (Pt_NextDeadlineMs() <= APP_DEMO_STEP_MS_SIM);
+    Sim_RunMs(6U * APP_DEMO_STEP_MS_SIM);
+    ok &= (Sim_Led() == GPIO_PIN_RESET) && (Pt_NextDeadlineMs() == PT_NO_DEADLINE);
+    ok &= (Kv_GetU32(KV_KEY_LED_MODE, 99U) == LED_MODE_OFF);
+    ok &= (App_NextDeadlineMs() == UINT32_MAX);
+
+    /* a button during the demo takes the LED over, the demo ends */
+    Sim_UartSend("led demo\n");
+    Sim_RunMs(2000);
+    Sim_Press(100);
+    Sim_RunMs(10000);
+    ok &= (Kv_GetU32(KV_KEY_LED_MODE, 99U) == LED_MODE_BLINK);
+    ok &= (Pt_NextDeadlineMs() == PT_NO_DEADLINE);
+
+    /* every gesture event was exercised */
+    return ok && (seen == 0x7FU);
+}
+
+/* on-steps of `pat` that start before t_ms: rising edges from a dark LED */
+static uint32_t Sim_SeqEdges(const LedSeqPattern_t *pat, uint32_t t_ms)
+{
+    uint32_t t = 0, edges = 0;
+
+    for (;;) {
+        for (uint32_t pass = 0; pass < pat->count; pass++) {
+            for (uint32_t i = 0; i < pat->len; i++) {
+                if (t >= t_ms)
+                    return edges;
+                edges += (pat->steps[i] & 0x8000U) != 0U;
+                t += (pat->steps[i] & 0x7FFFU) * TICK_PERIOD_MS;
+            }
+        }
+        t += pat->gap * TICK_PERIOD_MS;
+    }
+}
+
+/* 14 LEDs on GPIOD: fault codes 1..12, SOS, heartbeat */
+#define SIM_SEQ_CHANNELS 14U
+
+static LedSeqChan_t sim_leds[SIM_SEQ_CHANNELS];
+
+static const LedSeqPattern_t *Sim_SeqPattern(uint32_t ch)
+{
+    if (ch < LED_SEQ_CODES)
+        return &led_pat_code[ch];
+    return (ch == LED_SEQ_CODES) ? &led_pat_sos : &led_pat_heartbeat;
+}
+
+static int Scn_LedSeqPatterns(void)
+{
+    const uint32_t window_ms = 20000U;
+    uint32_t edges[SIM_SEQ_CHANNELS] = { 0 };
+    uint16_t prev = 0;
+    uint32_t on_run = 0, off_run = 0, on_max = 0, off_max = 0;
+    GPIO_PinState last = GPIO_PIN_RESET;
+    int ok = 1;
+
+    /* fault code 3 on LD2: 3 x 200 ms pulses, 300 + 1500 ms dark */
+    Sim_Boot();
+    Sim_UartSend("led code 3\n");
+    Sim_RunMs(20);
+    ok &= (Sim_Led() == GPIO_PIN_SET) && (App_NextDeadlineMs() != UINT32_MAX);
+    for (uint32_t t = 0; t < 6000U; t += TICK_PERIOD_MS) {
+        Sim_RunMs(TICK_PERIOD_MS);
+        if (Sim_Led() != last) {
+            on_run = off_run = 0;
+            last = Sim_Led();
+        }
+        if (last == GPIO_PIN_SET && (on_run += TICK_PERIOD_MS) > on_max)
+            on_max = on_run;
+        if (last == GPIO_PIN_RESET && (off_run += TICK_PERIOD_MS) > off_max)
+            off_max = off_run;
+    }
+    ok &= (on_max == 200U) && (off_max == 1800U);
+    ok &= (Kv_GetU32(KV_KEY_LED_MODE, 99U) == 99U);     /* patterns are not stored */
+    Sim_UartSend("led off\n");
+    Sim_RunMs(20);
+    ok &= (Sim_Led() == GPIO_PIN_RESET) && (App_NextDeadlineMs() == UINT32_MAX);
+
+    /* every channel keeps its own pattern, edges match the tables */
+    for (uint32_t ch = 0; ch < SIM_SEQ_CHANNELS; ch++)
+        sim_leds[ch] = (LedSeqChan_t)LED_SEQ_CHANNEL(GPIOD, (uint16_t)(1U << ch));
+    LedSeq_Init(sim_leds, SIM_SEQ_CHANNELS);
+    for (uint32_t ch = 0; ch < SIM_SEQ_CHANNELS; ch++)
+        LedSeq_Play(ch, Sim_SeqPattern(ch));
+    for (uint32_t t = 0; t < window_ms; t += TICK_PERIOD_MS) {
+        uint16_t now, rise;
+
+        now  = (uint16_t)GPIOD->ODR;
+        rise = now & (uint16_t)~prev;
+        for (uint32_t ch = 0; ch < SIM_SEQ_CHANNELS; ch++)
+            edges[ch] += (rise >> ch) & 1U;
+        prev = now;
+        Sim_RunMs(TICK_PERIOD_MS);
+    }
+    for (uint32_t ch = 0; ch < SIM_SEQ_CHANNELS; ch++)
+        ok &= (edges[ch] == Sim_SeqEdges(Sim_SeqPattern(ch), window_ms));
+
+    for (uint32_t ch = 0; ch < SIM_SEQ_CHANNELS; ch++)
+        LedSeq_Stop(ch, 0);
+    ok &= (Sim_Gpio_Output(GPIOD, GPIO_PIN_All) == GPIO_PIN_RESET);
+    ok &= (LedSeq_NextDeadlineMs() == LED_SEQ_NO_DEADLINE);
+    return ok;
+}
+
+/* 32-key bank on GPIOB (lane 0) and GPIOD (lane 1), all active LOW */
+static ButtonBank_t sim_bank;
+
+static void Sim_BankTick(void)
+{
+    ButtonBank_OnTick(&sim_bank);
+}
+
+static void Sim_BankBoot(void)
+{
+    Sim_Boot();
+    Sim_Gpio_Input(GPIOB, GPIO_PIN_All, GPIO_PIN_SET);
+    Sim_Gpio_Input(GPIOD, GPIO_PIN_All, GPIO_PIN_SET);
+    ButtonBank_Init(&sim_bank, BTN_DEBOUNCE_MS, BTN_LONG_PRESS_MS);
+    ButtonBank_AddLane(&sim_bank, 0, &GPIOB->IDR, GPIO_PIN_All, GPIO_PIN_All);
+    ButtonBank_AddLane(&sim_bank, 1, &GPIOD->IDR, GPIO_PIN_All, GPIO_PIN_All);
+    Tick_Register(Sim_BankTick);
+}
+
+static void Sim_BankRunMs(uint32_t ms, uint32_t *short_mask, uint32_t *long_mask)
+{
+    for (uint32_t t = 0; t < ms; t += TICK_PERIOD_MS) {
+        Sim_RunMs(TICK_PERIOD_MS);
+        ButtonBank_Process(&sim_bank);
+        *short_mask |= ButtonBank_TakeEvents(&sim_bank, BTN_EVENT_SHORT);
+        *long_mask  |= ButtonBank_TakeEvents(&sim_bank, BTN_EVENT_LONG);
+    }
+}
+
+static int Scn_BankIndependentKeys(void)
+{
+    uint32_t short_mask = 0, long_mask = 0;
+
+    Sim_BankBoot();
+
+    /* key 20 held long, key 0 tapped meanwhile, key 31 only bounces */
+    Sim_Gpio_Input(GPIOD, GPIO_PIN_4, GPIO_PIN_RESET);
+    Sim_BankRunMs(200, &short_mask, &long_mask);
+    Sim_Gpio_Input(GPIOB, GPIO_PIN_0, GPIO_PIN_RESET);
+    Sim_BankRunMs(100, &short_mask, &long_mask);
+    Sim_Gpio_Input(GPIOB, GPIO_PIN_0, GPIO_PIN_SET);
+    for (int i = 0; i < 5; i++) {
+        Sim_Gpio_Input(GPIOD, GPIO_PIN_15, GPIO_PIN_RESET);
+        Sim_BankRunMs(4, &short_mask, &long_mask);
+        Sim_Gpio_Input(GPIOD, GPIO_PIN_15, GPIO_PIN_SET);
+        Sim_BankRunMs(10, &short_mask, &long_mask);
+    }
+    Sim_BankRunMs(2000, &short_mask, &long_mask);
+    Sim_Gpio_Input(GPIOD, GPIO_PIN_4, GPIO_PIN_SET);
+    Sim_BankRunMs(100, &short_mask, &long_mask);
+
+    return (short_mask == (1UL << 0)) && (long_mask == (1UL << 20)) &&
+           (ButtonBank_Pressed(&sim_bank) == 0U);
+}
+
+#define SIM_STR_(x)     #x
+#define SIM_STR(x)      SIM_STR_(x)
+
+/* generated SystemClock_Config, read as text from Sim/ */
+#define SIM_MAIN_C      "../Core/Src/main.c"
+
+/*
+ * boot.h's fast-start oscillators against the generated
+ * SystemClock_Config: with the PLL already on SYSCLK the HAL does
+ * not compare the HSE mode or PREDIV, a .ioc change would be lost.
+ */
+static int Scn_BootClockMatchesCube(void)
+{
+    static const struct {
+        const char *field;
+        const char *want;
+    } fields[] = {
+        { "RCC_OscInitStruct.HSEState =",       SIM_STR(BOOT_HSE_STATE) },
+        { "RCC_OscInitStruct.HSEPredivValue =", SIM_STR(BOOT_PLL_PREDIV) },
+        { "RCC_OscInitStruct.PLL.PLLSource =",  SIM_STR(BOOT_PLL_SOURCE) },
+        { "RCC_OscInitStruct.PLL.PLLMUL =",     SIM_STR(BOOT_PLL_MUL) },
+    };
+    uint32_t found = 0;
+    char line[256], got[64];
+    int ok = 1;
+    FILE *f = fopen(SIM_MAIN_C, "r");
+
+    if (f == NULL)
+        return 0;
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        for (uint32_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+            const char *p = strstr(line, fields[i].field);
+
+            if (p == NULL || sscanf(p + strlen(fields[i].field), " %63[A-Za-z0-9_]", got) != 1)
+                continue;
+            found |= 1UL << i;
+            if (strcmp(got, fields[i].want) != 0) {
+                printf("  %s %s, boot.h has %s\n", fields[i].field, got, fields[i].want);
+                ok = 0;
+            }
+        }
+    }
+
+    fclose(f);
+    return ok && found == (1UL << (sizeof(fields) / sizeof(fields[0]))) - 1U;
+}
+
+static const SimScenario_t sim_scenarios[] = {
+    { "short press starts blink",   Scn_ShortPressBlinks },
+    { "second short press stops",   Scn_SecondShortPressStops },
+    { "long press forces LED on",   Scn_LongPressForcesOn },
+    { "sub-debounce glitch ignored", Scn_GlitchIgnored },
+    { "double / triple click gestures", Scn_MultiClickGestures },
+    { "idle deadlines: ticks stopped when nothing due", Scn_IdleDeadlines },
+    { "idle tickless: wakeups per idle second", Scn_IdleTickless },
+    { "clock: LOW refused at 921600, 115200 down and up", Scn_ClockLowBaud },
+    { "button bank: 32 keys independent", Scn_BankIndependentKeys },
+    { "event queue burst: overflow counted", Scn_EventQueueBurst },
+    { "timebase: us resolution, monotonic", Scn_TimebaseMicroseconds },
+    { "timer wheel: one-shot, periodic, parked", Scn_SwTimerWheel },
+    { "log: DMA chunks chained, drops counted", Scn_LogDmaChain },
+    { "trace: binary record, format id", Scn_TraceRecords },
+    { "uart cmd: 2000 echoes at 921600, no loss", Scn_CmdEcho921600 },
+    { "uart cmd: error restart, overflow detected", Scn_CmdErrorsRecover },
+    { "kv store: settings survive reset", Scn_KvSettingsSurviveReset },
+    { "kv store: settings loaded after the first pass", Scn_KvSettingsDeferredLoad },
+    { "kv store: power loss at every flash op", Scn_KvPowerLoss },
+    { "pwm led: DMA waveforms, no CPU per step", Scn_LedPwmWaveforms },
+    { "led sequencer: 14 channels, codes / SOS", Scn_LedSeqPatterns },
+    { "capture button: gestures with a stalled loop", Scn_CapButtonStalled },
+    { "fsm table: button FSM matches the switch", Scn_FsmTableMatchesSwitch },
+    { "coroutines: button task matches the FSM, led demo", Scn_PtButtonMatchesFsm },
+    { "active objects: priority, publish, idle AOs not run", Scn_ActiveObjects },
+    { "deferred work: PendSV, coalesced, stalled loop", Scn_DeferredWork },
+    { "memory pool: classes, spill, bad frees, log", Scn_MemoryPool },
+    { "boot: fast-start PLL matches SystemClock_Config", Scn_BootClockMatchesCube },
+};
+
+static int Sim_CmdRun(void)
+{
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(sim_scenarios) / sizeof(sim_scenarios[0]); i++) {
+        int ok = sim_scenarios[i].fn();
+        printf("[%s] %s\n", ok ? " OK " : "FAIL", sim_scenarios[i].name);
+        failed += !ok;
+    }
+
+    printf("%d scenario(s) failed\n", failed);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* ===== Benchmarks ===== */
+
+static uint8_t Sim_BenchKeyRead(void)
+{
+    return (HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_0) == GPIO_PIN_RESET);
+}
+
+static void Sim_BenchTimerCb(void *arg)
+{
+    (*(uint32_t *)arg)++;
+}
+
+/* per-tick wheel cost with 1 / 100 / 1000 armed timers */
+static void Sim_BenchSwTimer(void)
+{
+    static const uint32_t counts[] = { 1U, 100U, 1000U };
+    const uint32_t ticks = 2000000U;
+    uint32_t fired = 0;
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        uint32_t seed = 12345U;
+        double t0, t1;
+
+        Sim_Boot();
+        fired = 0;
+
+        /* periodic, 1 s .. 60 s: the same mix of levels at any count */
+        for (uint32_t i = 0; i < counts[c]; i++) {
+            SwTimer_t *t = SwTimer_Alloc(Sim_BenchTimerCb, &fired);
+            seed = seed * 1103515245U + 12345U;
+            uint32_t period = 1000U + (seed >> 8) % 59000U;
+            SwTimer_Start(t, period, period);
+        }
+
+        t0 = Sim_WallSeconds();
+        for (uint32_t i = 0; i < ticks; i++) {
+            SwTimer_OnTick();
+            SwTimer_Process();
+        }
+        t1 = Sim_WallSeconds();
+
+        printf("swtimer   : %4u timers, %.1f ns/tick, %.2f expiries/tick\n",
+               counts[c], (t1 - t0) * 1e9 / ticks, (double)fired / ticks);
+    }
+}
+
+/* Log_Printf cost vs. the blocking transfer it replaces */
+static void Sim_BenchLog(void)
+{
+    const uint32_t batches = 20000U, per_batch = 20U;
+    uint32_t line_len = 0;
+    uint8_t sink[1024];
+    double busy = 0.0;
+
+    Sim_Boot();
+
+    for (uint32_t b = 0; b < batches; b++) {
+        double t0 = Sim_WallSeconds();
+        for (uint32_t i = 0; i < per_batch; i++)
+            line_len = (uint32_t)Log_Printf("tick %10lu value %10lu\r\n",
+                                            (unsigned long)b, (unsigned long)i);
+        busy += Sim_WallSeconds() - t0;
+
+        /* drain on the virtual clock, outside the measurement */
+        while (Log_Pending() != 0U)
+            Sim_Clock_Step();
+        while (Sim_Uart_Take(sink, sizeof(sink)) != 0U) { }
+    }
+
+    printf("log       : Log_Printf %u B %.0f ns/call (host), blocking TX would be %.0f us\n",
+           line_len, busy * 1e9 / (batches * per_batch),
+           line_len * 10.0 * 1e6 / huart2.Init.BaudRate);
+}
+
+/* flash wear: log-structured store vs. rewriting a page per change */
+static void Sim_BenchKv(void)
+{
+    const uint32_t updates = 100000U;
+    uint32_t max_erases = 0, e0[SIM_FLASH_PAGES];
+    double t0, t1;
+
+    Sim_Flash_Blank();
+    Kv_Init();
+    for (uint32_t p = 0; p < SIM_FLASH_PAGES; p++)
+        e0[p] = Sim_Flash_Erases(p);
+
+    t0 = Sim_WallSeconds();
+    for (uint32_t i = 0; i < updates; i++)
+        (void)Kv_SetU32(KV_KEY_LED_MODE, i % 3U);
+    t1 = Sim_WallSeconds();
+
+    for (uint32_t p = 0; p < SIM_FLASH_PAGES; p++) {
+        if (Sim_Flash_Erases(p) - e0[p] > max_erases)
+            max_erases = Sim_Flash_Erases(p) - e0[p];
+    }
+
+    /* STM32F103 flash: 10k erase cycles per page */
+    printf("kv store  : %u updates -> max %u erases/page (page rewrite: %u), "
+           "10k cycles = %.1f M updates, %.0f ns/update (host)\n",
+           updates, max_erases, updates,
+           10000.0 * updates / (max_erases ? max_erases : 1U) / 1e6,
+           (t1 - t0) * 1e9 / updates);
+}
+
+/* software alternative to the DMA waveform: one timer callback per step */
+static void Sim_BenchPwmStep(void *arg)
+{
+    uint32_t *step = arg;
+
+    __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_3,
+                          led_wave_breathe[(*step)++ % LED_WAVE_BREATHE_LEN]);
+}
+
+/* breathing LED: software stepping from the TIM2 tick vs. DMA into CCR3 */
+static void Sim_BenchLedPwm(void)
+{
+    const uint32_t secs = 60U, ticks = 5000000U;
+    uint64_t loops, gated, writes, steps, irqs;
+    uint32_t step = 0;
+    SwTimer_t *tmr;
+    double t0, t1, t2;
+
+    /* per-step CPU cost of the software path: tick + wheel + callback */
+    Sim_Boot();
+    t0 = Sim_WallSeconds();
+    for (uint32_t i = 0; i < ticks; i++) {
+        SwTimer_OnTick();
+        SwTimer_Process();
+    }
+    t1 = Sim_WallSeconds();
+    tmr = SwTimer_Alloc(Sim_BenchPwmStep, &step);
+    SwTimer_Start(tmr, LED_WAVE_STEP_MS, LED_WAVE_STEP_MS);
+    for (uint32_t i = 0; i < ticks; i++) {
+        SwTimer_OnTick();
+        SwTimer_Process();
+    }
+    t2 = Sim_WallSeconds();
+
+    /* the ticks can only stop while nothing steps in software */
+    Sim_Boot();
+    tmr = SwTimer_Alloc(Sim_BenchPwmStep, &step);
+    SwTimer_Start(tmr, LED_WAVE_STEP_MS, LED_WAVE_STEP_MS);
+    writes = Sim_GetStats()->pwm_cpu_writes;
+    loops = sim_loops;
+    gated = sim_loops_gated;
+    Sim_RunMs(secs * 1000U);
+    printf("pwm led   : software step %.1f ns (host), %llu CCR writes in %u s, ticks stopped %.0f %%\n",
+           ((t2 - t1) - (t1 - t0)) * 1e9 / ticks,
+           (unsigned long long)(Sim_GetStats()->pwm_cpu_writes - writes), secs,
+           100.0 * (double)(sim_loops_gated - gated) / (double)(sim_loops - loops));
+
+    Sim_Boot();
+    Led_SetMode(LED_MODE_BREATHE);
+    writes = Sim_GetStats()->pwm_cpu_writes;
+    loops = sim_loops;
+    gated = sim_loops_gated;
+    Sim_RunMs(secs * 1000U);
+    steps = Sim_GetStats()->pwm_dma_steps;
+    irqs  = Sim_GetStats()->pwm_dma_irqs;
+    printf("            DMA %llu steps, %llu CCR writes, %llu IRQs in %u s, ticks stopped %.0f %%\n",
+           (unsigned long long)steps,
+           (unsigned long long)(Sim_GetStats()->pwm_cpu_writes - writes),
+           (unsigned long long)irqs, secs,
+           100.0 * (double)(sim_loops_gated - gated) / (double)(sim_loops - loops));
+}
+
+/* per-tick cost of the sequencer, all 14 patterns on 14 channels */
+static void Sim_BenchLedSeq(void)
+{
+    const uint32_t ticks = 5000000U;
+    double t0, t1;
+
+    Sim_Boot();
+    for (uint32_t ch = 0; ch < SIM_SEQ_CHANNELS; ch++)
+        sim_leds[ch] = (LedSeqChan_t)LED_SEQ_CHANNEL(GPIOD, (uint16_t)(1U << ch));
+    LedSeq_Init(sim_leds, SIM_SEQ_CHANNELS);
+    for (uint32_t ch = 0; ch < SIM_SEQ_CHANNELS; ch++)
+        LedSeq_Play(ch, Sim_SeqPattern(ch));
+
+    t0 = Sim_WallSeconds();
+    for (uint32_t i = 0; i < ticks; i++)
+        LedSeq_OnTick();
+    t1 = Sim_WallSeconds();
+
+    printf("led seq   : %u channels %.1f ns/tick, %.2f ns/channel (host)\n",
+           SIM_SEQ_CHANNELS, (t1 - t0) * 1e9 / ticks,
+           (t1 - t0) * 1e9 / ticks / SIM_SEQ_CHANNELS);
+}
+
+/* the same two-argument message: binary record vs. formatted text */
+static void Sim_BenchTrace(void)
+{
+    const uint32_t batches = 20000U, per_batch = 20U;
+    uint8_t sink[1024];
+    double t_trace = 0.0, t_text = 0.0;
+
+    Sim_Boot();
+
+    for (uint32_t b = 0; b < batches; b++) {
+        double t0 = Sim_WallSeconds();
+        for (uint32_t i = 0; i < per_batch; i++)
+            TRACE("tick %lu value %lu\r\n", b, i);
+        double t1 = Sim_WallSeconds();
+        for (uint32_t i = 0; i < per_batch; i++)
+            (void)Log_Printf("tick %lu value %lu\r\n", (unsigned long)b, (unsigned long)i);
+        double t2 = Sim_WallSeconds();
+
+        t_trace += t1 - t0;
+        t_text  += t2 - t1;
+
+        while (Log_Pending() != 0U)
+            Sim_Clock_Step();
+        while (Sim_Uart_Take(sink, sizeof(sink)) != 0U) { }
+    }
+
+    printf("trace     : TRACE 16 B %.0f ns/call, Log_Printf %.0f ns/call (host, x%.1f)\n",
+           t_trace * 1e9 / (batches * per_batch), t_text * 1e9 / (batches * per_batch),
+           t_text / t_trace);
+}
+
+/* 32 held keys: one FSM + ReadPin per key vs. one bank scan + process */
+static void Sim_BenchBank(void)
+{
+    static ButtonCtx_t keys[BANK_MAX_BUTTONS];
+    const uint32_t ticks = 1000000U;
+    double t0, t1, t2;
+
+    Sim_BankBoot();
+    Sim_Gpio_Input(GPIOB, GPIO_PIN_All, GPIO_PIN_RESET);
+    Sim_Gpio_Input(GPIOD, GPIO_PIN_All, GPIO_PIN_RESET);
+    for (uint32_t k = 0; k < BANK_MAX_BUTTONS; k++) {
+        Button_Init(&keys[k], Sim_BenchKeyRead);
+        Button_OnExti(&keys[k]);
+    }
+
+    t0 = Sim_WallSeconds();
+    for (uint32_t i = 0; i < ticks; i++) {
+        for (uint32_t k = 0; k < BANK_MAX_BUTTONS; k++) {
+            Button_Process(&keys[k]);
+            (void)Button_GetEvent(&keys[k]);
+        }
+    }
+    t1 = Sim_WallSeconds();
+    for (uint32_t i = 0; i < ticks; i++) {
+        ButtonBank_OnTick(&sim_bank);
+        ButtonBank_Process(&sim_bank);
+        (void)ButtonBank_TakeEvents(&sim_bank, BTN_EVENT_SHORT);
+        (void)ButtonBank_TakeEvents(&sim_bank, BTN_EVENT_LONG);
+    }
+    t2 = Sim_WallSeconds();
+
+    printf("32 keys   : per-button FSM %.1f ns/tick, bank %.1f ns/tick (x%.1f)\n",
+           (t1 - t0) * 1e9 / ticks, (t2 - t1) * 1e9 / ticks,
+           (t1 - t0) / (t2 - t1));
+}
+
+/* every pass starts from a fresh button: time restarts at 0 */
+static void Sim_BenchFsmReset(ButtonCtx_t *btn)
+{
+    Button_Init(btn, Sim_FsmRead);
+    Button_SetProfile(btn, &sim_fsm_gestures);
+}
+
+/*
+ * One pass over the step stream. poll = 1: Process every 1 ms in
+ * between, as the superloop does (mostly nothing due); poll = 0:
+ * one Process per step, nearly every call is a transition.
+ */
+static double Sim_BenchFsmPass(ButtonCtx_t *btn, uint8_t ref, uint8_t poll)
+{
+    uint32_t now = 0, calls = 0;
+    double t0;
+
+    Sim_BenchFsmReset(btn);
+    t0 = Sim_WallSeconds();
+
+    for (uint32_t i = 0; i < SIM_FSM_STEPS; i++) {
+        const SimFsmStep_t *st = &sim_fsm_steps[i];
+        uint32_t end = now + st->dt_ms;
+
+        now = poll ? now + 1U : end;
+        if (st->edge) {
+            if (ref)
+                Button_OnEdgeAt(btn, now);
+            else
+                SimTab_OnEdgeAt(btn, now);
+        }
+        for (;;) {
+            if (ref)
+                Button_ProcessAt(btn, now, st->level);
+            else
+                SimTab_ProcessAt(btn, now, st->level);
+            (void)Button_GetEvent(btn);
+            calls++;
+            if (now == end)
+                break;
+            now++;
+        }
+    }
+
+    return (Sim_WallSeconds() - t0) * 1e9 / calls;
+}
+
+/* the same pass with the button as a coroutine (sim_button_pt.c) */
+static double Sim_BenchPtPass(ButtonCtx_t *btn, uint8_t poll)
+{
+    static SimPtButton_t pb;
+    uint32_t now = 0, calls = 0;
+    double t0;
+
+    Sim_BenchFsmReset(btn);
+    Pt_Init();
+    SimPt_ButtonStart(&pb, btn);
+    Pt_RunAt(now);
+
+    t0 = Sim_WallSeconds();
+    for (uint32_t i = 0; i < SIM_FSM_STEPS; i++) {
+        const SimFsmStep_t *st = &sim_fsm_steps[i];
+        uint32_t end = now + st->dt_ms;
+
+        now = poll ? now + 1U : end;
+        if (st->edge)
+            SimPt_ButtonEdge(&pb, now);
+        pb.level = st->level;
+        for (;;) {
+            Pt_RunAt(now);
+            (void)Button_GetEvent(btn);
+            calls++;
+            if (now == end)
+                break;
+            now++;
+        }
+    }
+
+    return (Sim_WallSeconds() - t0) * 1e9 / calls;
+}
+
+/* best of SIM_FSM_ROUNDS passes, interleaved: host noise only adds time */
+#define SIM_FSM_ROUNDS  11U
+
+static double Sim_Min(double a, double b)
+{
+    return (b < a) ? b : a;
+}
+
+/* button FSM dispatch: the switch in button_fsm.c vs. the table candidate */
+static void Sim_BenchFsm(void)
+{
+    ButtonCtx_t tab, ref, cor;
+    double sw[2], tb[2], co[2];
+
+    Sim_FsmSteps();
+    for (uint8_t poll = 0; poll < 2U; poll++) {
+        sw[poll] = tb[poll] = co[poll] = 1e30;
+        for (uint32_t r = 0; r < SIM_FSM_ROUNDS; r++) {
+            sw[poll] = Sim_Min(sw[poll], Sim_BenchFsmPass(&ref, 1, poll));
+            tb[poll] = Sim_Min(tb[poll], Sim_BenchFsmPass(&tab, 0, poll));
+            co[poll] = Sim_Min(co[poll], Sim_BenchPtPass(&cor, poll));
+        }
+    }
+
+    printf("fsm       : button 1 ms polls: switch %.1f ns, table %.1f ns (x%.2f), "
+           "coroutine %.1f ns (x%.2f)\n",
+           sw[1], tb[1], tb[1] / sw[1], co[1], co[1] / sw[1]);
+    printf("            transitions only: switch %.1f ns, table %.1f ns (x%.2f), "
+           "coroutine %.1f ns (x%.2f)\n",
+           sw[0], tb[0], tb[0] / sw[0], co[0], co[0] / sw[0]);
+    printf("            coroutine state (host): PtTask_t %u B + %u B own\n",
+           (unsigned)sizeof(PtTask_t),
+           (unsigned)(sizeof(SimPtButton_t) - sizeof(PtTask_t)));
+}
+
+#define SIM_POOL_OPS    400000U
+#define SIM_POOL_LIVE   16U
+
+static uint32_t sim_pool_ns[2][SIM_POOL_OPS];
+
+static uint64_t Sim_NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int Sim_CmpU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* request sizes: mostly small events, some UART lines */
+static size_t Sim_PoolSize(uint32_t r)
+{
+    uint32_t pick = r % 100U;
+
+    if (pick < 60U)
+        return 1U + (r >> 8) % 16U;
+    if (pick < 85U)
+        return 17U + (r >> 8) % 16U;
+    if (pick < 95U)
+        return 33U + (r >> 8) % 32U;
+    return 65U + (r >> 8) % 64U;
+}
+
+/*
+ * The same random alloc / free sequence over SIM_POOL_LIVE slots.
+ * ns != 0: each call timed alone, sim_pool_ns[0] alloc, [1] free,
+ * minus the cost of the stamps; ns == 0: no stamps, for the mean.
+ * Returns failed allocations.
+ */
+static uint32_t Sim_BenchPoolRun(uint8_t use_malloc, uint8_t ns, uint32_t stamp_ns,
+                                 uint32_t *counts)
+{
+    void *slot[SIM_POOL_LIVE] = { NULL };
+    uint32_t lcg = 4242U, fails = 0;
+    uint64_t t0 = 0, t1;
+
+    counts[0] = counts[1] = 0;
+    for (uint32_t i = 0; i < SIM_POOL_OPS; i++) {
+        uint32_t r, k, op;
+        size_t size;
+
+        lcg = lcg * 1664525U + 1013904223U;
+        r = lcg >> 4;
+        k = r % SIM_POOL_LIVE;
+        op = (slot[k] == NULL) ? 0U : 1U;
+        size = Sim_PoolSize(r >> 4);
+
+        if (ns)
+            t0 = Sim_NowNs();
+        if (op == 0U)
+            slot[k] = use_malloc ? malloc(size) : Pool_Alloc(size);
+        else if (use_malloc)
+            free(slot[k]);
+        else
+            Pool_Free(slot[k]);
+        if (ns) {
+            t1 = Sim_NowNs() - t0;
+            sim_pool_ns[op][counts[op]] = (t1 > stamp_ns) ? (uint32_t)(t1 - stamp_ns) : 0U;
+        }
+        counts[op]++;
+
+        if (op == 0U && slot[k] == NULL)
+            fails++;
+        if (op == 1U)
+            slot[k] = NULL;
+    }
+
+    for (uint32_t k = 0; k < SIM_POOL_LIVE; k++) {
+        if (use_malloc)
+            free(slot[k]);
+        else
+            Pool_Free(slot[k]);
+    }
+    return fails;
+}
+
+static void Sim_BenchPoolLine(const char *name, uint32_t *ns, uint32_t count)
+{
+    qsort(ns, count, sizeof(ns[0]), Sim_CmpU32);
+    printf("%s p50 %3u  p99 %3u  p99.9 %4u  p99.99 %5u ns\n", name,
+           ns[count / 2U], ns[count * 99U / 100U], ns[count * 999U / 1000U],
+           ns[count * 9999U / 10000U]);
+}
+
+/*
+ * pool.c vs. the C library heap (host libc, not newlib): latency
+ * distribution per call. The host clock has ~30 ns granularity and
+ * the OS preempts now and then, so the mean comes from an unstamped
+ * pass and the tail stops at p99.99.
+ */
+static void Sim_BenchPool(void)
+{
+    uint32_t counts[2], fails, stamp[1001];
+    double t0, t1, t2;
+
+    /* cost of the two time stamps around a call */
+    for (uint32_t i = 0; i < 1001U; i++) {
+        uint64_t s0 = Sim_NowNs();
+        stamp[i] = (uint32_t)(Sim_NowNs() - s0);
+    }
+    qsort(stamp, 1001U, sizeof(stamp[0]), Sim_CmpU32);
+
+    Pool_Init();
+    t0 = Sim_WallSeconds();
+    fails = Sim_BenchPoolRun(0, 0, 0, counts);
+    t1 = Sim_WallSeconds();
+    (void)Sim_BenchPoolRun(1, 0, 0, counts);
+    t2 = Sim_WallSeconds();
+
+    printf("pool      : %u live, 1..128 B, mean per call: pool %.1f ns, malloc/free %.1f ns, "
+           "%u of %u pool allocs failed\n",
+           SIM_POOL_LIVE, (t1 - t0) * 1e9 / SIM_POOL_OPS, (t2 - t1) * 1e9 / SIM_POOL_OPS,
+           fails, counts[0]);
+
+    (void)Sim_BenchPoolRun(0, 1, stamp[500], counts);
+    Sim_BenchPoolLine("            Pool_Alloc", sim_pool_ns[0], counts[0]);
+    Sim_BenchPoolLine("            Pool_Free ", sim_pool_ns[1], counts[1]);
+    (void)Sim_BenchPoolRun(1, 1, stamp[500], counts);
+    Sim_BenchPoolLine("            malloc    ", sim_pool_ns[0], counts[0]);
+    Sim_BenchPoolLine("            free      ", sim_pool_ns[1], counts[1]);
+}
+
+static int Sim_CmdBench(void)
+{
+    const uint32_t ticks = 20000000U;
+    double t0, t1;
+
+    /* 1) raw tick path: HAL_TIM_PeriodElapsedCallback with LED blinking */
+    Sim_Boot();
+    Sim_Press(100);
+    Sim_RunMs(50);
+
+    t0 = Sim_WallSeconds();
+    for (uint32_t i = 0; i < ticks; i++)
+        HAL_TIM_PeriodElapsedCallback(&htim2);
+    t1 = Sim_WallSeconds();
+
+    printf("tick path : %u ticks in %.3f s -> %.1f Mticks/s\n",
+           ticks, t1 - t0, (double)ticks / (t1 - t0) / 1e6);
+
+    /* 2) full superloop: one hour of virtual time, press every 5 s */
+    Sim_Boot();
+    sim_loops = 0;
+    sim_loops_idle = 0;
+    sim_loops_gated = 0;
+
+    t0 = Sim_WallSeconds();
+    for (uint32_t s = 0; s < 3600U; s += 5U) {
+        Sim_Press(120);
+        Sim_RunMs(5000U - 120U);
+    }
+    t1 = Sim_WallSeconds();
+
+    printf("superloop : 3600 s virtual in %.3f s wall -> x%.0f real time, %llu ticks\n",
+           t1 - t0, 3600.0 / (t1 - t0),
+           (unsigned long long)Sim_GetStats()->tim2_updates);
+    printf("idle      : %.1f %% of superloop passes sleep, %.1f %% with both ticks stopped\n",
+           100.0 * (double)sim_loops_idle / (double)sim_loops,
+           100.0 * (double)sim_loops_gated / (double)sim_loops);
+
+    /* 3) N-input scanning cost */
+    Sim_BenchBank();
+
+    /* 4) timer wheel scaling */
+    Sim_BenchSwTimer();
+
+    /* 5) non-blocking log */
+    Sim_BenchLog();
+
+    /* 6) binary trace vs. printf */
+    Sim_BenchTrace();
+
+    /* 7) settings store wear */
+    Sim_BenchKv();
+
+    /* 8) PWM LED waveform: software steps vs. DMA */
+    Sim_BenchLedPwm();
+
+    /* 9) LED pattern sequencer */
+    Sim_BenchLedSeq();
+
+    /* 10) table-driven FSM dispatch */
+    Sim_BenchFsm();
+
+    /* 11) fixed-block pool vs. heap */
+    Sim_BenchPool();
+
+    return EXIT_SUCCESS;
+}
+
+/* ===== Trace replay ===== */
+
+/*
+ * Trace file, one item per line ('#' starts a comment):
+ *   profile <debounce> <long> <multi> <repeat>   optional, ms
+ *   <t_ms> <0|1>                                  edge, 1 = pressed
+ *   expect [EVENT ...]                            events in order
+ * Edge times are absolute from the trace start and may have a
+ * fraction (scope / logic analyzer exports).
+ */
+#define SIM_REPLAY_MAX_EVENTS   32U
+
+static ButtonCtx_t sim_replay_btn;
+
+static const char *const sim_event_names[] = {
+    "NONE", "SHORT", "LONG", "DOUBLE", "TRIPLE", "HOLD_REPEAT", "RELEASE"
+};
+
+static uint8_t Sim_ReplayRead(void)
+{
+    return HAL_GPIO_ReadPin(GPIOD, GPIO_PIN_0) == GPIO_PIN_SET;
+}
+
+static int Sim_EventByName(const char *name, ButtonEvent_t *evt)
+{
+    if (strcmp(name, "HOLD_START") == 0)
+        name = "LONG";
+    for (uint32_t i = 1; i < sizeof(sim_event_names) / sizeof(sim_event_names[0]); i++) {
+        if (strcmp(name, sim_event_names[i]) == 0) {
+            *evt = (ButtonEvent_t)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* main loop of the replayed button up to t_ns, events collected */
+static void Sim_ReplayRunTo(uint64_t t_ns, ButtonEvent_t *got, uint32_t *n)
+{
+    for (;;) {
+        ButtonEvent_t evt;
+
+        Button_Process(&sim_replay_btn);
+        while ((evt = Button_GetEvent(&sim_replay_btn)) != BTN_EVENT_NONE) {
+            if (*n < SIM_REPLAY_MAX_EVENTS)
+                got[(*n)++] = evt;
+        }
+        if (Sim_Clock_NextEventNs() > t_ns)
+            break;
+        Sim_Clock_Step();
+    }
+    Sim_Clock_AdvanceTo(t_ns);
+}
+
+static void Sim_PrintEvents(const char *label, const ButtonEvent_t *evt, uint32_t n)
+{
+    printf("       %-8s", label);
+    for (uint32_t i = 0; i < n; i++)
+        printf(" %s", sim_event_names[evt[i]]);
+    printf("%s\n", n ? "" : " -");
+}
+
+static int Sim_ReplayFile(const char *path)
+{
+    ButtonProfile_t prof = BTN_PROFILE_INIT(BTN_DEBOUNCE_MS, BTN_LONG_PRESS_MS,
+                                            BTN_MULTI_CLICK_MS, BTN_REPEAT_MS);
+    ButtonEvent_t want[SIM_REPLAY_MAX_EVENTS], got[SIM_REPLAY_MAX_EVENTS];
+    uint32_t n_want = 0, n_got = 0, line_no = 0;
+    uint64_t t0, t_last;
+    char line[256];
+    int ok = 1;
+    FILE *f = fopen(path, "r");
+
+    if (f == NULL) {
+        printf("[FAIL] %s: cannot open\n", path);
+        return 0;
+    }
+
+    Sim_Boot();
+    Sim_Gpio_Input(GPIOD, GPIO_PIN_0, GPIO_PIN_RESET);
+    Button_Init(&sim_replay_btn, Sim_ReplayRead);
+    Button_SetProfile(&sim_replay_btn, &prof);
+    t0 = t_last = Sim_Clock_NowNs();
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char *p = line + strspn(line, " \t");
+        unsigned a, b, c, d;
+        double ms;
+        int level;
+
+        line_no++;
+        p[strcspn(p, "#\r\n")] = '\0';
+        if (*p == '\0')
+            continue;
+
+        if (sscanf(p, "profile %u %u %u %u", &a, &b, &c, &d) == 4) {
+            prof = (ButtonProfile_t)BTN_PROFILE_INIT(a, b, c, d);
+        } else if (strncmp(p, "expect", 6) == 0) {
+            for (char *tok = strtok(p + 6, " \t"); tok != NULL; tok = strtok(NULL, " \t")) {
+                if (n_want == SIM_REPLAY_MAX_EVENTS || !Sim_EventByName(tok, &want[n_want])) {
+                    printf("[FAIL] %s:%u: bad event '%s'\n", path, line_no, tok);
+                    ok = 0;
+                    break;
+                }
+                n_want++;
+            }
+        } else if (sscanf(p, "%lf %d", &ms, &level) == 2 && ms >= 0.0 &&
+                   t0 + (uint64_t)(ms * 1e6 + 0.5) >= t_last) {
+            t_last = t0 + (uint64_t)(ms * 1e6 + 0.5);
+            Sim_ReplayRunTo(t_last, got, &n_got);
+            Sim_Gpio_Input(GPIOD, GPIO_PIN_0, level ? GPIO_PIN_SET : GPIO_PIN_RESET);
+            Button_OnExti(&sim_replay_btn);         /* EXTI on both edges */
+        } else {
+            printf("[FAIL] %s:%u: cannot parse '%s'\n", path, line_no, p);
+            ok = 0;
+        }
+    }
+    fclose(f);
+
+    /* let click windows, holds and repeats run out */
+    Sim_ReplayRunTo(t_last + MS_NS(5000), got, &n_got);
+
+    ok &= (n_got == n_want) && (memcmp(got, want, n_got * sizeof(got[0])) == 0);
+    if (ok) {
+        printf("[ OK ] %s\n", path);
+    } else {
+        printf("[FAIL] %s\n", path);
+        Sim_PrintEvents("expected", want, n_want);
+        Sim_PrintEvents("got", got, n_got);
+    }
+    return ok;
+}
+
+static int Sim_CmdReplay(int argc, char **argv)
+{
+    int failed = 0;
+
+    for (int i = 0; i < argc; i++)
+        failed += !Sim_ReplayFile(argv[i]);
+
+    printf("%d trace(s) failed\n", failed);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* short, long, short press with log text in between, capture to stdout */
+static int Sim_CmdTrace(void)
+{
+    uint8_t buf[1024];
+    uint32_t n;
+
+    Sim_Boot();
+    (void)Log_Printf("sim: trace session start\r\n");
+    Sim_Press(100);
+    Sim_RunMs(500);
+    Sim_Press(2500);
+    Sim_RunMs(500);
+    (void)Log_Printf("sim: led output %d\r\n", (int)Sim_Led());
+    Sim_Press(100);
+    Sim_RunMs(500);
+
+    while ((n = Sim_Uart_Take(buf, sizeof(buf))) != 0U)
+        fwrite(buf, 1, n, stdout);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    const char *cmd = (argc > 1) ? argv[1] : "run";
+
+    if (strcmp(cmd, "run") == 0)
+        return Sim_CmdRun();
+    if (strcmp(cmd, "bench") == 0)
+        return Sim_CmdBench();
+    if (strcmp(cmd, "trace") == 0)
+        return Sim_CmdTrace();
+    if (strcmp(cmd, "replay") == 0)
+        return Sim_CmdReplay(argc - 2, argv + 2);
+
+    fprintf(stderr, "usage: %s [run|bench|trace|replay <trace.txt>...]\n", argv[0]);
+    return EXIT_FAILURE;
+}
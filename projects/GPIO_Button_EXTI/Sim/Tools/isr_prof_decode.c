@@ -0,0 +1,155 @@
+/*
+ * ISR profiler dump decoder
+ *
+ * Reads a raw UART capture (file or stdin), finds every
+ * IsrProfDump_t record by its "ISRP" magic and prints duration,
+ * period, jitter and latency statistics plus the log2 histograms.
+ *
+ * Capture example:
+ *   stty -F /dev/ttyACM0 115200 raw && cat /dev/ttyACM0 > isr.bin
+ *   ./build/isr_prof_decode isr.bin
+ *
+ * The record layout is shared with the firmware through
+ * Core/Inc/isr_prof.h; both sides are little-endian.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "isr_prof.h"
+
+static const char *const decode_names[ISR_PROF_COUNT] = {
+    [ISR_PROF_TIM2]      = "TIM2_IRQHandler",
+    [ISR_PROF_EXTI15_10] = "EXTI15_10_IRQHandler",
+    [ISR_PROF_PENDSV]    = "PendSV_Handler (deferred work)",
+};
+
+static double Decode_Us(double cycles, uint32_t hz)
+{
+    return (hz != 0U) ? (cycles * 1e6 / (double)hz) : 0.0;
+}
+
+static void Decode_Hist(const char *title, const uint32_t *hist)
+{
+    uint32_t peak = 0;
+
+    for (unsigned i = 0; i < ISR_PROF_HIST_BINS; i++)
+        if (hist[i] > peak)
+            peak = hist[i];
+    if (peak == 0U)
+        return;
+
+    printf("    %s (cycles)\n", title);
+    for (unsigned i = 0; i < ISR_PROF_HIST_BINS; i++) {
+        if (hist[i] == 0U)
+            continue;
+        unsigned bar = (unsigned)((uint64_t)hist[i] * 40U / peak);
+        printf("    %7lu..%-7lu %10u |", 1UL << i,
+               (i == ISR_PROF_HIST_BINS - 1U) ? 0UL : (2UL << i) - 1UL, hist[i]);
+        for (unsigned b = 0; b < bar; b++)
+            putchar('#');
+        putchar('\n');
+    }
+}
+
+static void Decode_Dump(const IsrProfDump_t *d, unsigned index)
+{
+    uint32_t hz = d->core_clock_hz;
+
+    printf("=== dump #%u: %lu Hz core clock, probe overhead %lu cycles (subtracted) ===\n",
+           index, (unsigned long)hz, (unsigned long)d->overhead_cycles);
+
+    for (unsigned i = 0; i < d->source_count && i < ISR_PROF_COUNT; i++) {
+        const IsrProfStats_t *s = &d->stats[i];
+
+        printf("  %s\n", decode_names[i]);
+        if (s->count == 0U) {
+            printf("    no samples\n");
+            continue;
+        }
+
+        double dur_mean = (double)s->dur_sum / (double)s->count;
+        printf("    calls      %lu\n", (unsigned long)s->count);
+        printf("    duration   min %lu  mean %.1f  max %lu cycles  (%.2f / %.2f / %.2f us)\n",
+               (unsigned long)s->dur_min, dur_mean, (unsigned long)s->dur_max,
+               Decode_Us(s->dur_min, hz), Decode_Us(dur_mean, hz), Decode_Us(s->dur_max, hz));
+
+        if (s->period_count != 0U) {
+            double per_mean = (double)s->period_sum / (double)s->period_count;
+            printf("    period     min %lu  mean %.1f  max %lu cycles  (mean %.1f us)\n",
+                   (unsigned long)s->period_min, per_mean, (unsigned long)s->period_max,
+                   Decode_Us(per_mean, hz));
+            printf("    load       %.3f %% of period (mean), %.3f %% (worst)\n",
+                   100.0 * dur_mean / per_mean,
+                   100.0 * (double)s->dur_max / (double)s->period_min);
+        }
+        if (s->period_expected != 0U) {
+            printf("    jitter     max %lu cycles (%.2f us) vs expected %lu\n",
+                   (unsigned long)s->jitter_max, Decode_Us(s->jitter_max, hz),
+                   (unsigned long)s->period_expected);
+        }
+
+        if (s->lat_count != 0U) {
+            double lat_mean = (double)s->lat_sum / (double)s->lat_count;
+            printf("    latency    min %lu  mean %.1f  max %lu cycles  (%.2f / %.2f / %.2f us), %lu samples\n",
+                   (unsigned long)s->lat_min, lat_mean, (unsigned long)s->lat_max,
+                   Decode_Us(s->lat_min, hz), Decode_Us(lat_mean, hz), Decode_Us(s->lat_max, hz),
+                   (unsigned long)s->lat_count);
+        }
+
+        Decode_Hist("duration histogram", s->dur_hist);
+        Decode_Hist("jitter histogram", s->jitter_hist);
+        Decode_Hist("latency histogram", s->lat_hist);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    FILE *f = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+    unsigned char *buf = NULL;
+    size_t len = 0, cap = 0, n;
+    unsigned found = 0;
+
+    if (f == NULL) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    do {
+        if (len + 4096U > cap) {
+            cap = (cap == 0U) ? 65536U : cap * 2U;
+            buf = realloc(buf, cap);
+            if (buf == NULL)
+                return EXIT_FAILURE;
+        }
+        n = fread(buf + len, 1, cap - len, f);
+        len += n;
+    } while (n != 0U);
+
+    for (size_t off = 0; off + sizeof(IsrProfDump_t) <= len; off++) {
+        IsrProfDump_t d;
+        uint32_t magic;
+
+        memcpy(&magic, buf + off, sizeof(magic));
+        if (magic != ISR_PROF_MAGIC)
+            continue;
+
+        memcpy(&d, buf + off, sizeof(d));
+        if (d.version != ISR_PROF_VERSION || d.source_count != ISR_PROF_COUNT)
+            continue;
+
+        Decode_Dump(&d, found++);
+        off += sizeof(d) - 1U;
+    }
+
+    if (found == 0U)
+        fprintf(stderr, "no ISR profiler dump found\n");
+
+    free(buf);
+    if (f != stdin)
+        fclose(f);
+    return (found != 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
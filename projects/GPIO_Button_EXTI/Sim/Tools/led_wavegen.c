@@ -0,0 +1,73 @@
+/*
+ * LED waveform table generator
+ *
+ * Prints Core/Src/led_wave.c: the gamma-corrected brightness
+ * tables declared in Core/Inc/led_wave.h.
+ *
+ *   make wave     regenerate ../Core/Src/led_wave.c
+ *
+ * Brightness b in [0, 1] is what the eye should see; the duty
+ * written to CCR3 is round(LED_PWM_MAX * b ^ LED_WAVE_GAMMA).
+ *  - breathe : b = (1 - cos(2 pi t / T)) / 2, one full period
+ *  - fade in : b = t / T, ends at LED_PWM_MAX
+ *  - fade out: fade in reversed, ends at 0
+ *  - gamma   : b = i / 100, the static dim levels
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "led_wave.h"
+
+#define GEN_PI  3.14159265358979323846
+
+static unsigned Gen_Duty(double b)
+{
+    return (unsigned)lround((double)LED_PWM_MAX * pow(b, LED_WAVE_GAMMA));
+}
+
+static void Gen_Table(const char *name, const char *len, unsigned n, double (*fn)(unsigned, unsigned))
+{
+    printf("\nconst uint8_t %s[%s] = {", name, len);
+    for (unsigned i = 0; i < n; i++)
+        printf("%s%3u,", (i % 16U == 0U) ? "\n   " : " ", Gen_Duty(fn(i, n)));
+    printf("\n};\n");
+}
+
+static double Gen_Breathe(unsigned i, unsigned n)
+{
+    return (1.0 - cos(2.0 * GEN_PI * (double)i / (double)n)) / 2.0;
+}
+
+static double Gen_FadeIn(unsigned i, unsigned n)
+{
+    return (double)i / (double)(n - 1U);
+}
+
+static double Gen_FadeOut(unsigned i, unsigned n)
+{
+    return Gen_FadeIn(n - 1U - i, n);
+}
+
+int main(void)
+{
+    printf("/*\n"
+           " * LED brightness waveforms, see led_wave.h\n"
+           " *\n"
+           " * GENERATED by Sim/Tools/led_wavegen.c (make wave), do not edit.\n"
+           " * gamma %.1f, %u-step duty, %u ms per sample\n"
+           " *\n"
+           " * Platform: STM32 + HAL\n"
+           " */\n"
+           "\n"
+           "#include \"led_wave.h\"\n",
+           LED_WAVE_GAMMA, LED_PWM_MAX + 1U, LED_WAVE_STEP_MS);
+
+    Gen_Table("led_wave_breathe", "LED_WAVE_BREATHE_LEN", LED_WAVE_BREATHE_LEN, Gen_Breathe);
+    Gen_Table("led_wave_fade_in", "LED_WAVE_FADE_LEN", LED_WAVE_FADE_LEN, Gen_FadeIn);
+    Gen_Table("led_wave_fade_out", "LED_WAVE_FADE_LEN", LED_WAVE_FADE_LEN, Gen_FadeOut);
+    Gen_Table("led_gamma", "LED_GAMMA_LEN", LED_GAMMA_LEN, Gen_FadeIn);
+    return 0;
+}
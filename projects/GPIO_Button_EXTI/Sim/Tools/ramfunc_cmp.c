@@ -0,0 +1,94 @@
+/*
+ * RAMFUNC bench comparison
+ *
+ * Reads two UART captures of RamFunc_BenchReport() (ramfunc.h), one
+ * from a RAMFUNC_ENABLE=0 build and one from a RAMFUNC_ENABLE=1
+ * build, and prints the cycles each function saves from RAM.
+ *
+ * Capture example:
+ *   stty -F /dev/ttyACM0 115200 raw && cat /dev/ttyACM0 > flash.log
+ *   (reflash with -DRAMFUNC_ENABLE=1) ... > ram.log
+ *   ./build/ramfunc_cmp flash.log ram.log
+ *
+ * Lines that are not "ramfunc: <name> <where> <min> <mean> <max>"
+ * are skipped, so the captures may hold the rest of the boot log.
+ * Positive savings: keep the function in RAM; zero or negative: the
+ * prefetch buffer already hides the wait states, leave it in flash
+ * and give the RAM back.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CMP_MAX     32U
+
+typedef struct {
+    char     name[32];
+    char     where[8];
+    unsigned min, mean, max;
+} CmpRow_t;
+
+static unsigned Cmp_Load(const char *path, CmpRow_t *rows)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    unsigned n = 0;
+
+    if (f == NULL) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    while (n < CMP_MAX && fgets(line, sizeof(line), f) != NULL) {
+        const char *p = strstr(line, "ramfunc: ");
+        CmpRow_t *r = &rows[n];
+
+        if (p != NULL && sscanf(p, "ramfunc: %31s %7s %u %u %u",
+                                r->name, r->where, &r->min, &r->mean, &r->max) == 5)
+            n++;
+    }
+
+    fclose(f);
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    static CmpRow_t before[CMP_MAX], after[CMP_MAX];
+    unsigned nb, na;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s flash.log ram.log\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    nb = Cmp_Load(argv[1], before);
+    na = Cmp_Load(argv[2], after);
+    if (nb == 0U || na == 0U) {
+        fprintf(stderr, "no \"ramfunc:\" lines in %s\n", (nb == 0U) ? argv[1] : argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-22s %-11s %-11s %8s %8s\n", "function", "before", "after", "saved", "%");
+    for (unsigned i = 0; i < nb; i++) {
+        const CmpRow_t *b = &before[i];
+        const CmpRow_t *a = NULL;
+
+        for (unsigned j = 0; j < na && a == NULL; j++)
+            if (strcmp(after[j].name, b->name) == 0)
+                a = &after[j];
+        if (a == NULL) {
+            printf("%-22s only in %s\n", b->name, argv[1]);
+            continue;
+        }
+
+        printf("%-22s %-5s %5u %-5s %5u %8d %7.1f%%\n", b->name,
+               b->where, b->mean, a->where, a->mean,
+               (int)b->mean - (int)a->mean,
+               (b->mean != 0U) ? 100.0 * ((double)b->mean - a->mean) / b->mean : 0.0);
+    }
+    return EXIT_SUCCESS;
+}
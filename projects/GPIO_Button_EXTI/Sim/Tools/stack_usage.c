@@ -0,0 +1,157 @@
+/*
+ * Per-function stack report
+ *
+ * Reads the .su files that gcc writes with -fstack-usage (one line
+ * per function: "file:line:col:function<TAB>bytes<TAB>kind") and
+ * prints the largest frames, the interrupt-side frames and every
+ * function whose frame size is not static.
+ *
+ * Usage:
+ *   ./build/stack_usage [-n count] file.su ...
+ *   make stack                      target build (../Debug, CubeIDE)
+ *   make stack SU_DIR=build/app     host build of the sim
+ *
+ * Frame sizes only: the stack a call chain needs is the sum along
+ * the chain. Take the measured high-water marks (ram_mon.h) as the
+ * truth and this report to see which frames make them up.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char     func[96];
+    char     where[96];         /* file:line */
+    unsigned bytes;
+    char     kind[24];          /* static, dynamic, dynamic,bounded */
+} SuEntry_t;
+
+static SuEntry_t *su;
+static size_t su_count, su_cap;
+
+/* interrupt / exception handlers and the HAL callbacks they call */
+static int Su_IsIsr(const char *func)
+{
+    size_t n = strlen(func);
+
+    return (n > 8U && strcmp(func + n - 8U, "_Handler") == 0) ||
+           (n > 11U && strcmp(func + n - 11U, "_IRQHandler") == 0) ||
+           strstr(func, "Callback") != NULL ||
+           strstr(func, "FromIsr") != NULL;
+}
+
+static int Su_Load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[512];
+
+    if (f == NULL) {
+        perror(path);
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char *tab1 = strchr(line, '\t');
+        char *tab2 = (tab1 != NULL) ? strchr(tab1 + 1, '\t') : NULL;
+        char *func, *col, *file;
+        SuEntry_t *e;
+
+        if (tab2 == NULL)
+            continue;
+        *tab1 = '\0';
+        *tab2 = '\0';
+        tab2[strcspn(tab2 + 1, "\r\n") + 1] = '\0';
+
+        /* "path:line:col:function": function after the last ':' */
+        func = strrchr(line, ':');
+        if (func == NULL)
+            continue;
+        *func++ = '\0';
+        col = strrchr(line, ':');
+        if (col != NULL)
+            *col = '\0';
+        file = strrchr(line, '/');
+        file = (file != NULL) ? file + 1 : line;
+
+        if (su_count == su_cap) {
+            su_cap = (su_cap == 0U) ? 256U : su_cap * 2U;
+            su = realloc(su, su_cap * sizeof(*su));
+            if (su == NULL)
+                exit(EXIT_FAILURE);
+        }
+        e = &su[su_count++];
+        snprintf(e->func, sizeof(e->func), "%.95s", func);
+        snprintf(e->where, sizeof(e->where), "%.95s", file);
+        snprintf(e->kind, sizeof(e->kind), "%.23s", tab2 + 1);
+        e->bytes = (unsigned)strtoul(tab1 + 1, NULL, 10);
+    }
+
+    fclose(f);
+    return 1;
+}
+
+static int Su_Cmp(const void *a, const void *b)
+{
+    const SuEntry_t *x = a, *y = b;
+
+    if (x->bytes != y->bytes)
+        return (x->bytes < y->bytes) ? 1 : -1;
+    return strcmp(x->func, y->func);
+}
+
+static void Su_Print(const SuEntry_t *e)
+{
+    printf("  %6u  %-16s %-36s %s\n", e->bytes, e->kind, e->func, e->where);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned top = 25U, shown = 0U, dynamic = 0U;
+    int first = 1;
+
+    if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+        top = (unsigned)strtoul(argv[2], NULL, 10);
+        first = 3;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "usage: %s [-n count] file.su ...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (int i = first; i < argc; i++)
+        if (!Su_Load(argv[i]))
+            return EXIT_FAILURE;
+    if (su_count == 0U) {
+        fprintf(stderr, "no functions in the .su files\n");
+        return EXIT_FAILURE;
+    }
+    qsort(su, su_count, sizeof(*su), Su_Cmp);
+
+    printf("%zu functions from %d file(s)\n\n", su_count, argc - first);
+    printf("largest frames:\n");
+    for (size_t i = 0; i < su_count && i < top; i++)
+        Su_Print(&su[i]);
+
+    printf("\ninterrupt side (exception stack):\n");
+    for (size_t i = 0; i < su_count && shown < top; i++) {
+        if (Su_IsIsr(su[i].func)) {
+            Su_Print(&su[i]);
+            shown++;
+        }
+    }
+
+    for (size_t i = 0; i < su_count; i++) {
+        if (strncmp(su[i].kind, "static", 6) == 0)
+            continue;
+        if (dynamic++ == 0U)
+            printf("\nnot static (alloca / VLA, \"bounded\" = known maximum):\n");
+        Su_Print(&su[i]);
+    }
+    if (dynamic == 0U)
+        printf("\nall frames static\n");
+
+    return EXIT_SUCCESS;
+}
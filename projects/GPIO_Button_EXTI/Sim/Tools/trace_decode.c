@@ -0,0 +1,184 @@
+/*
+ * Binary trace decoder
+ *
+ * Rebuilds TRACE() messages from a raw UART capture using the
+ * format strings stored in the firmware ELF (section trace_fmt).
+ * Plain ASCII log text in the same capture is passed through.
+ *
+ * Capture example:
+ *   stty -F /dev/ttyACM0 115200 raw && cat /dev/ttyACM0 > trace.bin
+ *   ./build/trace_decode GPIO_Button_EXTI.elf trace.bin
+ *
+ * Handles ELF32 (target) and ELF64 (host simulation) files,
+ * little-endian only. The record layout is described in
+ * Core/Inc/trace.h.
+ *
+ * Platform: Linux host (gcc / clang)
+ */
+
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+static unsigned char *Decode_ReadFile(const char *path, size_t *len)
+{
+    FILE *f = (path != NULL) ? fopen(path, "rb") : stdin;
+    unsigned char *buf = NULL;
+    size_t cap = 0, n;
+
+    *len = 0;
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    do {
+        if (*len + 4096U > cap) {
+            cap = (cap == 0U) ? 65536U : cap * 2U;
+            buf = realloc(buf, cap);
+            if (buf == NULL)
+                return NULL;
+        }
+        n = fread(buf + *len, 1, cap - *len, f);
+        *len += n;
+    } while (n != 0U);
+
+    if (f != stdin)
+        fclose(f);
+    return buf;
+}
+
+/* locate section "trace_fmt": returns its bytes, NULL if missing */
+static const char *Decode_FmtSection(const unsigned char *elf, size_t len, size_t *size)
+{
+    if (len < EI_NIDENT || memcmp(elf, ELFMAG, SELFMAG) != 0 ||
+        elf[EI_DATA] != ELFDATA2LSB)
+        return NULL;
+
+    if (elf[EI_CLASS] == ELFCLASS32) {
+        const Elf32_Ehdr *eh = (const Elf32_Ehdr *)elf;
+        const Elf32_Shdr *sh = (const Elf32_Shdr *)(elf + eh->e_shoff);
+        const char *names = (const char *)elf + sh[eh->e_shstrndx].sh_offset;
+
+        for (unsigned i = 0; i < eh->e_shnum; i++) {
+            if (strcmp(names + sh[i].sh_name, "trace_fmt") == 0) {
+                *size = sh[i].sh_size;
+                return (const char *)elf + sh[i].sh_offset;
+            }
+        }
+    } else if (elf[EI_CLASS] == ELFCLASS64) {
+        const Elf64_Ehdr *eh = (const Elf64_Ehdr *)elf;
+        const Elf64_Shdr *sh = (const Elf64_Shdr *)(elf + eh->e_shoff);
+        const char *names = (const char *)elf + sh[eh->e_shstrndx].sh_offset;
+
+        for (unsigned i = 0; i < eh->e_shnum; i++) {
+            if (strcmp(names + sh[i].sh_name, "trace_fmt") == 0) {
+                *size = sh[i].sh_size;
+                return (const char *)elf + sh[i].sh_offset;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* printf one record; integer conversions take the next 32-bit argument */
+static void Decode_Format(const char *fmt, const uint32_t *args, unsigned nargs)
+{
+    unsigned next = 0;
+
+    while (*fmt != '\0') {
+        char spec[32];
+        size_t n = 0;
+
+        if (*fmt != '%') {
+            putchar(*fmt++);
+            continue;
+        }
+
+        spec[n++] = *fmt++;
+        while (*fmt != '\0' && strchr("-+ #0123456789.", *fmt) != NULL && n < sizeof(spec) - 3U)
+            spec[n++] = *fmt++;
+        while (*fmt == 'l' || *fmt == 'h' || *fmt == 'z')
+            fmt++;                      /* all target arguments are 32-bit */
+        if (*fmt == '\0')
+            break;
+
+        spec[n++] = *fmt;
+        spec[n] = '\0';
+
+        if (*fmt == '%') {
+            putchar('%');
+        } else if (next >= nargs) {
+            printf("<missing arg>");
+        } else if (*fmt == 'd' || *fmt == 'i') {
+            printf(spec, (int)(int32_t)args[next++]);
+        } else if (*fmt == 'p') {
+            printf("0x%08lx", (unsigned long)args[next++]);
+        } else {
+            printf(spec, (unsigned)args[next++]);
+        }
+        fmt++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned char *elf, *cap;
+    size_t elf_len, cap_len, fmt_size = 0;
+    const char *fmts;
+    unsigned records = 0, bad = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s firmware.elf [capture.bin]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    elf = Decode_ReadFile(argv[1], &elf_len);
+    cap = Decode_ReadFile((argc > 2) ? argv[2] : NULL, &cap_len);
+    if (elf == NULL || cap == NULL)
+        return EXIT_FAILURE;
+
+    fmts = Decode_FmtSection(elf, elf_len, &fmt_size);
+    if (fmts == NULL) {
+        fprintf(stderr, "%s: no trace_fmt section (built with TRACE_ENABLE=1?)\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    for (size_t off = 0; off < cap_len; ) {
+        uint32_t hdr, ts, args[TRACE_MAX_ARGS];
+        unsigned nargs, id;
+
+        if (cap[off] != TRACE_SYNC) {
+            putchar(cap[off++]);        /* plain log text */
+            continue;
+        }
+
+        if (off + 8U > cap_len)
+            break;
+        memcpy(&hdr, cap + off, sizeof(hdr));
+        memcpy(&ts, cap + off + 4U, sizeof(ts));
+        nargs = (hdr >> 8) & 0xFFU;
+        id    = hdr >> 16;
+
+        if (nargs > TRACE_MAX_ARGS || id >= fmt_size ||
+            off + 8U + 4U * nargs > cap_len) {
+            bad++;
+            off++;                      /* resync on the next 0xA5 */
+            continue;
+        }
+        memcpy(args, cap + off + 8U, 4U * nargs);
+
+        printf("[%10lu ms] ", (unsigned long)ts);
+        Decode_Format(fmts + id, args, nargs);
+        records++;
+        off += 8U + 4U * nargs;
+    }
+
+    fprintf(stderr, "%u trace record(s), %u undecodable\n", records, bad);
+    free(elf);
+    free(cap);
+    return (bad == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}